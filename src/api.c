@@ -15,30 +15,80 @@
 #include "player_instances.h"
 #include "game_legacy.h"
 #include "console_cmd.h"
+#include "net_rollback.h"
 #include "post_inc.h"
 #include "value_util.h"
 #include "keeperfx.hpp"
 
 #define API_SERVER_BUFFER 4096
 
+#define API_MAX_CLIENTS 8
+
+// A client which doesn't read its data is disconnected when this much is waiting for it
+#define API_CLIENT_QUEUE_LIMIT (1024 * 1024)
+
 #define API_SUBSCRIBE_LIST_SIZE 256
 
 #define API_SUBSCRIBE_INACTIVE 0
 #define API_SUBSCRIBE_EVENT 1
 #define API_SUBSCRIBE_VAR 2
 
+// Length of a game event message waiting for its turn to be confirmed
+#define API_EVENT_TEXT_LEN 256
+
+/**
+ * Structure representing a connected API client.
+ *
+ * Data for the client is added to its queue, and sent by its own writer thread,
+ * so that a slow client never blocks the game nor other clients.
+ */
+struct ApiClient
+{
+    TCPsocket socket;    // Client socket, or 0 if the slot is free
+    char *queue;         // Data waiting to be sent
+    size_t queue_len;    // Amount of data in the queue
+    size_t queue_size;   // Allocated size of the queue
+    SDL_Thread *writer;  // Thread sending the queued data
+    SDL_mutex *lock;     // Protects the queue and flags
+    SDL_cond *wake;      // Signals new data for the writer
+    TbBool sending;      // The writer thread is sending data of this client
+    TbBool writer_quit;  // Set to stop the writer thread
+    TbBool writer_done;  // The writer thread has finished; the slot may be freed
+    TbBool failed;       // Sending failed or the queue overflowed; client will be disconnected
+    TbBool closing;      // Disconnected; the slot waits for its writer thread to finish
+};
+
+/**
+ * Structure representing a game event waiting to be sent.
+ *
+ * Events raised by the simulation are only sent when their turn is confirmed,
+ * as a turn simulated ahead by network rollback may be simulated again.
+ */
+struct ApiPendingEvent
+{
+    GameTurn turn;
+    char name[COMMAND_WORD_LEN];
+    char text[API_EVENT_TEXT_LEN];
+    int len;
+};
+
 /**
  * Structure to hold API global variables.
  *
  * This structure defines global variables related to the API, including the server socket,
- * active client socket (only one client at a time), and a socket set for managing sockets.
+ * connected clients, and a socket set for managing sockets.
  */
 struct ApiGlobals
 {
-    TCPsocket serverSocket;     // Server socket for API communication
-    TCPsocket activeSocket;     // Active client socket (only one client at a time)
-    SDLNet_SocketSet socketSet; // Socket set for managing sockets
-} api = {0};                    // Global instance of the API global variables initialized with zeros
+    TCPsocket serverSocket;                     // Server socket for API communication
+    SDLNet_SocketSet socketSet;                 // Socket set for managing sockets
+    struct ApiClient clients[API_MAX_CLIENTS];  // Connected clients
+    int clients_count;                          // Amount of connected clients
+    int current_client;                         // Client whose request is being processed, or -1
+    struct ApiPendingEvent *events;             // Game events waiting for their turn to be confirmed
+    int events_count;                           // Amount of waiting events
+    int events_size;                            // Allocated amount of events
+} api = {0};                                    // Global instance of the API global variables initialized with zeros
 
 /**
  * Structure representing a subscribed variable.
@@ -67,6 +117,7 @@ struct Subscription
     struct SubscribedVariable var;
     char event[COMMAND_WORD_LEN];
     int type;
+    unsigned long clients; // Bit mask of clients subscribed to this slot
 } api_subscriptions[API_SUBSCRIBE_LIST_SIZE];
 
 /**
@@ -75,9 +126,237 @@ struct Subscription
  * We use an int for this so we can stop checking the list of
  * subscription slots when we are sure there's no more subscriptions left.
  * This is done for performance reasons.
+ * Clients subscribing to the same event or variable share the slot, so
+ * every variable is only read once per turn no matter how many clients watch it.
  */
 int api_sub_count = 0;
 
+/**
+ * Add data to the send queue of a client.
+ *
+ * The data is sent later by the writer thread of the client, see api_flush().
+ * If the client doesn't read its data and the queue grows too much,
+ * the client is marked to be disconnected.
+ *
+ * @param client_idx Index of the client.
+ * @param data The data to be sent.
+ * @param len Length of the data.
+ */
+static void api_queue_send(int client_idx, const char *data, size_t len)
+{
+    if ((client_idx < 0) || (client_idx >= API_MAX_CLIENTS))
+    {
+        return;
+    }
+    struct ApiClient *client = &api.clients[client_idx];
+    if ((client->socket == 0) || client->failed || client->closing)
+    {
+        return;
+    }
+
+    SDL_LockMutex(client->lock);
+    if (client->queue_len + len > API_CLIENT_QUEUE_LIMIT)
+    {
+        WARNLOG("API client %d doesn't read its data, disconnecting", client_idx);
+        client->failed = true;
+    }
+    else
+    {
+        if (client->queue_len + len > client->queue_size)
+        {
+            size_t new_size = max(max(client->queue_size * 2, client->queue_len + len), (size_t)API_SERVER_BUFFER);
+            char *new_queue = (char *)realloc(client->queue, new_size);
+            if (new_queue == NULL)
+            {
+                client->failed = true;
+                SDL_UnlockMutex(client->lock);
+                return;
+            }
+            client->queue = new_queue;
+            client->queue_size = new_size;
+        }
+        memcpy(client->queue + client->queue_len, data, len);
+        client->queue_len += len;
+    }
+    SDL_UnlockMutex(client->lock);
+}
+
+/**
+ * Add data to the send queue of the client whose request is being processed.
+ */
+static void api_send(const char *data, size_t len)
+{
+    api_queue_send(api.current_client, data, len);
+}
+
+/**
+ * Add data to the send queues of all clients in the given bit mask.
+ */
+static void api_send_to_clients(unsigned long clients, const char *data, size_t len)
+{
+    for (int i = 0; i < API_MAX_CLIENTS; i++)
+    {
+        if ((clients & (1UL << i)) != 0)
+        {
+            api_queue_send(i, data, len);
+        }
+    }
+}
+
+/**
+ * Wake up the writer threads of clients which have queued data.
+ */
+static void api_flush()
+{
+    for (int i = 0; i < API_MAX_CLIENTS; i++)
+    {
+        struct ApiClient *client = &api.clients[i];
+        if ((client->socket == 0) || client->closing)
+        {
+            continue;
+        }
+        SDL_LockMutex(client->lock);
+        if (client->queue_len > 0)
+        {
+            SDL_CondSignal(client->wake);
+        }
+        SDL_UnlockMutex(client->lock);
+    }
+}
+
+/**
+ * Writer thread of a client; sends its queued data.
+ *
+ * The queue is taken from the client before sending, so the game can
+ * fill a new one while the data is on its way. Sending may block, but
+ * only this client is waiting then. The socket is closed by the game
+ * thread once this thread is done.
+ */
+static int api_client_writer_thread(void *data)
+{
+    struct ApiClient *client = (struct ApiClient *)data;
+    SDL_LockMutex(client->lock);
+    while (!client->writer_quit && !client->failed)
+    {
+        if (client->queue_len == 0)
+        {
+            SDL_CondWait(client->wake, client->lock);
+            continue;
+        }
+        char *buf = client->queue;
+        size_t len = client->queue_len;
+        client->queue = NULL;
+        client->queue_len = 0;
+        client->queue_size = 0;
+        client->sending = true;
+        SDL_UnlockMutex(client->lock);
+
+        int sent_len = SDLNet_TCP_Send(client->socket, buf, len);
+        free(buf);
+
+        SDL_LockMutex(client->lock);
+        client->sending = false;
+        if (sent_len < (int)len)
+        {
+            client->failed = true;
+        }
+    }
+    client->writer_done = true;
+    SDL_UnlockMutex(client->lock);
+    return 0;
+}
+
+static void api_clear_client_subscriptions(int client_idx);
+
+/**
+ * Free the client slot, after its writer thread was stopped.
+ */
+static void api_free_client(struct ApiClient *client)
+{
+    if (client->socket != 0)
+    {
+        // Closing clients were already removed from the set
+        if (!client->closing)
+        {
+            SDLNet_TCP_DelSocket(api.socketSet, client->socket);
+        }
+        SDLNet_TCP_Close(client->socket);
+    }
+    if (client->wake)
+    {
+        SDL_DestroyCond(client->wake);
+    }
+    if (client->lock)
+    {
+        SDL_DestroyMutex(client->lock);
+    }
+    free(client->queue);
+    memset(client, 0, sizeof(struct ApiClient));
+}
+
+/**
+ * Disconnect a client.
+ *
+ * Nothing more is read from nor queued for the client, and its writer thread
+ * is told to quit. The thread may still be blocked sending to a stalled client,
+ * so it is not waited for here; the slot is freed by api_free_closed_clients()
+ * once the thread has finished and the socket is no longer used.
+ *
+ * @param client_idx Index of the client.
+ */
+static void api_close_client(int client_idx)
+{
+    struct ApiClient *client = &api.clients[client_idx];
+    if ((client->socket == 0) || client->closing)
+    {
+        return;
+    }
+
+    SDLNet_TCP_DelSocket(api.socketSet, client->socket);
+    api_clear_client_subscriptions(client_idx);
+    client->closing = true;
+
+    SDL_LockMutex(client->lock);
+    client->writer_quit = true;
+    SDL_CondSignal(client->wake);
+    SDL_UnlockMutex(client->lock);
+
+    api.clients_count--;
+    JUSTLOG("API client %d disconnected", client_idx);
+}
+
+/**
+ * Free slots of disconnected clients whose writer thread has finished.
+ *
+ * @param abandon If set, threads still sending are detached, and their slots are left for good.
+ */
+static void api_free_closed_clients(TbBool abandon)
+{
+    for (int i = 0; i < API_MAX_CLIENTS; i++)
+    {
+        struct ApiClient *client = &api.clients[i];
+        if (!client->closing || (client->writer == NULL))
+        {
+            continue;
+        }
+        SDL_LockMutex(client->lock);
+        // A writer which isn't sending will see writer_quit right away
+        TbBool finishing = client->writer_done || !client->sending;
+        SDL_UnlockMutex(client->lock);
+        if (finishing)
+        {
+            SDL_WaitThread(client->writer, NULL);
+            client->writer = NULL;
+            api_free_client(client);
+        }
+        else if (abandon)
+        {
+            SDL_DetachThread(client->writer);
+            client->writer = NULL;
+        }
+    }
+}
+
 /**
  * Structure to hold the state of a dump buffer.
  *
@@ -172,8 +451,9 @@ int api_init_server()
     }
 
     memset(&api, 0, sizeof(api));
+    api.current_client = -1;
 
-    api.socketSet = SDLNet_AllocSocketSet(2);
+    api.socketSet = SDLNet_AllocSocketSet(API_MAX_CLIENTS + 1);
     if (!api.socketSet)
     {
         JUSTLOG("SDLNet_AllocSocketSet failed! SDLNet_Error: %s", SDLNet_GetError());
@@ -220,15 +500,15 @@ int api_init_server()
 /**
  * Send an API error message.
  *
- * This function sends an error message to the API client over the active socket.
+ * This function sends an error message to the API client whose request is being processed.
  * If the API server is not active, this function does nothing.
  *
  * @param err A null-terminated string representing the error message to be sent.
  */
 static void api_err(const char *err, VALUE *ack_id)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Do nothing if there is no client to respond to
+    if (api.current_client < 0)
     {
         return;
     }
@@ -270,20 +550,20 @@ static void api_err(const char *err, VALUE *ack_id)
     dump_state.out++;
 
     // Send data to client
-    SDLNet_TCP_Send(api.activeSocket, json_string, dump_state.out - json_string);
+    api_send(json_string, dump_state.out - json_string);
     value_fini(json_root);
 }
 
 /**
  * Send an API success message.
  *
- * This function sends a success message to the API client over the active socket.
+ * This function sends a success message to the API client whose request is being processed.
  * If the API server is not active, this function does nothing.
  */
 static void api_ok(VALUE *ack_id)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Do nothing if there is no client to respond to
+    if (api.current_client < 0)
     {
         return;
     }
@@ -293,7 +573,7 @@ static void api_ok(VALUE *ack_id)
     {
         // We can send it directly without using JSON functions here
         const char msg[] = "{\"success\":true}\n";
-        SDLNet_TCP_Send(api.activeSocket, msg, strlen(msg));
+        api_send(msg, strlen(msg));
         return;
     }
 
@@ -327,7 +607,7 @@ static void api_ok(VALUE *ack_id)
     dump_state.out++;
 
     // Send data to client
-    SDLNet_TCP_Send(api.activeSocket, json_string, dump_state.out - json_string);
+    api_send(json_string, dump_state.out - json_string);
     value_fini(json_root);
 }
 
@@ -343,8 +623,8 @@ static void api_ok(VALUE *ack_id)
  */
 static void api_return_data(TbBool success, VALUE value, VALUE *ack_id)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Do nothing if there is no client to respond to
+    if (api.current_client < 0)
     {
         return;
     }
@@ -387,14 +667,14 @@ static void api_return_data(TbBool success, VALUE value, VALUE *ack_id)
     dump_state.out++;
 
     // Send data to client
-    SDLNet_TCP_Send(api.activeSocket, json_string, dump_state.out - json_string);
+    api_send(json_string, dump_state.out - json_string);
     value_fini(json_root);
 }
 
 /**
  * Send a string data response to the API client.
  *
- * This function sends a string data response to the API client over the active socket.
+ * This function sends a string data response to the API client whose request is being processed.
  * If the API server is not active, this function does nothing.
  *
  * @param data The string data to be sent to the API client.
@@ -415,10 +695,15 @@ static void api_return_data(TbBool success, VALUE value, VALUE *ack_id)
 //     api_return_data(true, dataValue);
 // }
 
-void api_return_var_update(PlayerNumber plyr_idx, const char *var_name, long value)
+/**
+ * Send a variable update to the API clients subscribed to it.
+ *
+ * @param clients Bit mask of clients to receive the update.
+ */
+static void api_return_var_update(unsigned long clients, PlayerNumber plyr_idx, const char *var_name, long value)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Do nothing if there is no client to send to
+    if (clients == 0)
     {
         return;
     }
@@ -464,8 +749,8 @@ void api_return_var_update(PlayerNumber plyr_idx, const char *var_name, long val
     dump_state.out[0] = '\n';
     dump_state.out++;
 
-    // Send data to client
-    SDLNet_TCP_Send(api.activeSocket, json_string, dump_state.out - json_string);
+    // Send data to clients
+    api_send_to_clients(clients, json_string, dump_state.out - json_string);
     value_fini(json_root);
 }
 
@@ -474,15 +759,15 @@ void api_return_var_update(PlayerNumber plyr_idx, const char *var_name, long val
  *
  * This is useful for sending numeric values.
  *
- * This function sends a long integer data response to the API client over the active socket.
+ * This function sends a long integer data response to the API client whose request is being processed.
  * If the API server is not active, this function does nothing.
  *
  * @param data The long integer data to be sent to the API client.
  */
 static void api_return_data_number(long data, VALUE *ack_id)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Do nothing if there is no client to respond to
+    if (api.current_client < 0)
     {
         return;
     }
@@ -493,7 +778,7 @@ static void api_return_data_number(long data, VALUE *ack_id)
         // Send back the JSON as a string. A number should never be able to break the syntax.
         char buf[256];
         int len = snprintf(buf, sizeof(buf) - 1, "{\"success\":true,\"data\":%ld}\n", data);
-        SDLNet_TCP_Send(api.activeSocket, buf, len);
+        api_send(buf, len);
         return;
     }
 
@@ -531,40 +816,52 @@ static void api_return_data_number(long data, VALUE *ack_id)
     dump_state.out++;
 
     // Send data to client
-    SDLNet_TCP_Send(api.activeSocket, json_string, dump_state.out - json_string);
+    api_send(json_string, dump_state.out - json_string);
     value_fini(json_root);
 }
 
-void api_clear_all_subscriptions()
+/**
+ * Find the subscription slot of an event.
+ *
+ * @return Index of the slot, or -1 if no client is subscribed to the event.
+ */
+static int api_find_event_subscription(const char *event_name)
 {
-    if (api_sub_count == 0)
-    {
-        return;
-    }
-
-    // Loop trough all subscriptions
-    // We don't exit the loop earlier just incase
-    // This way this function also works as a full subscription list refresh
+    int api_sub_found_count = 0;
     for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
     {
+        // Cancel this subscription search if we have
+        // seen the same amount of subscriptions as we are subscribed to
+        if (api_sub_count == api_sub_found_count)
+        {
+            return -1;
+        }
+
         // If this subscription slot is inactive we can skip it
         if (api_subscriptions[i].type == API_SUBSCRIBE_INACTIVE)
         {
             continue;
         }
 
-        // Set type as inactive and clear all data
-        api_subscriptions[i].type = API_SUBSCRIBE_INACTIVE;
-        memset(api_subscriptions[i].event, 0, sizeof(api_subscriptions[i].event));
-        memset(&api_subscriptions[i].var, 0, sizeof(struct SubscribedVariable));
+        api_sub_found_count++;
+
+        if ((api_subscriptions[i].type == API_SUBSCRIBE_EVENT) &&
+            (strcmp(api_subscriptions[i].event, event_name) == 0))
+        {
+            return i;
+        }
     }
 
-    api_sub_count = 0;
+    return -1;
 }
 
-int api_is_subscribed_to_event(const char *event_name)
+/**
+ * Find the subscription slot of a variable.
+ *
+ * @return Index of the slot, or -1 if no client is subscribed to the variable.
+ */
+static int api_find_var_subscription(PlayerNumber plyr_idx, unsigned char valtype, short validx)
 {
-    // Look up if we are subscribed to this event
     int api_sub_found_count = 0;
     for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
     {
@@ -572,7 +869,7 @@ int api_is_subscribed_to_event(const char *event_name)
         // seen the same amount of subscriptions as we are subscribed to
         if (api_sub_count == api_sub_found_count)
         {
-            return false;
+            return -1;
         }
 
         // If this subscription slot is inactive we can skip it
@@ -583,212 +880,188 @@ int api_is_subscribed_to_event(const char *event_name)
 
         api_sub_found_count++;
 
-        // Ignore if this subscription slot is not an event
-        if (api_subscriptions[i].type != API_SUBSCRIBE_EVENT)
-        {
-            continue;
-        }
-
-        // Break out of the for loop if this subscription event matches the triggered one
-        if (strcmp(api_subscriptions[i].event, event_name) == 0)
+        if (api_subscriptions[i].type == API_SUBSCRIBE_VAR &&
+            api_subscriptions[i].var.player_id == plyr_idx &&
+            api_subscriptions[i].var.type == valtype &&
+            api_subscriptions[i].var.id == validx)
         {
-            return true;
+            return i;
         }
     }
 
-    return false;
+    return -1;
 }
 
-int api_subscribe_event(const char *event_name)
+/**
+ * Find an empty subscription slot.
+ *
+ * @return Index of the slot, or -1 if all slots are used.
+ */
+static int api_find_free_subscription()
 {
-    // Return if we are already subscribed to this event
-    if (api_is_subscribed_to_event(event_name) == true)
-    {
-        return true;
-    }
-
-    // Make sure we have an open subscription slot
     if (api_sub_count >= API_SUBSCRIBE_LIST_SIZE)
     {
-        WARNLOG(
-            "Tried to register API event '%s' but we are already at the limit of %d subscription slots",
-            event_name,
-            API_SUBSCRIBE_LIST_SIZE);
-
-        return false;
+        return -1;
     }
-
-    // Loop trough the list of subscription slots to find an empty slot and create a subscription
     for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
     {
-
-        // If this subscription slot is inactive we'll use it
         if (api_subscriptions[i].type == API_SUBSCRIBE_INACTIVE)
         {
-            api_subscriptions[i].type = API_SUBSCRIBE_EVENT;
-            strncpy(api_subscriptions[i].event, event_name, sizeof(api_subscriptions[i].event) - 1);
-            api_sub_count++;
-            return true;
+            return i;
         }
     }
+    return -1;
+}
 
-    return false;
+/**
+ * Remove a client from a subscription slot, and free the slot if it was the last one.
+ */
+static void api_remove_subscriber(int sub_idx, int client_idx)
+{
+    api_subscriptions[sub_idx].clients &= ~(1UL << client_idx);
+    if (api_subscriptions[sub_idx].clients != 0)
+    {
+        return;
+    }
+    api_subscriptions[sub_idx].type = API_SUBSCRIBE_INACTIVE;
+    memset(api_subscriptions[sub_idx].event, 0, sizeof(api_subscriptions[sub_idx].event));
+    memset(&api_subscriptions[sub_idx].var, 0, sizeof(struct SubscribedVariable));
+    api_sub_count--;
 }
 
-int api_unsubscribe_event(const char *event_name)
+void api_clear_all_subscriptions()
 {
-    // First make sure we are actually subscribed to this event
-    if (api_is_subscribed_to_event(event_name) == false)
+    if (api_sub_count == 0)
     {
-        return true;
+        return;
     }
 
-    // Loop trough the list of subscription slots to find an empty slot and create a subscription
+    // Loop trough all subscriptions
+    // We don't exit the loop earlier just incase
+    // This way this function also works as a full subscription list refresh
     for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
     {
-
-        // If this subscription slot is not an event we'll skip it
-        if (api_subscriptions[i].type != API_SUBSCRIBE_EVENT)
+        // If this subscription slot is inactive we can skip it
+        if (api_subscriptions[i].type == API_SUBSCRIBE_INACTIVE)
         {
             continue;
         }
 
-        // Check if this subscription slot is the event we're unsubscribing from
-        if (strcmp(api_subscriptions[i].event, event_name) == 0)
-        {
-            api_subscriptions[i].type = API_SUBSCRIBE_INACTIVE;
-            memset(api_subscriptions[i].event, 0, sizeof(api_subscriptions[i].event));
-            api_sub_count--;
-            return true;
-        }
+        // Set type as inactive and clear all data
+        api_subscriptions[i].type = API_SUBSCRIBE_INACTIVE;
+        api_subscriptions[i].clients = 0;
+        memset(api_subscriptions[i].event, 0, sizeof(api_subscriptions[i].event));
+        memset(&api_subscriptions[i].var, 0, sizeof(struct SubscribedVariable));
     }
 
-    return false;
+    api_sub_count = 0;
 }
 
-int api_is_subscribed_to_var(PlayerNumber plyr_idx, unsigned char valtype, short validx)
+/**
+ * Remove all subscriptions of a single client.
+ */
+static void api_clear_client_subscriptions(int client_idx)
 {
-    // Look up if we are subscribed to updates of this variable
-    int api_sub_found_count = 0;
     for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
     {
-        // Cancel this subscription search if we have
-        // seen the same amount of subscriptions as we are subscribed to
-        if (api_sub_count == api_sub_found_count)
-        {
-            return false;
-        }
-
-        // If this subscription slot is inactive we can skip it
-        if (api_subscriptions[i].type == API_SUBSCRIBE_INACTIVE)
+        if ((api_subscriptions[i].type != API_SUBSCRIBE_INACTIVE) &&
+            ((api_subscriptions[i].clients & (1UL << client_idx)) != 0))
         {
-            continue;
-        }
-
-        api_sub_found_count++;
-
-        // Ignore if this subscription slot is not for a var
-        if (api_subscriptions[i].type != API_SUBSCRIBE_VAR)
-        {
-            continue;
-        }
-
-        // Break out of the for loop if this subscribed var matches the triggered one
-        if (api_subscriptions[i].var.player_id == plyr_idx &&
-            api_subscriptions[i].var.type == valtype &&
-            api_subscriptions[i].var.id == validx)
-        {
-            return true;
+            api_remove_subscriber(i, client_idx);
         }
     }
-
-    return false;
 }
 
-int api_subscribe_var(PlayerNumber plyr_idx, const char *var_name, unsigned char valtype, short validx)
+int api_subscribe_event(int client_idx, const char *event_name)
 {
-    JUSTLOG("Sub: %d, %d, %d", plyr_idx, valtype, validx);
-
-    // Return if we are already subscribed to this var
-    if (api_is_subscribed_to_var(plyr_idx, valtype, validx) == true)
-    {
-        return true;
-    }
-
-    // Make sure we have an open subscription slot
-    if (api_sub_count >= API_SUBSCRIBE_LIST_SIZE)
+    // Add the client to existing subscription if there is one
+    int sub_idx = api_find_event_subscription(event_name);
+    if (sub_idx < 0)
     {
-        WARNLOG("Tried to register to update of var but we are already at the limit of %d subscription slots", API_SUBSCRIBE_LIST_SIZE);
-        return false;
-    }
-
-    // Loop trough the list of subscription slots to find an empty slot and create a subscription
-    for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
-    {
-
-        // If this subscription slot is inactive we'll use it
-        if (api_subscriptions[i].type == API_SUBSCRIBE_INACTIVE)
+        // Make sure we have an open subscription slot
+        sub_idx = api_find_free_subscription();
+        if (sub_idx < 0)
         {
+            WARNLOG(
+                "Tried to register API event '%s' but we are already at the limit of %d subscription slots",
+                event_name,
+                API_SUBSCRIBE_LIST_SIZE);
 
-            struct SubscribedVariable sub_var;
-            sub_var.player_id = plyr_idx;
-            sub_var.type = valtype;
-            sub_var.id = validx;
-            sub_var.val = get_condition_value(plyr_idx, valtype, validx);
-            strncpy(sub_var.name, var_name, sizeof(sub_var.name) - 1);
-
-            api_subscriptions[i].type = API_SUBSCRIBE_VAR;
-            api_subscriptions[i].var = sub_var;
-
-            api_sub_count++;
-            return true;
+            return false;
         }
+        api_subscriptions[sub_idx].type = API_SUBSCRIBE_EVENT;
+        strncpy(api_subscriptions[sub_idx].event, event_name, sizeof(api_subscriptions[sub_idx].event) - 1);
+        api_subscriptions[sub_idx].clients = 0;
+        api_sub_count++;
     }
 
-    return false;
+    api_subscriptions[sub_idx].clients |= (1UL << client_idx);
+    return true;
 }
 
-int api_unsubscribe_var(PlayerNumber plyr_idx, unsigned char valtype, short validx)
+int api_unsubscribe_event(int client_idx, const char *event_name)
 {
-    // First make sure we are actually subscribed to this var
-    if (api_is_subscribed_to_var(plyr_idx, valtype, validx) == false)
+    // Nothing to do if we are not subscribed to this event
+    int sub_idx = api_find_event_subscription(event_name);
+    if (sub_idx >= 0)
     {
-        return true;
+        api_remove_subscriber(sub_idx, client_idx);
     }
+    return true;
+}
 
-    // Loop trough the list of subscription slots to find an empty slot and create a subscription
-    for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
-    {
+int api_subscribe_var(int client_idx, PlayerNumber plyr_idx, const char *var_name, unsigned char valtype, short validx)
+{
+    JUSTLOG("Sub: %d, %d, %d", plyr_idx, valtype, validx);
 
-        // If this subscription slot is not an event we'll skip it
-        if (api_subscriptions[i].type != API_SUBSCRIBE_VAR)
+    // Add the client to existing subscription if there is one
+    int sub_idx = api_find_var_subscription(plyr_idx, valtype, validx);
+    if (sub_idx < 0)
+    {
+        // Make sure we have an open subscription slot
+        sub_idx = api_find_free_subscription();
+        if (sub_idx < 0)
         {
-            continue;
+            WARNLOG("Tried to register to update of var but we are already at the limit of %d subscription slots", API_SUBSCRIBE_LIST_SIZE);
+            return false;
         }
 
-        // Check if this subscription slot is the event we're unsubscribing from
-        if (api_subscriptions[i].var.player_id == plyr_idx &&
-            api_subscriptions[i].var.type == valtype &&
-            api_subscriptions[i].var.id == validx)
-        {
-            api_subscriptions[i].type = API_SUBSCRIBE_INACTIVE;
-            memset(&api_subscriptions[i].var, 0, sizeof(struct SubscribedVariable));
-            api_sub_count--;
-            return true;
-        }
+        struct SubscribedVariable sub_var;
+        memset(&sub_var, 0, sizeof(sub_var));
+        sub_var.player_id = plyr_idx;
+        sub_var.type = valtype;
+        sub_var.id = validx;
+        sub_var.val = get_condition_value(plyr_idx, valtype, validx);
+        strncpy(sub_var.name, var_name, sizeof(sub_var.name) - 1);
+
+        api_subscriptions[sub_idx].type = API_SUBSCRIBE_VAR;
+        api_subscriptions[sub_idx].var = sub_var;
+        api_subscriptions[sub_idx].clients = 0;
+        api_sub_count++;
     }
 
-    return false;
+    api_subscriptions[sub_idx].clients |= (1UL << client_idx);
+    return true;
 }
 
-void api_check_var_update()
+int api_unsubscribe_var(int client_idx, PlayerNumber plyr_idx, unsigned char valtype, short validx)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Nothing to do if we are not subscribed to this var
+    int sub_idx = api_find_var_subscription(plyr_idx, valtype, validx);
+    if (sub_idx >= 0)
     {
-        return;
+        api_remove_subscriber(sub_idx, client_idx);
     }
+    return true;
+}
 
+/**
+ * Check subscribed variables for changes.
+ *
+ * Every variable is read once, and the update is sent to all clients subscribed to it.
+ */
+void api_check_var_update()
+{
     // Loop trough all our subscriptions
     int api_sub_found_count = 0;
     for (int i = 0; i < API_SUBSCRIBE_LIST_SIZE; i++)
@@ -827,8 +1100,9 @@ void api_check_var_update()
             // Update the remembered value
             api_subscriptions[i].var.val = variable_value;
 
-            // Send notification to client
+            // Send notification to clients
             api_return_var_update(
+                api_subscriptions[i].clients,
                 api_subscriptions[i].var.player_id,
                 api_subscriptions[i].var.name,
                 api_subscriptions[i].var.val);
@@ -836,32 +1110,155 @@ void api_check_var_update()
     }
 }
 
+/**
+ * Get the clients which should receive an event.
+ *
+ * Clients subscribed to "*" receive all events.
+ */
+static unsigned long api_event_subscribers(const char *event_name)
+{
+    unsigned long clients = 0;
+    int sub_idx = api_find_event_subscription(event_name);
+    if (sub_idx >= 0)
+    {
+        clients |= api_subscriptions[sub_idx].clients;
+    }
+    sub_idx = api_find_event_subscription("*");
+    if (sub_idx >= 0)
+    {
+        clients |= api_subscriptions[sub_idx].clients;
+    }
+    return clients;
+}
+
+/**
+ * Add an event message to the list of events waiting for their turn to be confirmed.
+ */
+static void api_add_pending_event(const char *event_name, const char *text, int len)
+{
+    if ((len < 0) || (len >= API_EVENT_TEXT_LEN))
+    {
+        return;
+    }
+    if (api.events_count >= api.events_size)
+    {
+        int new_size = max(api.events_size * 2, 64);
+        struct ApiPendingEvent *new_events = (struct ApiPendingEvent *)realloc(api.events, new_size * sizeof(struct ApiPendingEvent));
+        if (new_events == NULL)
+        {
+            return;
+        }
+        api.events = new_events;
+        api.events_size = new_size;
+    }
+    struct ApiPendingEvent *pevent = &api.events[api.events_count];
+    pevent->turn = game.play_gameturn;
+    snprintf(pevent->name, sizeof(pevent->name), "%s", event_name);
+    memcpy(pevent->text, text, len);
+    pevent->len = len;
+    api.events_count++;
+}
+
+/**
+ * Send the waiting events of turns which are confirmed.
+ *
+ * Events of turns simulated ahead by network rollback wait until the turn
+ * can't be simulated again; in other games they are sent right away.
+ */
+static void api_send_confirmed_events()
+{
+    GameTurn unconfirmed_turn = network_rollback_unconfirmed_gameturn();
+    int n = 0;
+    while ((n < api.events_count) && (api.events[n].turn < unconfirmed_turn))
+    {
+        struct ApiPendingEvent *pevent = &api.events[n];
+        api_send_to_clients(api_event_subscribers(pevent->name), pevent->text, pevent->len);
+        n++;
+    }
+    if (n > 0)
+    {
+        memmove(&api.events[0], &api.events[n], (api.events_count - n) * sizeof(struct ApiPendingEvent));
+        api.events_count -= n;
+        api_flush();
+    }
+}
+
+/**
+ * Forget the waiting events raised on given turn or later.
+ *
+ * Used when network rollback restores an earlier state; the events
+ * are raised again when the turns are simulated again.
+ *
+ * @param turn The first game turn whose events are discarded.
+ */
+void api_discard_events(GameTurn turn)
+{
+    while ((api.events_count > 0) && (api.events[api.events_count - 1].turn >= turn))
+    {
+        api.events_count--;
+    }
+}
+
 /**
  * Send an API event message.
  *
- * This function sends an event message to the API client over the active socket.
- * If the API server is not active, this function does nothing.
+ * This function sends an event message to all API clients subscribed to the event.
+ * If no client is subscribed, this function does nothing.
  *
  * @param event_name A null-terminated string representing the name of the event to be sent.
  */
 void api_event(const char *event_name)
 {
-    // Do nothing if API server is not active
-    if (!api.activeSocket)
+    // Do nothing if there are no clients
+    if (api.clients_count == 0)
     {
         return;
     }
 
-    // Do nothing if we are not subscribed to this event
-    if (api_is_subscribed_to_event(event_name) == false)
+    // Do nothing if no client is subscribed to this event
+    if (api_event_subscribers(event_name) == 0)
     {
         return;
     }
 
-    // Create the JSON response and send it to the client
-    char buf[512];
-    int len = snprintf(buf, sizeof(buf) - 1, "{\"event\":\"%s\"}\n", event_name);
-    SDLNet_TCP_Send(api.activeSocket, buf, len);
+    // Create the JSON response and send it to the clients once its turn is confirmed
+    char buf[API_EVENT_TEXT_LEN];
+    int len = snprintf(buf, sizeof(buf), "{\"event\":\"%s\",\"turn\":%lu}\n", event_name, (unsigned long)game.play_gameturn);
+    api_add_pending_event(event_name, buf, len);
+    api_send_confirmed_events();
+}
+
+/**
+ * Send an API event message describing something happening on the map.
+ *
+ * Used for the game event stream, ie. rooms being built or creatures dying.
+ * The event is built only if some client is subscribed to it, so it is cheap to call.
+ * It is sent once its turn is confirmed, see api_send_confirmed_events().
+ *
+ * @param event_name Name of the event.
+ * @param plyr_idx Player related to the event.
+ * @param kind_name Name of the room, creature or other kind the event concerns; may be NULL.
+ * @param stl_x Subtile X coordinate of the event.
+ * @param stl_y Subtile Y coordinate of the event.
+ */
+void api_event_with_data(const char *event_name, PlayerNumber plyr_idx, const char *kind_name, long stl_x, long stl_y)
+{
+    if (api.clients_count == 0)
+    {
+        return;
+    }
+
+    if (api_event_subscribers(event_name) == 0)
+    {
+        return;
+    }
+
+    char buf[API_EVENT_TEXT_LEN];
+    int len = snprintf(buf, sizeof(buf),
+        "{\"event\":\"%s\",\"turn\":%lu,\"player\":\"%s\",\"kind\":\"%s\",\"x\":%ld,\"y\":%ld}\n",
+        event_name, (unsigned long)game.play_gameturn, player_code_name(plyr_idx),
+        (kind_name != NULL) ? kind_name : "", stl_x, stl_y);
+    api_add_pending_event(event_name, buf, len);
 }
 
 /**
@@ -985,7 +1382,7 @@ static void api_process_buffer(const char *buffer, size_t buf_size)
         }
 
         // Try to subscribe to the variable
-        if (api_subscribe_var(player_id, variable_name, variable_type, variable_id))
+        if (api_subscribe_var(api.current_client, player_id, variable_name, variable_type, variable_id))
         {
             api_ok(ack_id);
         }
@@ -1021,7 +1418,7 @@ static void api_process_buffer(const char *buffer, size_t buf_size)
         }
 
         // Try to subscribe to the variable
-        if (api_unsubscribe_var(player_id, variable_type, variable_id))
+        if (api_unsubscribe_var(api.current_client, player_id, variable_type, variable_id))
         {
             api_ok(ack_id);
         }
@@ -1056,7 +1453,7 @@ static void api_process_buffer(const char *buffer, size_t buf_size)
         }
 
         // Try to subscribe to the variable
-        if (api_subscribe_event(event_name))
+        if (api_subscribe_event(api.current_client, event_name))
         {
             api_ok(ack_id);
         }
@@ -1083,7 +1480,7 @@ static void api_process_buffer(const char *buffer, size_t buf_size)
         }
 
         // Try to subscribe to the variable
-        if (api_unsubscribe_event(event_name))
+        if (api_unsubscribe_event(api.current_client, event_name))
         {
             api_ok(ack_id);
         }
@@ -1100,8 +1497,8 @@ static void api_process_buffer(const char *buffer, size_t buf_size)
     // Handle unsubscribe all
     if (strcasecmp("unsubscribe_all", action) == 0)
     {
-        // Unsubscribe from every subscriptions
-        api_clear_all_subscriptions();
+        // Unsubscribe this client from every subscriptions
+        api_clear_client_subscriptions(api.current_client);
         api_ok(ack_id);
 
         // End
@@ -1448,11 +1845,66 @@ void api_process_multipart_json(const char *buffer, int buf_size)
     }
 }
 
+/**
+ * Accept a pending connection to the API server.
+ */
+static void api_accept_client()
+{
+    TCPsocket sock = SDLNet_TCP_Accept(api.serverSocket);
+    if (!sock)
+    {
+        return;
+    }
+
+    int client_idx = -1;
+    for (int i = 0; i < API_MAX_CLIENTS; i++)
+    {
+        if (api.clients[i].socket == 0)
+        {
+            client_idx = i;
+            break;
+        }
+    }
+    if (client_idx < 0)
+    {
+        SDLNet_TCP_Close(sock);
+        WARNLOG("Got another connection while already at the limit of %d API connections", API_MAX_CLIENTS);
+        return;
+    }
+
+    if (SDLNet_TCP_AddSocket(api.socketSet, sock) == -1)
+    {
+        JUSTLOG("SDLNet_TCP_AddSocket failed! SDLNet_Error: %s", SDLNet_GetError());
+        SDLNet_TCP_Close(sock);
+        return;
+    }
+
+    struct ApiClient *client = &api.clients[client_idx];
+    memset(client, 0, sizeof(struct ApiClient));
+    client->socket = sock;
+    client->lock = SDL_CreateMutex();
+    client->wake = SDL_CreateCond();
+    if ((client->lock != NULL) && (client->wake != NULL))
+    {
+        client->writer = SDL_CreateThread(api_client_writer_thread, "ApiWriter", client);
+    }
+    if (client->writer == NULL)
+    {
+        JUSTLOG("Failed to create API writer thread! SDL_Error: %s", SDL_GetError());
+        api_free_client(client);
+        return;
+    }
+    api.clients_count++;
+    JUSTLOG("API client %d connected", client_idx);
+}
+
 /**
  * Update the API server and handle all pending packets.
  *
  * This function updates the API server by checking for incoming connections and messages.
  * It accepts new client connections, processes incoming messages, and handles disconnections.
+ * Responses are queued and sent by writer threads of the clients, so this never waits for a client.
+ * Game events of turns which can no longer be simulated again are sent here as well.
  */
 void api_update_server()
 {
@@ -1480,37 +1932,22 @@ void api_update_server()
         {
             if (SDLNet_SocketReady(api.serverSocket))
             {
-                if (api.activeSocket != 0)
-                {
-                    TCPsocket tmp = SDLNet_TCP_Accept(api.serverSocket);
-                    SDLNet_TCP_Close(tmp);
-                    WARNLOG("Got another connection while API connection is still active");
-                }
-                else
-                {
-                    api.activeSocket = SDLNet_TCP_Accept(api.serverSocket);
-                    if (!api.activeSocket)
-                    {
-                        continue;
-                    }
-                    JUSTLOG("Client connected");
-                    if (SDLNet_TCP_AddSocket(api.socketSet, api.activeSocket) == -1)
-                    {
-                        JUSTLOG("SDLNet_TCP_AddSocket failed! SDLNet_Error: %s", SDLNet_GetError());
-                        SDLNet_TCP_Close(api.activeSocket);
-                        api.activeSocket = 0;
-                        continue;
-                    }
-                }
+                api_accept_client();
             } // \serverSocket
 
-            if (SDLNet_SocketReady(api.activeSocket))
+            for (int i = 0; i < API_MAX_CLIENTS; i++)
             {
-                int received = SDLNet_TCP_Recv(api.activeSocket, buffer, API_SERVER_BUFFER);
+                struct ApiClient *client = &api.clients[i];
+                if ((client->socket == 0) || client->closing || !SDLNet_SocketReady(client->socket))
+                {
+                    continue;
+                }
+
+                // Leave space for the terminating null byte
+                int received = SDLNet_TCP_Recv(client->socket, buffer, API_SERVER_BUFFER - 1);
                 if (received > 0)
                 {
-                    // TODO: non nullbyte terminated buffers can crash
-                    // For example: when pressing Ctrl C when conneted over telnet
+                    buffer[received] = '\0';
 
                     // Remove any possible trailing newline from the data
                     // This makes it work with a Telnet connection as well
@@ -1519,51 +1956,62 @@ void api_update_server()
                         buffer[strlen(buffer) - 1] = '\0';
                     }
 
-                    // Process all JSON objects in the buffer
+                    // Process all JSON objects in the buffer; responses go to this client
+                    api.current_client = i;
                     api_process_multipart_json(buffer, strlen(buffer));
+                    api.current_client = -1;
                 }
                 else
                 {
-                    api_clear_all_subscriptions();
-                    SDLNet_TCP_DelSocket(api.socketSet, api.activeSocket);
-                    SDLNet_TCP_Close(api.activeSocket);
-                    api.activeSocket = 0;
-                    JUSTLOG("API connection closed");
+                    api_close_client(i);
                 }
 
                 // Clear buffer
                 memset(buffer, 0, API_SERVER_BUFFER);
 
-            } // \activeSocket
+            } // \clients
         }
     } while (numReady > 0); // To have break instead of goto
 
+    // Disconnect clients which failed, and free slots of those whose writer has finished
+    for (int i = 0; i < API_MAX_CLIENTS; i++)
+    {
+        if ((api.clients[i].socket != 0) && api.clients[i].failed)
+        {
+            api_close_client(i);
+        }
+    }
+    api_free_closed_clients(false);
+
     // Handle variable subscriptions
     api_check_var_update();
+
+    api_send_confirmed_events();
+    api_flush();
 }
 
 /**
  * Close the API server.
  *
- * This function stops the API server by closing the server socket and active client socket,
+ * This function stops the writer threads, closes the server socket and all client sockets,
  * and frees the socket set. It also shuts down the SDLNet library.
  */
 void api_close_server()
 {
-    api_clear_all_subscriptions();
-
     JUSTLOG("API server closing");
 
-    if (api.socketSet)
+    for (int i = 0; i < API_MAX_CLIENTS; i++)
     {
-        SDLNet_FreeSocketSet(api.socketSet);
-        api.socketSet = 0;
+        api_close_client(i);
     }
+    // Writers blocked on stalled clients are not waited for
+    api_free_closed_clients(true);
+    api_clear_all_subscriptions();
 
-    if (api.activeSocket)
+    if (api.socketSet)
     {
-        SDLNet_TCP_Close(api.activeSocket);
-        api.activeSocket = 0;
+        SDLNet_FreeSocketSet(api.socketSet);
+        api.socketSet = 0;
     }
 
     if (api.serverSocket)
@@ -1572,5 +2020,10 @@ void api_close_server()
         api.serverSocket = 0;
     }
 
+    free(api.events);
+    api.events = NULL;
+    api.events_count = 0;
+    api.events_size = 0;
+
     SDLNet_Quit();
 }
@@ -1,6 +1,8 @@
 #ifndef API_H
 #define API_H
 
+#include "globals.h"
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -11,6 +13,8 @@ extern "C"
     void api_close_server();
 
     void api_event(const char *event_name);
+    void api_event_with_data(const char *event_name, PlayerNumber plyr_idx, const char *kind_name, long stl_x, long stl_y);
+    void api_discard_events(GameTurn turn);
 
 #ifdef __cplusplus
 }
@@ -39,6 +39,8 @@
 #include "map_columns.h"
 #include "map_utils.h"
 #include "game_legacy.h"
+#include "map_arena.h"
+#include "bflib_rollback.h"
 #include "post_inc.h"
 
 #define EDGEFIT_LEN           64
@@ -74,12 +76,12 @@ static long tree_Ay8;
 static long tree_Bx8;
 static long tree_By8;
 static NavColour *LastTriangulatedMap;
+static struct NavigationCounters navigation_counters;
 static NavColour *fringe_map;
 static long fringe_y1;
 static long fringe_y2;
 static long fringe_x1;
 static long fringe_x2;
-static long fringe_y[MAX_SUBTILES_Y];
 static long ix_Border;
 static long Border[BORDER_LENGTH];
 static long route_fwd[ROUTE_LENGTH];
@@ -358,7 +360,7 @@ void init_navigation_map(void)
 {
     MapSubtlCoord stl_x;
     MapSubtlCoord stl_y;
-    memset(game.navigation_map, 0, sizeof(NavColour)*gameadd.navigation_map_size_x*gameadd.navigation_map_size_y);
+    memset(map_arena.navigation_map, 0, sizeof(NavColour)*gameadd.navigation_map_size_x*gameadd.navigation_map_size_y);
     for (stl_y=0; stl_y < gameadd.navigation_map_size_y; stl_y++)
     {
         for (stl_x=0; stl_x < gameadd.navigation_map_size_x; stl_x++)
@@ -403,7 +405,7 @@ long navigation_rule_normal(NavColour treeA, NavColour treeB)
 
 long init_navigation(void)
 {
-    IanMap = (NavColour *)&game.navigation_map;
+    IanMap = map_arena.navigation_map;
     init_navigation_map();
     triangulate_map(IanMap);
     nav_rulesA2B = navigation_rule_normal;
@@ -411,6 +413,58 @@ long init_navigation(void)
     return 1;
 }
 
+/**
+ * Fills given array with memory regions which hold the triangulation.
+ * Triangulation is updated step by step while the map changes, and making it
+ * from scratch gives different triangles; so it has to be stored and restored
+ * together with the world, rather than made again.
+ * Counters are placed in the regions by navigation_export_state().
+ * @return Amount of regions filled, or 0 if the array is too small.
+ */
+int navigation_state_regions(struct TbRollbackRegion *regions, int max_count)
+{
+    if (max_count < NAVIGATION_STATE_REGIONS_COUNT)
+        return 0;
+    regions[0].ptr = Triangles;
+    regions[0].size = sizeof(Triangles);
+    regions[1].ptr = ari_Points;
+    regions[1].size = POINTS_COUNT * sizeof(struct Point);
+    regions[2].ptr = get_region(0);
+    regions[2].size = REGIONS_COUNT * sizeof(struct RegionT);
+    regions[3].ptr = &navigation_counters;
+    regions[3].size = sizeof(navigation_counters);
+    return NAVIGATION_STATE_REGIONS_COUNT;
+}
+
+/**
+ * Copies triangulation counters into the state regions, before they are stored.
+ */
+void navigation_export_state(void)
+{
+    navigation_counters.free_triangles = free_Triangles;
+    navigation_counters.count_triangles = count_Triangles;
+    navigation_counters.ix_triangles = ix_Triangles;
+    navigation_counters.free_points = get_free_points();
+    navigation_counters.count_points = get_count_points();
+    navigation_counters.ix_points = get_ix_points();
+    triangulation_store_cache(&navigation_counters.find_cache[0][0]);
+}
+
+/**
+ * Sets triangulation counters from the state regions, after they were restored.
+ */
+void navigation_import_state(void)
+{
+    free_Triangles = navigation_counters.free_triangles;
+    count_Triangles = navigation_counters.count_triangles;
+    ix_Triangles = navigation_counters.ix_triangles;
+    set_points_counters(navigation_counters.count_points, navigation_counters.ix_points, navigation_counters.free_points);
+    triangulation_restore_cache(&navigation_counters.find_cache[0][0]);
+    tri_initialised = 1;
+    IanMap = map_arena.navigation_map;
+    LastTriangulatedMap = map_arena.navigation_map;
+}
+
 long update_navigation_triangulation(long start_x, long start_y, long end_x, long end_y)
 {
     long sx;
@@ -4635,13 +4689,13 @@ long fringe_scan(long *outfri_x, long *outfri_y, long *outlen_x, long *outlen_y)
     dist_x = 0;
     for (loc_x = fringe_x1; loc_x < fringe_x2; )
     {
-        if (fringe_y[loc_x] < sub_y)
+        if (map_arena.fringe_y[loc_x] < sub_y)
         {
-          sub_y = fringe_y[loc_x];
+          sub_y = map_arena.fringe_y[loc_x];
           sub_x = loc_x;
           for (loc_x++; loc_x < fringe_x2; loc_x++)
           {
-              if (sub_y != fringe_y[loc_x])
+              if (sub_y != map_arena.fringe_y[loc_x])
                 break;
           }
           dist_x = loc_x - sub_x;
@@ -4692,7 +4746,7 @@ long fringe_get_rectangle(long *outfri_x1, long *outfri_y1, long *outfri_x2, lon
     }
     long i;
     for (i = 0; i < dx; i++) {
-        fringe_y[fri_x+i] = fri_y+dy;
+        map_arena.fringe_y[fri_x+i] = fri_y+dy;
     }
     *oval = fri_map[0];
     *outfri_x1 = fri_x;
@@ -5005,7 +5059,7 @@ TbBool triangulate_area(NavColour *imap, long start_x, long start_y, long end_x,
         fringe_y2 = end_y;
         for (i = start_x; i < end_x; i++)
         {
-            fringe_y[i] = start_y;
+            map_arena.fringe_y[i] = start_y;
         }
         while ( fringe_get_rectangle(&rect_sx, &rect_sy, &rect_ex, &rect_ey, &ccolour) )
         {
@@ -33,6 +33,8 @@ extern "C" {
 #define ROUTE_LENGTH 12000
 #define ARID_WAYPOINTS_COUNT 10
 #define ARID_PATH_WAYPOINTS_COUNT 1400
+/** Amount of memory regions which hold the triangulation. */
+#define NAVIGATION_STATE_REGIONS_COUNT 4
 
 /******************************************************************************/
 #pragma pack(1)
@@ -196,8 +198,24 @@ extern const struct HugStart blocked_xy_hug_start[][2][2];
 
 #pragma pack()
 /******************************************************************************/
+struct TbRollbackRegion;
+
+/** Counters of the triangulation arrays; stored together with the arrays. */
+struct NavigationCounters {
+    long free_triangles;
+    long count_triangles;
+    long ix_triangles;
+    long free_points;
+    long count_points;
+    long ix_points;
+    long find_cache[4][4];
+};
+/******************************************************************************/
 long init_navigation(void);
 long update_navigation_triangulation(long start_x, long start_y, long end_x, long end_y);
+int navigation_state_regions(struct TbRollbackRegion *regions, int max_count);
+void navigation_export_state(void);
+void navigation_import_state(void);
 TbBool triangulate_area(NavColour *imap, long sx, long sy, long ex, long ey);
 
 AriadneReturn ariadne_initialise_creature_route_f(struct Thing *thing, const struct Coord3d *pos, long speed, AriadneRouteFlags flags, const char *func_name);
@@ -141,6 +141,19 @@ void triangulation_init_cache(long tri_idx)
     }
 }
 
+/**
+ * Copies the cache to or from given buffer, when the triangulation is stored or restored.
+ */
+void triangulation_store_cache(long *cache)
+{
+    memcpy(cache, find_cache, sizeof(find_cache));
+}
+
+void triangulation_restore_cache(const long *cache)
+{
+    memcpy(find_cache, cache, sizeof(find_cache));
+}
+
 long triangle_find8(long pt_x, long pt_y)
 {
     NAVIDBG(19,"Starting");
@@ -36,6 +36,8 @@ long triangle_find_cache_get(long pos_x, long pos_y);
 void triangle_find_cache_put(long pos_x, long pos_y, long ntri);
 
 void triangulation_init_cache(long tri_idx);
+void triangulation_store_cache(long *cache);
+void triangulation_restore_cache(const long *cache);
 
 long triangle_find8(long pt_x, long pt_y);
 TbBool point_find(long pt_x, long pt_y, long *out_tri_idx, long *out_cor_idx);
@@ -58,6 +58,21 @@ long get_free_points()
     return free_Points;
 }
 
+long get_count_points()
+{
+    return count_Points;
+}
+
+/**
+ * Sets the points array counters, when the array is restored from a stored state.
+ */
+void set_points_counters(long count, long ix, long free_idx)
+{
+    count_Points = count;
+    ix_Points = ix;
+    free_Points = free_idx;
+}
+
 AridPointId point_new(void)
 {
     AridPointId i;
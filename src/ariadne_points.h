@@ -57,6 +57,8 @@ void triangulation_initxy_points(long startx, long starty, long endx, long endy)
 
 long get_ix_points();
 long get_free_points();
+long get_count_points();
+void set_points_counters(long count, long ix, long free_idx);
 /******************************************************************************/
 #ifdef __cplusplus
 }
@@ -52,6 +52,7 @@ void region_set_f(long ntri, unsigned long nreg, const char *func_name);
 void region_unset_f(long ntri, unsigned long nreg, const char *func_name);
 void region_unlock(long ntri);
 void triangulation_init_regions(void);
+struct RegionT *get_region(long reg_id);
 
 /******************************************************************************/
 #ifdef __cplusplus
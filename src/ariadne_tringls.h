@@ -45,6 +45,7 @@ struct Triangle {
 
 /******************************************************************************/
 extern struct Triangle Triangles[TRIANLGLES_COUNT];
+extern long free_Triangles;
 extern long count_Triangles;
 extern long ix_Triangles;
 
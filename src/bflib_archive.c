@@ -0,0 +1,326 @@
+/******************************************************************************/
+// Bullfrog Engine Emulation Library - for use to remake classic games like
+// Syndicate Wars, Magic Carpet or Dungeon Keeper.
+/******************************************************************************/
+/** @file bflib_archive.c
+ *     Packed data archive, memory mapped and with an index of files.
+ * @par Purpose:
+ *     Allows loading game data from one file instead of many small ones.
+ *     The archive is mapped into memory, and files are looked up in a sorted
+ *     index; data is stored unpacked, so no RNC decompression is needed.
+ * @par Comment:
+ *     Files which aren't in the archive are loaded from disk as usual.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#include "pre_inc.h"
+#include "bflib_archive.h"
+#include "globals.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "bflib_basics.h"
+#include "bflib_dernc.h"
+#include "bflib_fileio.h"
+#include "post_inc.h"
+
+#define ARCHIVE_PATH_SIZE 2048
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+struct TbArchive {
+    HANDLE file;
+    HANDLE mapping;
+    const unsigned char *data;
+    unsigned long size;
+    const struct TbArchiveEntry *entries;
+    unsigned long entries_count;
+    char base_dir[ARCHIVE_PATH_SIZE];
+    size_t base_len;
+};
+
+struct TbArchiveBuilder {
+    struct TbArchiveEntry *entries;
+    unsigned long entries_count;
+    unsigned long entries_size;
+    size_t base_len;
+};
+
+static struct TbArchive archive;
+/******************************************************************************/
+/**
+ * Converts file name to the form stored in archive index.
+ * @return False if the name doesn't fit.
+ */
+static TbBool archive_normalize_name(char *dst, const char *src)
+{
+    size_t len = 0;
+    while ((src[0] == '.') && ((src[1] == '/') || (src[1] == '\\')))
+        src += 2;
+    for (; *src != '\0'; src++)
+    {
+        if (len + 1 >= ARCHIVE_NAME_LEN)
+            return false;
+        char c = *src;
+        if (c == '\\')
+            c = '/';
+        // Skip doubled separators, as paths are often joined without checking
+        if ((c == '/') && (len > 0) && (dst[len-1] == '/'))
+            continue;
+        dst[len++] = tolower((unsigned char)c);
+    }
+    dst[len] = '\0';
+    return true;
+}
+
+static int archive_entry_compare(const void *ptr1, const void *ptr2)
+{
+    const struct TbArchiveEntry* entry1 = (const struct TbArchiveEntry *)ptr1;
+    const struct TbArchiveEntry* entry2 = (const struct TbArchiveEntry *)ptr2;
+    return strcmp(entry1->name, entry2->name);
+}
+
+/**
+ * Maps given archive into memory; files within base_dir will then be loaded from it.
+ */
+TbBool LbArchiveOpen(const char *fname, const char *base_dir)
+{
+    LbArchiveClose();
+    archive.file = CreateFile(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (archive.file == INVALID_HANDLE_VALUE)
+    {
+        ERRORLOG("Cannot open archive \"%s\"", fname);
+        archive.file = NULL;
+        return false;
+    }
+    archive.size = GetFileSize(archive.file, NULL);
+    archive.mapping = CreateFileMapping(archive.file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (archive.mapping != NULL)
+        archive.data = (const unsigned char *)MapViewOfFile(archive.mapping, FILE_MAP_READ, 0, 0, 0);
+    if (archive.data == NULL)
+    {
+        ERRORLOG("Cannot map archive \"%s\" into memory", fname);
+        LbArchiveClose();
+        return false;
+    }
+    const struct TbArchiveHeader* head = (const struct TbArchiveHeader *)archive.data;
+    if ((archive.size < sizeof(struct TbArchiveHeader)) || (memcmp(head->signature, ARCHIVE_SIGNATURE, 4) != 0)
+        || (head->version != ARCHIVE_VERSION) || (head->index_offset > archive.size)
+        || ((archive.size - head->index_offset) / sizeof(struct TbArchiveEntry) < head->entries_count))
+    {
+        ERRORLOG("Archive \"%s\" is not valid", fname);
+        LbArchiveClose();
+        return false;
+    }
+    archive.entries = (const struct TbArchiveEntry *)(archive.data + head->index_offset);
+    archive.entries_count = head->entries_count;
+    for (unsigned long i = 0; i < archive.entries_count; i++)
+    {
+        const struct TbArchiveEntry* entry = &archive.entries[i];
+        if ((entry->offset > archive.size) || (entry->size > archive.size - entry->offset)
+            || (memchr(entry->name, '\0', ARCHIVE_NAME_LEN) == NULL))
+        {
+            ERRORLOG("Archive \"%s\" entry %lu is damaged", fname, i);
+            LbArchiveClose();
+            return false;
+        }
+    }
+    snprintf(archive.base_dir, sizeof(archive.base_dir), "%s", base_dir);
+    archive.base_len = strlen(archive.base_dir);
+    SYNCMSG("Using archive \"%s\" with %lu files", fname, archive.entries_count);
+    return true;
+}
+
+void LbArchiveClose(void)
+{
+    if (archive.data != NULL)
+        UnmapViewOfFile(archive.data);
+    if (archive.mapping != NULL)
+        CloseHandle(archive.mapping);
+    if (archive.file != NULL)
+        CloseHandle(archive.file);
+    memset(&archive, 0, sizeof(archive));
+}
+
+TbBool LbArchiveIsOpen(void)
+{
+    return (archive.data != NULL);
+}
+
+/**
+ * Looks for a file in the archive.
+ * @param fname File name, as given to file loading functions.
+ * @param len Receives length of the data.
+ * @return Pointer to data within the mapped archive, or NULL if the file isn't there.
+ */
+const void *LbArchiveFind(const char *fname, unsigned long *len)
+{
+    if (archive.entries_count == 0)
+        return NULL;
+    if ((archive.base_len > 0) && (strncasecmp(fname, archive.base_dir, archive.base_len) == 0)
+        && ((fname[archive.base_len] == '/') || (fname[archive.base_len] == '\\')))
+        fname += archive.base_len + 1;
+    struct TbArchiveEntry key;
+    if (!archive_normalize_name(key.name, fname))
+        return NULL;
+    const struct TbArchiveEntry* entry = (const struct TbArchiveEntry *)bsearch(&key, archive.entries,
+        archive.entries_count, sizeof(struct TbArchiveEntry), archive_entry_compare);
+    if (entry == NULL)
+        return NULL;
+    *len = entry->size;
+    return archive.data + entry->offset;
+}
+/******************************************************************************/
+static TbBool archive_builder_add(struct TbArchiveBuilder *abld, const char *path)
+{
+    if (abld->entries_count >= abld->entries_size)
+    {
+        unsigned long nsize = (abld->entries_size > 0) ? abld->entries_size * 2 : 256;
+        struct TbArchiveEntry* entries = (struct TbArchiveEntry *)realloc(abld->entries, nsize * sizeof(struct TbArchiveEntry));
+        if (entries == NULL)
+            return false;
+        abld->entries = entries;
+        abld->entries_size = nsize;
+    }
+    struct TbArchiveEntry* entry = &abld->entries[abld->entries_count];
+    memset(entry, 0, sizeof(struct TbArchiveEntry));
+    if (!archive_normalize_name(entry->name, path + abld->base_len + 1))
+    {
+        WARNLOG("Name of \"%s\" is too long to be archived; skipped", path);
+        return true;
+    }
+    abld->entries_count++;
+    return true;
+}
+
+static TbBool archive_builder_add_dir(struct TbArchiveBuilder *abld, const char *dir, int depth)
+{
+    char spec[ARCHIVE_PATH_SIZE];
+    struct TbFileEntry fe;
+    snprintf(spec, sizeof(spec), "%s/*", dir);
+    struct TbFileFind* ff = LbFileFindFirst(spec, &fe);
+    TbBool ok = true;
+    for (int rc = (ff != NULL) ? 1 : -1; (rc != -1) && ok; rc = LbFileFindNext(ff, &fe))
+    {
+        if ((strcmp(fe.Filename, ".") == 0) || (strcmp(fe.Filename, "..") == 0))
+            continue;
+        char path[ARCHIVE_PATH_SIZE];
+        snprintf(path, sizeof(path), "%s/%s", dir, fe.Filename);
+        // Only directories can be searched inside
+        snprintf(spec, sizeof(spec), "%s/*", path);
+        struct TbFileEntry subfe;
+        struct TbFileFind* subff = LbFileFindFirst(spec, &subfe);
+        if (subff != NULL)
+        {
+            LbFileFindEnd(subff);
+            if (depth > 0)
+                ok = archive_builder_add_dir(abld, path, depth - 1);
+            continue;
+        }
+        ok = archive_builder_add(abld, path);
+    }
+    LbFileFindEnd(ff);
+    return ok;
+}
+
+static TbBool archive_builder_write(struct TbArchiveBuilder *abld, const char *fname, const char *base_dir)
+{
+    TbFileHandle handle = LbFileOpen(fname, Lb_FILE_MODE_NEW);
+    if (!handle)
+    {
+        ERRORLOG("Cannot create archive \"%s\"", fname);
+        return false;
+    }
+    struct TbArchiveHeader head;
+    memset(&head, 0, sizeof(head));
+    TbBool ok = (LbFileWrite(handle, &head, sizeof(head)) == sizeof(head));
+    unsigned long pos = sizeof(head);
+    static const unsigned char padding[ARCHIVE_DATA_ALIGN];
+    for (unsigned long i = 0; (i < abld->entries_count) && ok; i++)
+    {
+        struct TbArchiveEntry* entry = &abld->entries[i];
+        char path[ARCHIVE_PATH_SIZE];
+        snprintf(path, sizeof(path), "%s/%s", base_dir, entry->name);
+        long len = LbFileLengthRnc(path);
+        unsigned char* buf = (len >= 0) ? (unsigned char *)malloc(len + 1) : NULL;
+        if (buf == NULL)
+        {
+            ERRORLOG("Cannot read \"%s\" into archive", path);
+            ok = false;
+            break;
+        }
+        len = LbFileLoadAt(path, buf);
+        unsigned long pad = (ARCHIVE_DATA_ALIGN - pos % ARCHIVE_DATA_ALIGN) % ARCHIVE_DATA_ALIGN;
+        if ((len < 0) || (LbFileWrite(handle, padding, pad) != (long)pad))
+            ok = false;
+        pos += pad;
+        entry->offset = pos;
+        entry->size = len;
+        if (ok && (LbFileWrite(handle, buf, len) != len))
+            ok = false;
+        pos += len;
+        free(buf);
+    }
+    memcpy(head.signature, ARCHIVE_SIGNATURE, 4);
+    head.version = ARCHIVE_VERSION;
+    head.entries_count = abld->entries_count;
+    head.index_offset = pos;
+    long index_len = abld->entries_count * sizeof(struct TbArchiveEntry);
+    if (ok)
+        ok = (LbFileWrite(handle, abld->entries, index_len) == index_len);
+    if (ok)
+        ok = (LbFileSeek(handle, 0, Lb_FILE_SEEK_BEGINNING) != -1) && (LbFileWrite(handle, &head, sizeof(head)) == sizeof(head));
+    LbFileClose(handle);
+    if (!ok)
+    {
+        ERRORLOG("Writing archive \"%s\" failed", fname);
+        LbFileDelete(fname);
+    }
+    return ok;
+}
+
+/**
+ * Creates archive from all files within given subdirectories of base_dir.
+ * @param subdirs List of subdirectories, terminated with NULL.
+ */
+TbBool LbArchiveBuild(const char *fname, const char *base_dir, const char * const *subdirs)
+{
+    struct TbArchiveBuilder abld;
+    memset(&abld, 0, sizeof(abld));
+    abld.base_len = strlen(base_dir);
+    // Files must be read from disk, not from the archive being replaced
+    LbArchiveClose();
+    TbBool ok = true;
+    for (int i = 0; (subdirs[i] != NULL) && ok; i++)
+    {
+        char dir[ARCHIVE_PATH_SIZE];
+        snprintf(dir, sizeof(dir), "%s/%s", base_dir, subdirs[i]);
+        ok = archive_builder_add_dir(&abld, dir, 4);
+    }
+    if (ok)
+    {
+        qsort(abld.entries, abld.entries_count, sizeof(struct TbArchiveEntry), archive_entry_compare);
+        ok = archive_builder_write(&abld, fname, base_dir);
+    }
+    if (ok)
+        SYNCMSG("Archive \"%s\" created with %lu files", fname, abld.entries_count);
+    free(abld.entries);
+    return ok;
+}
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
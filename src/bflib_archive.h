@@ -0,0 +1,64 @@
+/******************************************************************************/
+// Bullfrog Engine Emulation Library - for use to remake classic games like
+// Syndicate Wars, Magic Carpet or Dungeon Keeper.
+/******************************************************************************/
+/** @file bflib_archive.h
+ *     Header file for bflib_archive.c.
+ * @par Purpose:
+ *     Packed data archive, memory mapped and with an index of files.
+ * @par Comment:
+ *     Just a header file - #defines, typedefs, function prototypes etc.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#ifndef BFLIB_ARCHIVE_H
+#define BFLIB_ARCHIVE_H
+
+#include "bflib_basics.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+#define ARCHIVE_SIGNATURE "KFXA"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_NAME_LEN 120
+#define ARCHIVE_DATA_ALIGN 16
+/******************************************************************************/
+#pragma pack(1)
+
+struct TbArchiveHeader {
+    char signature[4];
+    uint32_t version;
+    uint32_t entries_count;
+    /** Offset of the index, which is an array of TbArchiveEntry sorted by name. */
+    uint32_t index_offset;
+};
+
+struct TbArchiveEntry {
+    /** Path relative to the game directory, lower case with '/' separators. */
+    char name[ARCHIVE_NAME_LEN];
+    uint32_t offset;
+    /** Size of the data, which is stored already unpacked. */
+    uint32_t size;
+};
+
+#pragma pack()
+/******************************************************************************/
+TbBool LbArchiveOpen(const char *fname, const char *base_dir);
+void LbArchiveClose(void);
+TbBool LbArchiveIsOpen(void);
+const void *LbArchiveFind(const char *fname, unsigned long *len);
+TbBool LbArchiveBuild(const char *fname, const char *base_dir, const char * const *subdirs);
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+#endif
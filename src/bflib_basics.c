@@ -176,6 +176,7 @@ short error_log_initialised=false;
 struct TbLog error_log;
 /******************************************************************************/
 int LbLog(struct TbLog *log, const char *fmt_str, va_list arg);
+static TbBool LbLogRateAllows(enum TbLogCategory category);
 /******************************************************************************/
 
 int LbErrorLog(const char *format, ...)
@@ -187,6 +188,8 @@ int LbErrorLog(const char *format, ...)
     va_start(val, format);
     int result=LbLog(&error_log, format, val);
     va_end(val);
+    // Errors often precede a crash, so don't leave them waiting in the queue
+    LbLogFlush();
     return result;
 }
 
@@ -194,6 +197,8 @@ int LbWarnLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Warning))
+        return 0;
     LbLogSetPrefix(&error_log, "Warning: ");
     va_list val;
     va_start(val, format);
@@ -206,6 +211,8 @@ int LbAiLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Ai))
+        return 0;
     LbLogSetPrefix(&error_log, "Skirmish AI: ");
     va_list val;
     va_start(val, format);
@@ -218,6 +225,8 @@ int LbNetLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Net))
+        return 0;
     LbLogSetPrefix(&error_log, "Net: ");
     va_list val;
     va_start(val, format);
@@ -230,6 +239,8 @@ int LbSyncLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Sync))
+        return 0;
     LbLogSetPrefix(&error_log, "Sync: ");
     va_list val;
     va_start(val, format);
@@ -242,6 +253,8 @@ int LbNaviLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Navi))
+        return 0;
     LbLogSetPrefix(&error_log, "Navi: ");
     va_list val;
     va_start(val, format);
@@ -264,6 +277,8 @@ int LbFTestLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_FTest))
+        return 0;
     LbLogSetPrefix(&error_log, "FTest: ");
     va_list val;
     va_start(val, format);
@@ -280,6 +295,8 @@ int LbScriptLog(unsigned long line,const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Script))
+        return 0;
     LbLogSetPrefixFmt(&error_log, "Script(line %lu): ",line);
     va_list val;
     va_start(val, format);
@@ -295,6 +312,8 @@ int LbConfigLog(unsigned long line,const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Config))
+        return 0;
     LbLogSetPrefixFmt(&error_log, "Config(line %lu): ",line);
     va_list val;
     va_start(val, format);
@@ -307,6 +326,8 @@ int LbJustLog(const char *format, ...)
 {
     if (!error_log_initialised)
         return -1;
+    if (!LbLogRateAllows(LbLogCat_Just))
+        return 0;
     LbLogSetPrefix(&error_log, "");
     va_list val;
     va_start(val, format);
@@ -315,6 +336,246 @@ int LbJustLog(const char *format, ...)
     return result;
 }
 
+/******************************************************************************/
+// Asynchronous log writer.
+// Lines are formatted by the thread which logs them, and queued in a ring of
+// fixed size slots; a long line occupies several consecutive slots. Slots are
+// reserved with compare-and-swap on the enqueue position, so logging never
+// takes a lock. A background thread writes the queued text in batches.
+#define LOG_RING_SLOT_SIZE    240
+#define LOG_RING_SLOTS_COUNT 4096
+#define LOG_WRITER_PERIOD_MS   50
+#define LOG_LINE_SIZE        (2*MAX_TEXT_LENGTH)
+
+struct LogRingSlot {
+    /** Position for which the slot is free (pos) or filled (pos+1). */
+    SDL_atomic_t sequence;
+    unsigned short length;
+    char text[LOG_RING_SLOT_SIZE];
+};
+
+struct LogRateLimit {
+    unsigned long msgs_per_sec;
+    unsigned long window_start;
+    unsigned long count;
+    unsigned long suppressed;
+};
+
+static struct LogRingSlot log_ring[LOG_RING_SLOTS_COUNT];
+static SDL_atomic_t log_ring_enqueue_pos;
+static SDL_atomic_t log_ring_dequeue_pos;
+static SDL_SpinLock log_ring_consumer_lock = 0;
+static SDL_sem *log_writer_wakeup = NULL;
+static SDL_Thread *log_writer_thread = NULL;
+static SDL_atomic_t log_writer_active;
+
+static struct LogRateLimit log_rate_limits[LbLogCat_ListEnd];
+static const char *log_category_prefix[LbLogCat_ListEnd] = {
+    "Error: ", "Warning: ", "Sync: ", "Net: ", "Skirmish AI: ", "Navi: ", "Script: ", "Config: ", "", "FTest: ",
+};
+
+FILE *file = NULL;
+
+/**
+ * Queues text in the log ring.
+ * @return False if there is not enough free space in the ring.
+ */
+static TbBool log_ring_push(const char *text, size_t len)
+{
+    unsigned int nslots = (len + LOG_RING_SLOT_SIZE - 1) / LOG_RING_SLOT_SIZE;
+    if (nslots == 0)
+        return true;
+    if (nslots > LOG_RING_SLOTS_COUNT / 2)
+    {
+        nslots = LOG_RING_SLOTS_COUNT / 2;
+        len = nslots * LOG_RING_SLOT_SIZE;
+    }
+    unsigned int pos;
+    for (;;)
+    {
+        pos = (unsigned int)SDL_AtomicGet(&log_ring_enqueue_pos);
+        // Slots are released in order, so if the last one is free then all of them are
+        unsigned int last = pos + nslots - 1;
+        int diff = (int)((unsigned int)SDL_AtomicGet(&log_ring[last % LOG_RING_SLOTS_COUNT].sequence) - last);
+        if (diff == 0)
+        {
+            if (SDL_AtomicCAS(&log_ring_enqueue_pos, (int)pos, (int)(pos + nslots)))
+                break;
+        } else
+        if (diff < 0)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < nslots; i++)
+    {
+        struct LogRingSlot *slot = &log_ring[(pos + i) % LOG_RING_SLOTS_COUNT];
+        size_t chunk = (len < LOG_RING_SLOT_SIZE) ? len : LOG_RING_SLOT_SIZE;
+        memcpy(slot->text, text, chunk);
+        slot->length = chunk;
+        text += chunk;
+        len -= chunk;
+        SDL_AtomicSet(&slot->sequence, (int)(pos + i + 1));
+    }
+    return true;
+}
+
+/**
+ * Writes all the queued text into log file. Caller must hold the consumer lock.
+ */
+static size_t log_ring_drain(void)
+{
+    size_t written = 0;
+    unsigned int pos = (unsigned int)SDL_AtomicGet(&log_ring_dequeue_pos);
+    for (;;)
+    {
+        struct LogRingSlot *slot = &log_ring[pos % LOG_RING_SLOTS_COUNT];
+        if ((unsigned int)SDL_AtomicGet(&slot->sequence) != pos + 1)
+            break;
+        if (file != NULL)
+            fwrite(slot->text, 1, slot->length, file);
+        written += slot->length;
+        SDL_AtomicSet(&slot->sequence, (int)(pos + LOG_RING_SLOTS_COUNT));
+        pos++;
+    }
+    SDL_AtomicSet(&log_ring_dequeue_pos, (int)pos);
+    if ((written > 0) && (file != NULL))
+        fflush(file);
+    return written;
+}
+
+/**
+ * Writes everything queued so far into the log file.
+ * Safe to call from crash handlers - gives up if the writer is stuck.
+ */
+int LbLogFlush(void)
+{
+    int tries = 0;
+    while (!SDL_AtomicTryLock(&log_ring_consumer_lock))
+    {
+        if (++tries > 500)
+            return -1;
+        SDL_Delay(1);
+    }
+    size_t written = log_ring_drain();
+    SDL_AtomicUnlock(&log_ring_consumer_lock);
+    return (written > 0);
+}
+
+static int log_writer_thread_func(void *data)
+{
+    while (SDL_AtomicGet(&log_writer_active))
+    {
+        SDL_SemWaitTimeout(log_writer_wakeup, LOG_WRITER_PERIOD_MS);
+        LbLogFlush();
+    }
+    return 0;
+}
+
+static void log_writer_start(void)
+{
+    if (SDL_AtomicGet(&log_writer_active))
+        return;
+    for (unsigned int i = 0; i < LOG_RING_SLOTS_COUNT; i++)
+    {
+        SDL_AtomicSet(&log_ring[i].sequence, (int)i);
+    }
+    SDL_AtomicSet(&log_ring_enqueue_pos, 0);
+    SDL_AtomicSet(&log_ring_dequeue_pos, 0);
+    if (log_writer_wakeup == NULL)
+        log_writer_wakeup = SDL_CreateSemaphore(0);
+    if (log_writer_wakeup == NULL)
+        return;
+    SDL_AtomicSet(&log_writer_active, 1);
+    log_writer_thread = SDL_CreateThread(log_writer_thread_func, "LogWriter", NULL);
+    if (log_writer_thread == NULL)
+        SDL_AtomicSet(&log_writer_active, 0);
+}
+
+static void log_writer_stop(void)
+{
+    if (!SDL_AtomicGet(&log_writer_active))
+        return;
+    SDL_AtomicSet(&log_writer_active, 0);
+    SDL_SemPost(log_writer_wakeup);
+    // We may get here from a crash handler; never wait for ourselves
+    if (SDL_ThreadID() != SDL_GetThreadID(log_writer_thread))
+        SDL_WaitThread(log_writer_thread, NULL);
+    else
+        SDL_DetachThread(log_writer_thread);
+    log_writer_thread = NULL;
+    LbLogFlush();
+}
+
+static void log_write_text(const char *text, size_t len)
+{
+    if (!SDL_AtomicGet(&log_writer_active))
+    {
+        fwrite(text, 1, len, file);
+        fflush(file);
+        return;
+    }
+    while (!log_ring_push(text, len))
+    {
+        // The ring is full - rather than dropping the line, help the writer
+        if (LbLogFlush() <= 0)
+            SDL_Delay(1);
+    }
+    unsigned int pending = (unsigned int)SDL_AtomicGet(&log_ring_enqueue_pos) - (unsigned int)SDL_AtomicGet(&log_ring_dequeue_pos);
+    if (pending > LOG_RING_SLOTS_COUNT / 4)
+        SDL_SemPost(log_writer_wakeup);
+}
+
+/**
+ * Limits amount of messages of given category which are written every second.
+ * @param msgs_per_sec Max messages per second, or 0 to remove the limit.
+ */
+void LbLogSetRateLimit(enum TbLogCategory category, unsigned long msgs_per_sec)
+{
+    if ((category < 0) || (category >= LbLogCat_ListEnd))
+        return;
+    struct LogRateLimit *rlimit = &log_rate_limits[category];
+    rlimit->msgs_per_sec = msgs_per_sec;
+    rlimit->window_start = SDL_GetTicks();
+    rlimit->count = 0;
+    rlimit->suppressed = 0;
+}
+
+static int LbLogPrintf(struct TbLog *log, const char *format, ...)
+{
+    va_list val;
+    va_start(val, format);
+    int result=LbLog(log, format, val);
+    va_end(val);
+    return result;
+}
+
+static TbBool LbLogRateAllows(enum TbLogCategory category)
+{
+    struct LogRateLimit *rlimit = &log_rate_limits[category];
+    if (rlimit->msgs_per_sec == 0)
+        return true;
+    unsigned long now = SDL_GetTicks();
+    if (now - rlimit->window_start >= 1000)
+    {
+        if (rlimit->suppressed > 0)
+        {
+            LbLogSetPrefix(&error_log, log_category_prefix[category]);
+            LbLogPrintf(&error_log, "%lu messages suppressed by rate limit\n", rlimit->suppressed);
+        }
+        rlimit->window_start = now;
+        rlimit->count = 0;
+        rlimit->suppressed = 0;
+    }
+    if (rlimit->count >= rlimit->msgs_per_sec)
+    {
+        rlimit->suppressed++;
+        return false;
+    }
+    rlimit->count++;
+    return true;
+}
+
 int LbErrorLogSetup(const char *directory, const char *filename, TbBool flag)
 {
   if ( error_log_initialised )
@@ -333,6 +594,7 @@ int LbErrorLogSetup(const char *directory, const char *filename, TbBool flag)
   if ( LbLogSetup(&error_log, log_filename, flags) == 1 )
   {
     error_log_initialised = 1;
+    log_writer_start();
     result = 1;
   } else
   {
@@ -345,36 +607,44 @@ int LbErrorLogClose(void)
 {
     if (!error_log_initialised)
         return -1;
+    log_writer_stop();
     return LbLogClose(&error_log);
 }
 
-FILE *file = NULL;
-
 void LbCloseLog()
 {
+    log_writer_stop();
+    LbLogFlush();
     fclose(file);
     file = NULL;
 }
 
-void write_log_to_array_for_live_viewing(const char* fmt_str, va_list args, const char* add_log_prefix) {
+void write_log_to_array_for_live_viewing(const char* message, const char* add_log_prefix) {
     if (consoleLogArraySize >= MAX_CONSOLE_LOG_COUNT) {
         // Array is full - so clear it. This is a bit of a stopgap solution, it will lose us the older entries.
         memset(consoleLogArray, 0, sizeof(consoleLogArray));
         consoleLogArraySize = 0;
     }
 
-    char formattedString[MAX_TEXT_LENGTH];
-    vsnprintf(formattedString, sizeof(formattedString), fmt_str, args);
-
-    char buffer[MAX_TEXT_LENGTH];
-    snprintf(buffer, sizeof(buffer), "%s%s", add_log_prefix, formattedString); // merge prefix and formatted string
-
     // Add the combined message to the array
-    strncpy(consoleLogArray[consoleLogArraySize], buffer, MAX_TEXT_LENGTH);
-    consoleLogArray[consoleLogArraySize][MAX_TEXT_LENGTH - 1] = '\0';
+    snprintf(consoleLogArray[consoleLogArraySize], MAX_TEXT_LENGTH, "%s%s", add_log_prefix, message); // merge prefix and formatted string
     consoleLogArraySize++;
 }
 
+static void log_text_append(char *text, int *len, const char *format, ...)
+{
+    if (*len >= LOG_LINE_SIZE - 1)
+        return;
+    va_list val;
+    va_start(val, format);
+    int n = vsnprintf(text + *len, LOG_LINE_SIZE - *len, format, val);
+    va_end(val);
+    if (n > 0)
+        *len += n;
+    if (*len > LOG_LINE_SIZE - 1)
+        *len = LOG_LINE_SIZE - 1;
+}
+
 int LbLog(struct TbLog *log, const char *fmt_str, va_list arg)
 {
   enum Header {
@@ -421,27 +691,29 @@ int LbLog(struct TbLog *log, const char *fmt_str, va_list arg)
         return -1;
     }
     log->Created = true;
+    char text[LOG_LINE_SIZE];
+    int len = 0;
     if (header != NONE)
     {
       if ( need_initial_newline )
-        fprintf(file, "\n");
+        log_text_append(text, &len, "\n");
       const char *actn;
       if (header == CREATE)
       {
-        fprintf(file, PROGRAM_NAME" ver "VER_STRING" (%s release) git:%s\n", (BFDEBUG_LEVEL>7)?"heavylog":"standard", GIT_REVISION);
+        log_text_append(text, &len, PROGRAM_NAME" ver "VER_STRING" (%s release) git:%s\n", (BFDEBUG_LEVEL>7)?"heavylog":"standard", GIT_REVISION);
         actn = "CREATED";
       } else
       {
         actn = "APPENDED";
       }
-      fprintf(file, "LOG %s", actn);
+      log_text_append(text, &len, "LOG %s", actn);
       short at_used = 0;
       if ((log->flags & LbLog_TimeInHeader) != 0)
       {
         struct TbTime curr_time;
         if (LbTime(&curr_time) == Lb_SUCCESS)
         {
-            fprintf(file, "  @ %02u:%02u:%02u",
+            log_text_append(text, &len, "  @ %02u:%02u:%02u",
                 curr_time.Hour,curr_time.Minute,curr_time.Second);
             at_used = 1;
         }
@@ -456,17 +728,17 @@ int LbLog(struct TbLog *log, const char *fmt_str, va_list arg)
               sep = " ";
             else
               sep = "  @ ";
-            fprintf(file," %s%02u-%02u-%u",sep,curr_date.Day,curr_date.Month,curr_date.Year);
+            log_text_append(text, &len, " %s%02u-%02u-%u",sep,curr_date.Day,curr_date.Month,curr_date.Year);
         }
       }
-      fprintf(file, "\n\n");
+      log_text_append(text, &len, "\n\n");
     }
     if ((log->flags & LbLog_DateInLines) != 0)
     {
         struct TbDate curr_date;
         if (LbDate(&curr_date) == Lb_SUCCESS)
         {
-            fprintf(file,"%02u-%02u-%u ",curr_date.Day,curr_date.Month,curr_date.Year);
+            log_text_append(text, &len, "%02u-%02u-%u ",curr_date.Day,curr_date.Month,curr_date.Year);
         }
     }
     if ((log->flags & LbLog_TimeInLines) != 0)
@@ -474,23 +746,20 @@ int LbLog(struct TbLog *log, const char *fmt_str, va_list arg)
         struct TbTime curr_time;
         if (LbTime(&curr_time) == Lb_SUCCESS)
         {
-            fprintf(file, "%02u:%02u:%02u ",
+            log_text_append(text, &len, "%02u:%02u:%02u ",
                 curr_time.Hour,curr_time.Minute,curr_time.Second);
         }
     }
-  if (log->prefix[0] != '\0') {
-      fputs(log->prefix, file);
-  }
-
-  // Write formatted message to the array
-  write_log_to_array_for_live_viewing(fmt_str, arg, log->prefix);
-
-  vfprintf(file, fmt_str, arg);
-  log->position = ftell(file);
-  // fclose is slow and automatically happens on normal program exit.
-  // Opening/closing every time we log something hits performance hard.
-  // fclose(file);
-  fflush(file);
+  // Format the message only once; it goes both to the file and to the live view
+  char message[MAX_TEXT_LENGTH];
+  vsnprintf(message, sizeof(message), fmt_str, arg);
+  write_log_to_array_for_live_viewing(message, log->prefix);
+
+  log_text_append(text, &len, "%s%s", log->prefix, message);
+  // The file stays open, and writes are batched by the writer thread;
+  // opening/closing or flushing every time we log something hits performance hard.
+  log_write_text(text, len);
+  log->position += len;
   return 1;
 }
 
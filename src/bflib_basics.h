@@ -56,6 +56,20 @@ enum TbLogFlags {
         LbLog_LoopedFile   = 0x0100,
 };
 
+enum TbLogCategory {
+        LbLogCat_Error = 0,
+        LbLogCat_Warning,
+        LbLogCat_Sync,
+        LbLogCat_Net,
+        LbLogCat_Ai,
+        LbLogCat_Navi,
+        LbLogCat_Script,
+        LbLogCat_Config,
+        LbLogCat_Just,
+        LbLogCat_FTest,
+        LbLogCat_ListEnd,
+};
+
 enum TbErrorCode {
     Lb_FAIL                 = -1,
     Lb_OK                   =  0,
@@ -160,6 +174,8 @@ int LbLogSetPrefix(struct TbLog *log, const char *prefix);
 int LbLogSetPrefixFmt(struct TbLog *log, const char *format, ...) __attribute__ ((format(printf, 2, 3)));
 
 void LbCloseLog();
+int LbLogFlush(void);
+void LbLogSetRateLimit(enum TbLogCategory category, unsigned long msgs_per_sec);
 /******************************************************************************/
 typedef void (*TbNetworkCallbackFunc)(struct TbNetworkCallbackData *, void *);
 /******************************************************************************/
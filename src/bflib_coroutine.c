@@ -19,9 +19,12 @@
 
 #include "bflib_basics.h"
 #include "bflib_coroutine.h"
+#include "bflib_datetm.h"
 #include <string.h>
 #include "post_inc.h"
 
+CoroutineTasks coroutine_frame_tasks;
+
 // add a new coroutine to the list
 void coroutine_add(CoroutineLoop *context, CoroutineFn fn)
 {
@@ -80,3 +83,115 @@ void coroutine_clear(CoroutineLoop *context, TbBool error)
     context->write_idx = 0;
     context->error |= error;
 }
+
+CoroutineTask *coroutine_task_start(CoroutineTasks *sched, const char *name, CoroutineTaskFn fn, void *context, TbClockMSec budget)
+{
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        CoroutineTask *task = &sched->tasks[i];
+        if (task->active)
+            continue;
+        memset(task, 0, sizeof(CoroutineTask));
+        task->name = name;
+        task->fn = fn;
+        task->context = context;
+        task->budget = budget;
+        task->active = true;
+        SYNCDBG(8,"Task \"%s\" started in slot %d", name, i);
+        return task;
+    }
+    WARNLOG("No free slot for task \"%s\"", name);
+    return NULL;
+}
+
+CoroutineTask *coroutine_task_find(CoroutineTasks *sched, CoroutineTaskFn fn, void *context)
+{
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        CoroutineTask *task = &sched->tasks[i];
+        if (task->active && (task->fn == fn) && (task->context == context))
+            return task;
+    }
+    return NULL;
+}
+
+void coroutine_task_cancel(CoroutineTask *task)
+{
+    task->active = false;
+}
+
+// exec one step of the task; returns true if the task wants another step in this frame
+static TbBool coroutine_task_step(CoroutineTask *task)
+{
+    CoroutineLoopState ret = task->fn(task);
+    task->steps++;
+    switch (ret)
+    {
+    case CLS_REPEAT:
+        return true;
+    case CLS_RETURN:
+        return false;
+    case CLS_ABORT:
+        WARNLOG("Task \"%s\" aborted after %lu steps", task->name, task->steps);
+        task->error = true;
+        task->active = false;
+        return false;
+    case CLS_CONTINUE:
+    default:
+        SYNCDBG(8,"Task \"%s\" finished after %lu steps on %lu frames", task->name, task->steps, task->frames);
+        task->active = false;
+        return false;
+    }
+}
+
+void coroutine_tasks_process(CoroutineTasks *sched)
+{
+    TbClockMSec (*clock)(void) = sched->clock;
+    if (clock == NULL)
+        clock = LbTimerClock;
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        CoroutineTask *task = &sched->tasks[i];
+        if (!task->active)
+            continue;
+        task->frames++;
+        // At least one step is made on every frame, so that every task advances
+        TbClockMSec start = clock();
+        while (coroutine_task_step(task))
+        {
+            if (clock() - start >= task->budget)
+                break;
+        }
+    }
+}
+
+void coroutine_tasks_finish(CoroutineTasks *sched)
+{
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        CoroutineTask *task = &sched->tasks[i];
+        while (task->active)
+        {
+            coroutine_task_step(task);
+        }
+    }
+}
+
+void coroutine_tasks_clear(CoroutineTasks *sched)
+{
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        sched->tasks[i].active = false;
+    }
+}
+
+int coroutine_tasks_count(const CoroutineTasks *sched)
+{
+    int count = 0;
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        if (sched->tasks[i].active)
+            count++;
+    }
+    return count;
+}
@@ -64,6 +64,55 @@ extern void coroutine_process(CoroutineLoop *context);
 
 extern int *coroutine_args(CoroutineLoop *context);
 
+/******************************************************************************/
+#define COROUTINE_TASKS_MAX 16
+
+/*
+ * Long running task, split into steps which are executed on consecutive frames.
+ *
+ * Step function returns CLS_REPEAT if there is more work, CLS_RETURN to wait
+ * until next frame, CLS_CONTINUE when the task is finished and CLS_ABORT on failure.
+ */
+struct CoroutineTaskS;
+
+typedef CoroutineLoopState (*CoroutineTaskFn)(struct CoroutineTaskS *task);
+
+typedef struct CoroutineTaskS
+{
+    const char      *name;
+    CoroutineTaskFn fn;
+    void            *context;
+    long            progress;   // Position from which the next step continues, for use by the task
+    TbClockMSec     budget;     // Time the task may take on each frame, in milliseconds
+    unsigned long   frames;     // Amount of frames on which the task was processed
+    unsigned long   steps;
+    TbBool          active;
+    TbBool          error;
+} CoroutineTask;
+
+typedef struct CoroutineTasksS
+{
+    CoroutineTask   tasks[COROUTINE_TASKS_MAX];
+    TbClockMSec     (*clock)(void); // Source of time in milliseconds; LbTimerClock() if not set
+} CoroutineTasks;
+
+// tasks processed on each frame of the game
+extern CoroutineTasks coroutine_frame_tasks;
+
+// start a new task; returns NULL if there is no free slot
+extern CoroutineTask *coroutine_task_start(CoroutineTasks *sched, const char *name, CoroutineTaskFn fn, void *context, TbClockMSec budget);
+// find an active task with given step function and context
+extern CoroutineTask *coroutine_task_find(CoroutineTasks *sched, CoroutineTaskFn fn, void *context);
+// stop a task without finishing it
+extern void coroutine_task_cancel(CoroutineTask *task);
+// exec steps of all tasks, each until its budget for this frame is spent
+extern void coroutine_tasks_process(CoroutineTasks *sched);
+// exec all tasks until they're finished, ignoring the budget; waiting tasks are called again at once
+extern void coroutine_tasks_finish(CoroutineTasks *sched);
+// stop all tasks without finishing them
+extern void coroutine_tasks_clear(CoroutineTasks *sched);
+extern int coroutine_tasks_count(const CoroutineTasks *sched);
+
 #ifdef __cplusplus
 }
 #endif
@@ -40,6 +40,18 @@
 #include "post_inc.h"
 
 /******************************************************************************/
+/** Called before the process goes down, to save whatever can still be saved. */
+static TbErrorParachuteCallback parachute_callback = NULL;
+/******************************************************************************/
+static void call_parachute_callback(void)
+{
+    TbErrorParachuteCallback callback = parachute_callback;
+    // Clear it first, so a failure inside the callback won't run it again
+    parachute_callback = NULL;
+    if (callback != NULL)
+        callback();
+}
+
 static const char* sigstr(int s)
 {
   switch(s)
@@ -86,12 +98,14 @@ static const char* sigstr(int s)
 void exit_handler(void)
 {
     LbErrorLog("Application exit called.\n");
+    call_parachute_callback();
 }
 
 void ctrl_handler(int sig_id)
 {
     signal(sig_id, SIG_DFL);
     LbErrorLog("Failure signal: %s.\n",sigstr(sig_id));
+    call_parachute_callback();
     LbScreenReset(true);
     LbErrorLogClose();
     raise(sig_id);
@@ -321,6 +335,7 @@ static LONG CALLBACK ctrl_handler_w32(LPEXCEPTION_POINTERS info)
             _backtrace(16 , info->ContextRecord);
             SymCleanup(GetCurrentProcess());
     }
+    call_parachute_callback();
     LbScreenReset(true);
     LbErrorLogClose();
     return EXCEPTION_EXECUTE_HANDLER;
@@ -349,4 +364,9 @@ void LbErrorParachuteUpdate(void)
 {
     SetUnhandledExceptionFilter(ctrl_handler_w32);
 }
+
+void LbErrorParachuteSetCallback(TbErrorParachuteCallback callback)
+{
+    parachute_callback = callback;
+}
 /******************************************************************************/
@@ -28,8 +28,11 @@
 extern "C" {
 #endif
 /******************************************************************************/
+typedef void (*TbErrorParachuteCallback)(void);
+/******************************************************************************/
 void LbErrorParachuteInstall(void);
 void LbErrorParachuteUpdate(void);
+void LbErrorParachuteSetCallback(TbErrorParachuteCallback callback);
 /******************************************************************************/
 #ifdef __cplusplus
 }
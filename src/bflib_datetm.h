@@ -45,12 +45,13 @@ TbResult LbTimerInit(void);
 TbClockMSec LbTimerClock_1000(void);
 /******************************************************************************/
 
-#define TOTAL_FRAMETIME_KINDS 4
+#define TOTAL_FRAMETIME_KINDS 5
 enum FrametimeKinds {
     Frametime_FullFrame = 0,
     Frametime_Logic = 1,
     Frametime_Draw = 2,
     Frametime_Sleep = 3,
+    Frametime_Present = 4,
 };
 struct FrametimeMeasurements {
     float starting_measurement[TOTAL_FRAMETIME_KINDS];
@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -33,6 +34,7 @@
 #endif
 
 #include "bflib_basics.h"
+#include "bflib_archive.h"
 #include "bflib_fileio.h"
 #include "globals.h"
 #include "post_inc.h"
@@ -449,6 +451,10 @@ long rnc_crc(void *data, unsigned long len)
 long LbFileLengthRnc(const char *fname)
 {
     long flength;
+    unsigned long arclen;
+    if (LbArchiveFind(fname, &arclen) != NULL) {
+        return arclen;
+    }
     TbFileHandle handle = LbFileOpen(fname, Lb_FILE_MODE_READ_ONLY);
     if (!handle) {
         return -1;
@@ -509,6 +515,13 @@ long UnpackM1(void * buffer, ulong bufsize)
 
 long LbFileLoadAt(const char *fname, void *buffer)
 {
+  unsigned long arclen;
+  const void *arcdata = LbArchiveFind(fname, &arclen);
+  if (arcdata != NULL)
+  {
+      memcpy(buffer, arcdata, arclen);
+      return arclen;
+  }
   long filelength = LbFileLengthRnc(fname);
   TbFileHandle handle = NULL;
   if (filelength!=-1)
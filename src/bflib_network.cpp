@@ -1127,6 +1127,55 @@ TbError LbNetwork_ExchangeClient(void *send_buf, void *server_buf, size_t client
     return Lb_OK;
 }
 
+/*
+ * Sends client frame without waiting for the server frame; for clients
+ * which simulate ahead of the server.
+ */
+TbError LbNetwork_SendFrame(void *send_buf, size_t client_frame_size)
+{
+    NETDBG(7, "Starting");
+    SendClientFrame((char *) send_buf, client_frame_size, netstate.seq_nbr);
+    return Lb_OK;
+}
+
+/*
+ * Reads the next server frame, if it has arrived within timeout.
+ * Frames are returned one by one, so that a resync message following
+ * a frame is left for LbNetwork_Resync().
+ */
+TbBool LbNetwork_ReceiveFrame(void *server_buf, size_t client_frame_size, unsigned timeout)
+{
+    NETDBG(7, "Starting");
+    while (netstate.exchg_queue == NULL)
+    {
+        if (netstate.sp->msgready(SERVER_ID, timeout) == 0) {
+            break;
+        }
+        if (ProcessMessage(SERVER_ID, server_buf, client_frame_size) == Lb_FAIL) {
+            break;
+        }
+    }
+    netstate.sp->update(OnNewUser);
+    if (netstate.exchg_queue == NULL) {
+        return false;
+    }
+    ConsumeServerFrame(server_buf, client_frame_size);
+    return true;
+}
+
+TbBool LbNetwork_IsServer(void)
+{
+    return (netstate.users[netstate.my_id].progress == USER_SERVER);
+}
+
+/*
+ * Largest client frame for which a server frame, carrying the frames of all users, fits into the message buffer
+ */
+size_t LbNetwork_MaxFrameSize(void)
+{
+    return (sizeof(netstate.msg_buffer) - sizeof(char) - sizeof(int) - sizeof(char)) / MAX_N_USERS;
+}
+
 /*
  * send_buf is a buffer inside shared buffer which sent to a server
  * server_buf is a buffer shared between all clients and server
@@ -1137,6 +1186,12 @@ TbError LbNetwork_Exchange(void *send_buf, void *server_buf, size_t client_frame
 
     assert(UserIdentifiersValid());
 
+    if (client_frame_size > LbNetwork_MaxFrameSize())
+    {
+        ERRORLOG("Frame of %u bytes doesn't fit into network message buffer", (unsigned)client_frame_size);
+        return Lb_FAIL;
+    }
+
     if (netstate.users[netstate.my_id].progress == USER_SERVER)
     {
         return LbNetwork_ExchangeServer(server_buf, client_frame_size);
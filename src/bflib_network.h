@@ -228,6 +228,10 @@ TbError LbNetwork_Create(char *nsname_str, char *plyr_name, unsigned long *plyr_
 TbError LbNetwork_ExchangeServer(void *server_buf, size_t buf_size);
 TbError LbNetwork_ExchangeClient(void *send_buf, void *server_buf, size_t buf_size);
 TbError LbNetwork_Exchange(void *send_buf, void *server_buf, size_t buf_size);
+size_t  LbNetwork_MaxFrameSize(void);
+TbError LbNetwork_SendFrame(void *send_buf, size_t buf_size);
+TbBool  LbNetwork_ReceiveFrame(void *server_buf, size_t buf_size, unsigned timeout);
+TbBool  LbNetwork_IsServer(void);
 TbBool  LbNetwork_Resync(void * buf, size_t len);
 void    LbNetwork_ChangeExchangeTimeout(unsigned long tmout);
 TbError LbNetwork_EnableNewPlayers(TbBool allow);
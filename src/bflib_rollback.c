@@ -0,0 +1,335 @@
+/******************************************************************************/
+// Dungeon Keeper fan extension.
+/******************************************************************************/
+/** @file bflib_rollback.c
+ *     Simulation ahead of confirmed input, with rollback on misprediction.
+ * @par Purpose:
+ *     Allows simulating turns before inputs of remote players arrive. Inputs
+ *     of the remote players are predicted, and state is stored before every
+ *     few predicted turns; when the real input differs from the prediction,
+ *     the state is restored and the turns are simulated again.
+ * @par Comment:
+ *     The simulation has to be deterministic; all of the state which it
+ *     modifies has to be within the registered regions.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#include "pre_inc.h"
+#include "bflib_rollback.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bflib_basics.h"
+#include "globals.h"
+#include "post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+static void rollback_save_state(struct TbRollback *rb, unsigned char *state)
+{
+    if (rb->cb.before_save != NULL)
+        rb->cb.before_save();
+    for (int i = 0; i < rb->regions_count; i++)
+    {
+        memcpy(state, rb->regions[i].ptr, rb->regions[i].size);
+        state += rb->regions[i].size;
+    }
+}
+
+static void rollback_restore_state(struct TbRollback *rb, const unsigned char *state)
+{
+    for (int i = 0; i < rb->regions_count; i++)
+    {
+        memcpy(rb->regions[i].ptr, state, rb->regions[i].size);
+        state += rb->regions[i].size;
+    }
+    if (rb->cb.after_restore != NULL)
+        rb->cb.after_restore();
+}
+
+static unsigned char *rollback_turn_inputs(struct TbRollback *rb, unsigned long turn)
+{
+    return rb->inputs[turn % ROLLBACK_HISTORY_TURNS];
+}
+
+static void rollback_predict_inputs(struct TbRollback *rb, unsigned char *inputs)
+{
+    for (int i = 0; i < rb->players_count; i++)
+    {
+        if (i == rb->local_player)
+            continue;
+        rb->cb.predict(inputs + i * rb->input_size, rb->last_confirmed + i * rb->input_size);
+    }
+}
+
+static TbBool rollback_inputs_equal(struct TbRollback *rb, const unsigned char *inputs1, const unsigned char *inputs2)
+{
+    for (int i = 0; i < rb->players_count; i++)
+    {
+        if (!rb->cb.inputs_equal(inputs1 + i * rb->input_size, inputs2 + i * rb->input_size))
+            return false;
+    }
+    return true;
+}
+
+static void rollback_store_checksum(struct TbRollback *rb, unsigned long turn)
+{
+    rb->checksums[turn % ROLLBACK_HISTORY_TURNS] = rb->cb.checksum();
+}
+
+/**
+ * Stores current state as a snapshot taken before given turn.
+ */
+static void rollback_add_snapshot(struct TbRollback *rb, unsigned long turn)
+{
+    if (rb->snapshots_count >= ROLLBACK_MAX_SNAPSHOTS)
+    {
+        ERRORLOG("No free rollback snapshot for turn %lu", turn);
+        return;
+    }
+    struct TbRollbackSnapshot* snap = &rb->snapshots[rb->snapshots_count];
+    snap->turn = turn;
+    rollback_save_state(rb, snap->state);
+    rb->snapshots_count++;
+}
+
+/**
+ * Drops snapshots which are older than needed to restore the first predicted turn.
+ */
+static void rollback_drop_old_snapshots(struct TbRollback *rb)
+{
+    unsigned long first_pending = rb->next_turn - rb->pending_count;
+    while ((rb->snapshots_count > 1) && (rb->snapshots[1].turn <= first_pending))
+    {
+        struct TbRollbackSnapshot oldest = rb->snapshots[0];
+        memmove(&rb->snapshots[0], &rb->snapshots[1], (rb->snapshots_count - 1) * sizeof(struct TbRollbackSnapshot));
+        rb->snapshots[rb->snapshots_count - 1] = oldest;
+        rb->snapshots_count--;
+    }
+}
+
+TbBool LbRollbackInit(struct TbRollback *rb, const struct TbRollbackRegion *regions, int regions_count,
+    size_t input_size, int players_count, int local_player, const struct TbRollbackCallbacks *cb)
+{
+    memset(rb, 0, sizeof(struct TbRollback));
+    if ((regions_count <= 0) || (regions_count > ROLLBACK_MAX_REGIONS))
+    {
+        ERRORLOG("Invalid amount of state regions, %d", regions_count);
+        return false;
+    }
+    for (int i = 0; i < regions_count; i++)
+    {
+        rb->regions[i] = regions[i];
+        rb->state_size += regions[i].size;
+    }
+    rb->regions_count = regions_count;
+    rb->input_size = input_size;
+    rb->players_count = players_count;
+    rb->local_player = local_player;
+    rb->cb = *cb;
+    size_t inputs_size = input_size * players_count;
+    rb->last_confirmed = (unsigned char *)calloc(inputs_size, 1);
+    TbBool ok = (rb->last_confirmed != NULL);
+    for (int i = 0; (i < ROLLBACK_HISTORY_TURNS) && ok; i++)
+    {
+        rb->inputs[i] = (unsigned char *)calloc(inputs_size, 1);
+        ok = (rb->inputs[i] != NULL);
+    }
+    for (int i = 0; (i < ROLLBACK_MAX_SNAPSHOTS) && ok; i++)
+    {
+        rb->snapshots[i].state = (unsigned char *)malloc(rb->state_size);
+        ok = (rb->snapshots[i].state != NULL);
+    }
+    if (!ok)
+    {
+        ERRORLOG("Cannot allocate %lu bytes of rollback states", (unsigned long)(rb->state_size * ROLLBACK_MAX_SNAPSHOTS));
+        LbRollbackFree(rb);
+        return false;
+    }
+    return true;
+}
+
+void LbRollbackFree(struct TbRollback *rb)
+{
+    for (int i = 0; i < ROLLBACK_HISTORY_TURNS; i++)
+    {
+        free(rb->inputs[i]);
+        rb->inputs[i] = NULL;
+    }
+    for (int i = 0; i < ROLLBACK_MAX_SNAPSHOTS; i++)
+    {
+        free(rb->snapshots[i].state);
+        rb->snapshots[i].state = NULL;
+    }
+    free(rb->last_confirmed);
+    rb->last_confirmed = NULL;
+    rb->pending_count = 0;
+    rb->snapshots_count = 0;
+}
+
+/**
+ * Forgets all predicted turns; to be used when a new simulation starts.
+ */
+void LbRollbackReset(struct TbRollback *rb)
+{
+    rb->snapshots_count = 0;
+    rb->pending_count = 0;
+    rb->next_turn = 0;
+    rb->force_resimulate = false;
+    rb->rebased = false;
+    rb->resimulating = false;
+    if (rb->last_confirmed != NULL)
+        memset(rb->last_confirmed, 0, rb->input_size * rb->players_count);
+    memset(rb->checksums, 0, sizeof(rb->checksums));
+}
+
+/**
+ * Prepares a turn to be simulated before its input is confirmed.
+ * @param inputs Inputs of all players; the local player input should be filled,
+ *  inputs of other players are replaced with predicted ones.
+ * @return False if the turn cannot be predicted, because too many turns
+ *  are waiting for confirmation already.
+ */
+TbBool LbRollbackPredictTurn(struct TbRollback *rb, void *inputs)
+{
+    if (rb->pending_count >= ROLLBACK_MAX_TURNS)
+        return false;
+    rollback_predict_inputs(rb, (unsigned char *)inputs);
+    memcpy(rollback_turn_inputs(rb, rb->next_turn), inputs, rb->input_size * rb->players_count);
+    if ((rb->snapshots_count <= 0) ||
+        (rb->next_turn >= rb->snapshots[rb->snapshots_count - 1].turn + ROLLBACK_SNAPSHOT_INTERVAL))
+    {
+        rollback_add_snapshot(rb, rb->next_turn);
+    }
+    rb->pending_count++;
+    rb->next_turn++;
+    return true;
+}
+
+/**
+ * Registers a turn which is simulated with confirmed input right away.
+ */
+void LbRollbackConfirmedTurn(struct TbRollback *rb, const void *inputs)
+{
+    if (rb->pending_count > 0)
+    {
+        ERRORLOG("Turn %lu simulated while %d turns are not confirmed", rb->next_turn, rb->pending_count);
+    }
+    memcpy(rb->last_confirmed, inputs, rb->input_size * rb->players_count);
+    rb->next_turn++;
+}
+
+/**
+ * Stores checksum of the state after a turn simulated by the caller.
+ */
+void LbRollbackTurnDone(struct TbRollback *rb)
+{
+    if (rb->resimulating || (rb->next_turn == 0))
+        return;
+    rollback_store_checksum(rb, rb->next_turn - 1);
+}
+
+/**
+ * Confirms the oldest predicted turn. If the confirmed inputs differ from the
+ * predicted ones, the newest snapshot taken before that turn is restored, and
+ * all turns since the snapshot are simulated again.
+ * @return Amount of turns simulated again, or -1 if there was no turn to confirm.
+ */
+int LbRollbackConfirmTurn(struct TbRollback *rb, const void *inputs)
+{
+    if (rb->pending_count <= 0)
+        return -1;
+    unsigned long turn = rb->next_turn - rb->pending_count;
+    unsigned char* turn_inputs = rollback_turn_inputs(rb, turn);
+    memcpy(rb->last_confirmed, inputs, rb->input_size * rb->players_count);
+    TbBool mispredicted = !rollback_inputs_equal(rb, turn_inputs, (const unsigned char *)inputs);
+    memcpy(turn_inputs, inputs, rb->input_size * rb->players_count);
+    rb->pending_count--;
+    if (!mispredicted && !rb->force_resimulate)
+    {
+        rollback_drop_old_snapshots(rb);
+        return 0;
+    }
+    rb->force_resimulate = false;
+    int snap_idx = rb->snapshots_count - 1;
+    while ((snap_idx > 0) && (rb->snapshots[snap_idx].turn > turn))
+        snap_idx--;
+    if ((snap_idx < 0) || (rb->snapshots[snap_idx].turn > turn))
+    {
+        ERRORLOG("No rollback snapshot for turn %lu", turn);
+        return 0;
+    }
+    unsigned long first_turn = rb->snapshots[snap_idx].turn;
+    rb->resimulating = true;
+    rollback_restore_state(rb, rb->snapshots[snap_idx].state);
+    for (unsigned long resim_turn = first_turn; resim_turn < rb->next_turn; resim_turn++)
+    {
+        turn_inputs = rollback_turn_inputs(rb, resim_turn);
+        if (resim_turn > turn)
+        {
+            rollback_predict_inputs(rb, turn_inputs);
+        }
+        // Newer snapshots were taken with the old predictions
+        for (int i = snap_idx + 1; i < rb->snapshots_count; i++)
+        {
+            if (rb->snapshots[i].turn == resim_turn)
+                rollback_save_state(rb, rb->snapshots[i].state);
+        }
+        rb->resimulated_turn = resim_turn;
+        rb->cb.simulate(turn_inputs);
+        rollback_store_checksum(rb, resim_turn);
+        if (rb->rebased && (resim_turn == first_turn))
+        {
+            // The state stored from outside is not at a turn boundary; replace it with one which is
+            rb->rebased = false;
+            rb->snapshots[snap_idx].turn = resim_turn + 1;
+            rollback_save_state(rb, rb->snapshots[snap_idx].state);
+        }
+    }
+    rb->resimulating = false;
+    int resimulated = (int)(rb->next_turn - first_turn);
+    rb->resimulated_turns += resimulated;
+    rollback_drop_old_snapshots(rb);
+    return resimulated;
+}
+
+/**
+ * Makes the current state a base for predicted turns. To be used when the
+ * state was replaced from outside, ie. by resynchronization; the oldest
+ * predicted turn is then simulated again when confirmed.
+ */
+void LbRollbackRebase(struct TbRollback *rb)
+{
+    if (rb->pending_count <= 0)
+        return;
+    // Any older snapshots are not consistent with the new state
+    rb->snapshots_count = 0;
+    rollback_add_snapshot(rb, rb->next_turn - rb->pending_count);
+    rb->force_resimulate = true;
+    rb->rebased = true;
+}
+
+/**
+ * Returns checksum of the turn simulated ROLLBACK_MAX_TURNS turns before the
+ * last one. That turn is always confirmed, so the value is the same for all
+ * players, no matter how far ahead they are simulating.
+ */
+unsigned long LbRollbackDelayedChecksum(const struct TbRollback *rb)
+{
+    if (rb->next_turn <= ROLLBACK_MAX_TURNS)
+        return 0;
+    return rb->checksums[(rb->next_turn - 1 - ROLLBACK_MAX_TURNS) % ROLLBACK_HISTORY_TURNS];
+}
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
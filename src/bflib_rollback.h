@@ -0,0 +1,107 @@
+/******************************************************************************/
+// Dungeon Keeper fan extension.
+/******************************************************************************/
+/** @file bflib_rollback.h
+ *     Header file for bflib_rollback.c.
+ * @par Purpose:
+ *     Simulation ahead of confirmed input, with rollback on misprediction.
+ * @par Comment:
+ *     Just a header file - #defines, typedefs, function prototypes etc.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#ifndef BFLIB_ROLLBACK_H
+#define BFLIB_ROLLBACK_H
+
+#include "globals.h"
+#include "bflib_basics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Amount of turns which may be simulated ahead of confirmed input. */
+#define ROLLBACK_MAX_TURNS      8
+#define ROLLBACK_MAX_REGIONS    8
+/** State is stored before every n-th predicted turn; turns between snapshots are simulated again from their inputs. */
+#define ROLLBACK_SNAPSHOT_INTERVAL 4
+/** Amount of turns whose inputs are kept, back to the oldest needed snapshot. */
+#define ROLLBACK_HISTORY_TURNS  (ROLLBACK_MAX_TURNS + ROLLBACK_SNAPSHOT_INTERVAL)
+#define ROLLBACK_MAX_SNAPSHOTS  (ROLLBACK_MAX_TURNS / ROLLBACK_SNAPSHOT_INTERVAL + 1)
+/******************************************************************************/
+/** Memory block which is a part of the simulation state. */
+struct TbRollbackRegion {
+    void *ptr;
+    size_t size;
+};
+
+struct TbRollbackCallbacks {
+    /** Simulates one turn using given inputs of all players. */
+    void (*simulate)(const void *inputs);
+    /** Fills input of a player for a turn whose real input is not known yet. */
+    void (*predict)(void *input, const void *last_input);
+    /** Returns true if two inputs lead to the same simulation result. */
+    TbBool (*inputs_equal)(const void *input1, const void *input2);
+    /** Returns checksum of the state after simulating a turn. */
+    unsigned long (*checksum)(void);
+    /** Called before the state regions are copied; may be NULL. */
+    void (*before_save)(void);
+    /** Called after the state regions were restored; may be NULL. */
+    void (*after_restore)(void);
+};
+
+struct TbRollbackSnapshot {
+    unsigned long turn; //! Turn before which the state was stored
+    unsigned char *state;
+};
+
+struct TbRollback {
+    struct TbRollbackRegion regions[ROLLBACK_MAX_REGIONS];
+    int regions_count;
+    size_t state_size;
+    size_t input_size;
+    int players_count;
+    int local_player;
+    struct TbRollbackCallbacks cb;
+    /** Inputs of all players used for recent turns, indexed by turn modulo the array size. */
+    unsigned char *inputs[ROLLBACK_HISTORY_TURNS];
+    /** Stored states, oldest first; the oldest one is never newer than the first predicted turn. */
+    struct TbRollbackSnapshot snapshots[ROLLBACK_MAX_SNAPSHOTS];
+    int snapshots_count;
+    /** Amount of turns simulated with predicted input, ending at next_turn. */
+    int pending_count;
+    /** Inputs of all players from the last confirmed turn. */
+    unsigned char *last_confirmed;
+    unsigned long next_turn;
+    /** Checksums of recent turns, indexed by turn modulo the array size. */
+    unsigned long checksums[ROLLBACK_HISTORY_TURNS];
+    /** Turn which is being simulated again; valid while resimulating. */
+    unsigned long resimulated_turn;
+    TbBool resimulating;
+    TbBool force_resimulate;
+    /** The oldest snapshot was stored from outside, in the middle of its turn. */
+    TbBool rebased;
+    unsigned long resimulated_turns;
+};
+/******************************************************************************/
+TbBool LbRollbackInit(struct TbRollback *rb, const struct TbRollbackRegion *regions, int regions_count,
+    size_t input_size, int players_count, int local_player, const struct TbRollbackCallbacks *cb);
+void LbRollbackFree(struct TbRollback *rb);
+void LbRollbackReset(struct TbRollback *rb);
+TbBool LbRollbackPredictTurn(struct TbRollback *rb, void *inputs);
+void LbRollbackConfirmedTurn(struct TbRollback *rb, const void *inputs);
+int LbRollbackConfirmTurn(struct TbRollback *rb, const void *inputs);
+void LbRollbackTurnDone(struct TbRollback *rb);
+void LbRollbackRebase(struct TbRollback *rb);
+unsigned long LbRollbackDelayedChecksum(const struct TbRollback *rb);
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -22,6 +22,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 #include "bflib_basics.h"
 #include "bflib_math.h"
@@ -70,6 +71,7 @@ SoundEmitterID get_emitter_id(struct SoundEmitter *emit);
 long get_sample_id(struct S3DSample *sample);
 void kick_out_sample(short smpl_id);
 TbBool emitter_is_playing(struct SoundEmitter *emit);
+TbBool sound_position_in_hearing_range(const struct SoundCoord3d *pos);
 TbBool remove_active_samples_from_emitter(struct SoundEmitter *emit);
 /******************************************************************************/
 // Functions
@@ -371,6 +373,20 @@ long get_sound_squareedge_distance(const struct SoundCoord3d *pos1, const struct
     return dist_x + dist_y + dist_z;
 }
 
+/**
+ * Checks if a sound at given position can be heard by the receiver.
+ * Positions outside of a box around the receiver are rejected without computing the distance.
+ */
+TbBool sound_position_in_hearing_range(const struct SoundCoord3d *pos)
+{
+    const struct SoundCoord3d* rpos = &Receiver.pos;
+    if ((max(pos->val_x, rpos->val_x) - min(pos->val_x, rpos->val_x) > MaxSoundDistance) ||
+        (max(pos->val_y, rpos->val_y) - min(pos->val_y, rpos->val_y) > MaxSoundDistance) ||
+        (max(pos->val_z, rpos->val_z) - min(pos->val_z, rpos->val_z) > MaxSoundDistance))
+        return false;
+    return (get_sound_distance(pos, rpos) <= MaxSoundDistance);
+}
+
 long get_emitter_distance(struct SoundReceiver *recv, struct SoundEmitter *emit)
 {
     long dist = get_sound_distance(&recv->pos, &emit->pos);
@@ -502,19 +518,32 @@ long set_emitter_pan_volume_pitch(struct SoundEmitter *emit, long pan, long volu
     return 1;
 }
 
+/**
+ * Updates pan, volume and pitch of emitters which are playing.
+ * Emitters are found through the list of playing samples, so emitters which are
+ * silent or out of hearing range (their samples are kicked out) cost nothing.
+ */
 TbBool process_sound_emitters(void)
 {
-    struct SoundEmitter *emit;
+    TbBool emit_playing[SOUND_EMITTERS_MAX];
     long pan;
     long volume;
     long pitch;
-    long i;
-    for (i=1; i < NoSoundEmitters; i++)
+    memset(emit_playing, 0, sizeof(emit_playing));
+    for (long i = 0; i < MaxNoSounds; i++)
+    {
+        struct S3DSample* sample = &SampleList[i];
+        if ((sample->is_playing != 0) && (sample->emit_ptr != NULL))
+        {
+            emit_playing[sample->emit_ptr->index] = true;
+        }
+    }
+    for (long i = 1; i < NoSoundEmitters; i++)
     {
-        emit = S3DGetSoundEmitter(i);
+        struct SoundEmitter* emit = &emitter[i];
         if ( ((emit->flags & Emi_IsAllocated) != 0) && ((emit->flags & Emi_UnknownPlay) != 0) )
         {
-            if ( emitter_is_playing(emit) )
+            if (emit_playing[i])
             {
                 get_emitter_pan_volume_pitch(&Receiver, emit, &pan, &volume, &pitch);
                 set_emitter_pan_volume_pitch(emit, pan, volume, pitch);
@@ -574,37 +603,40 @@ long stop_emitter_samples(struct SoundEmitter *emit)
     return num_stopped;
 }
 
+/**
+ * Finds a voice for the sample; reuses the voice if the emitter plays that sample already,
+ * or takes a free voice, or steals the one with lowest priority if it's below spcmax.
+ */
 short find_slot(long fild8, SoundBankID bank_id, struct SoundEmitter *emit, long ctype, long spcmax)
 {
-    struct S3DSample *sample;
-    long i;
-    long spcval = 2147483647;
-    short min_sample_id = SOUNDS_MAX_COUNT;
-    if ((ctype == 2) || (ctype == 3))
+    TbBool same_sample_reused = ((ctype == 2) || (ctype == 3));
+    unsigned long spcval = ULONG_MAX;
+    short min_sample_id = -1;
+    short free_sample_id = -1;
+    for (long i = 0; i < MaxNoSounds; i++)
     {
-        for (i=0; i < MaxNoSounds; i++)
+        struct S3DSample* sample = &SampleList[i];
+        if (sample->is_playing == 0)
         {
-            sample = &SampleList[i];
-            if ( (sample->is_playing) && (sample->emit_ptr != NULL) )
-            {
-                if ( (sample->emit_ptr->index == emit->index)
-                  && (sample->smptbl_id == fild8) && (sample->bank_id == bank_id) )
-                    return i;
-            }
+            if (free_sample_id < 0)
+                free_sample_id = i;
+            continue;
         }
-    }
-    for (i=0; i < MaxNoSounds; i++)
-    {
-        sample = &SampleList[i];
-        if (sample->is_playing == 0)
-            return i;
-        if (spcval > sample->priority)
+        if (same_sample_reused && (sample->emit_ptr != NULL))
+        {
+            if ( (sample->emit_ptr->index == emit->index)
+              && (sample->smptbl_id == fild8) && (sample->bank_id == bank_id) )
+                return i;
+        }
+        if ((free_sample_id < 0) && (spcval > sample->priority))
         {
             min_sample_id = i;
             spcval = sample->priority;
         }
     }
-    if (spcval >= spcmax)
+    if (free_sample_id >= 0)
+        return free_sample_id;
+    if ((min_sample_id < 0) || (spcval >= (unsigned long)spcmax))
     {
         return -1;
     }
@@ -862,7 +894,7 @@ TbBool process_sound_samples(void)
             if (sample->emit_ptr != NULL)
             {
               if ( (sample->volume == 0) ||
-                 ( ((sample->emit_ptr->field_1 & 0x08) == 0) && (get_sound_distance(&sample->emit_ptr->pos, &Receiver.pos) > MaxSoundDistance) ) )
+                 ( ((sample->emit_ptr->field_1 & 0x08) == 0) && !sound_position_in_hearing_range(&sample->emit_ptr->pos) ) )
                 kick_out_sample(i);
             }
         }
@@ -946,6 +978,9 @@ long start_emitter_playing(struct SoundEmitter *emit, SoundSmplTblID smptbl_id,
     long pan;
     long volume;
     long pitch;
+    // Samples out of hearing range would be kicked out on next update; don't steal a voice for them
+    if (((emit->field_1 & 0x08) == 0) && !sound_position_in_hearing_range(&emit->pos))
+        return 0;
     get_emitter_pan_volume_pitch(&Receiver, emit, &pan, &volume, &pitch);
     long smpl_idx = find_slot(smptbl_id, bank_id, emit, ctype, priority);
     volume = (volume * loudness) / 256;
@@ -88,6 +88,13 @@ static unsigned char fade_started;
 static unsigned char from_pal[PALETTE_SIZE];
 static unsigned char to_pal[PALETTE_SIZE];
 static long fade_count;
+/** Palette converted to pixel format of the window surface, used when presenting 8-bit draw surface. */
+static Uint32 lbPresentLut[PALETTE_COLORS];
+/** Pixel format for which lbPresentLut was prepared; unknown if it needs to be rebuilt. */
+static Uint32 lbPresentLutFormat = SDL_PIXELFORMAT_UNKNOWN;
+/** Draw surface palette and its version from which lbPresentLut was prepared. */
+static const SDL_Palette *lbPresentLutPalette = NULL;
+static Uint32 lbPresentLutPaletteVersion = 0;
 
 /******************************************************************************/
 void *LbExeReferenceNumber(void)
@@ -135,6 +142,67 @@ TbResult LbScreenUnlock(void)
     return Lb_SUCCESS;
 }
 
+/** Copies 8-bit draw surface into a 32-bit window surface of the same size, converting colours through LUT.
+ *  This avoids SDL_BlitSurface() validating and selecting its generic blitter on every frame.
+ *
+ * @return True if the surface was presented, false if the surfaces don't allow this path.
+ */
+static TbBool LbScreenPresentWithLut(void)
+{
+    SDL_Surface* src = lbDrawSurface;
+    SDL_Surface* dst = lbScreenSurface;
+    const SDL_Palette* palette = src->format->palette;
+    if ((src->format->BytesPerPixel != 1) || (dst->format->BytesPerPixel != 4) ||
+        (src->w != dst->w) || (src->h != dst->h) || (palette == NULL))
+        return false;
+    // The palette may be changed directly on the surface, ie. by video player, so its version is checked
+    if ((lbPresentLutFormat != dst->format->format) || (lbPresentLutPalette != palette) ||
+        (lbPresentLutPaletteVersion != palette->version))
+    {
+        long ncolors = min(palette->ncolors, PALETTE_COLORS);
+        for (long i = 0; i < ncolors; i++)
+        {
+            lbPresentLut[i] = SDL_MapRGB(dst->format, palette->colors[i].r, palette->colors[i].g, palette->colors[i].b);
+        }
+        for (long i = ncolors; i < PALETTE_COLORS; i++)
+        {
+            lbPresentLut[i] = SDL_MapRGB(dst->format, 0, 0, 0);
+        }
+        lbPresentLutFormat = dst->format->format;
+        lbPresentLutPalette = palette;
+        lbPresentLutPaletteVersion = palette->version;
+    }
+    if (SDL_LockSurface(src) < 0)
+        return false;
+    if (SDL_LockSurface(dst) < 0)
+    {
+        SDL_UnlockSurface(src);
+        return false;
+    }
+    for (long h = 0; h < src->h; h++)
+    {
+        const unsigned char* sp = (const unsigned char *)src->pixels + h * src->pitch;
+        Uint32* dp = (Uint32 *)((unsigned char *)dst->pixels + h * dst->pitch);
+        long w = src->w;
+        for (; w >= 4; w -= 4)
+        {
+            dp[0] = lbPresentLut[sp[0]];
+            dp[1] = lbPresentLut[sp[1]];
+            dp[2] = lbPresentLut[sp[2]];
+            dp[3] = lbPresentLut[sp[3]];
+            sp += 4;
+            dp += 4;
+        }
+        for (; w > 0; w--)
+        {
+            *dp++ = lbPresentLut[*sp++];
+        }
+    }
+    SDL_UnlockSurface(dst);
+    SDL_UnlockSurface(src);
+    return true;
+}
+
 TbResult LbScreenSwap(void)
 {
     int blresult;
@@ -145,10 +213,16 @@ TbResult LbScreenSwap(void)
         // Update pointer to window surface on every frame
         // to avoid problems with alt tab
         lbScreenSurface = SDL_GetWindowSurface(lbWindow);
-        blresult = SDL_BlitSurface(lbDrawSurface, NULL, lbScreenSurface, NULL);
-        if (blresult < 0) {
-            ERRORLOG("Blit failed: %s",SDL_GetError());
+        if (lbScreenSurface == NULL) {
+            ERRORLOG("Cannot get window surface: %s",SDL_GetError());
             ret = Lb_FAIL;
+        } else
+        if (!LbScreenPresentWithLut()) {
+            blresult = SDL_BlitSurface(lbDrawSurface, NULL, lbScreenSurface, NULL);
+            if (blresult < 0) {
+                ERRORLOG("Blit failed: %s",SDL_GetError());
+                ret = Lb_FAIL;
+            }
         }
     }
     // Flip the image displayed on Screen Surface
@@ -533,6 +607,7 @@ TbResult LbScreenSetup(TbScreenMode mode, TbScreenCoord width, TbScreenCoord hei
         SDL_FreeSurface(lbDrawSurface);
     }
     lbDrawSurface = NULL;
+    lbPresentLutPalette = NULL;
     lbScreenInitialised = false;
 
     if (prevScreenSurf != NULL) {
@@ -780,6 +855,7 @@ TbResult LbScreenReset(TbBool exiting_application)
     //do not free screen surface, it is freed automatically on SDL_Quit or next call to set video mode
     lbHasSecondSurface = false;
     lbDrawSurface = NULL;
+    lbPresentLutPalette = NULL;
     lbScreenSurface = NULL;
     // Mark as not initialized
     lbScreenInitialised = false;
@@ -985,7 +985,7 @@ short parse_campaign_map_block(long lvnum, unsigned long lvoptions, char *buf, l
             if (get_conf_parameter_single(buf,&pos,len,word_buf,sizeof(word_buf)) > 0)
             {
                 k = atoi(word_buf);
-                if (k > 0)
+                if ((k > 0) && (k <= MAX_TILES_X))
                 {
                   lvinfo->mapsize_x = k;
                   n++;
@@ -994,7 +994,7 @@ short parse_campaign_map_block(long lvnum, unsigned long lvoptions, char *buf, l
             if (get_conf_parameter_single(buf,&pos,len,word_buf,sizeof(word_buf)) > 0)
             {
                 k = atoi(word_buf);
-                if (k > 0)
+                if ((k > 0) && (k <= MAX_TILES_Y))
                 {
                   lvinfo->mapsize_y = k;
                   n++;
@@ -733,6 +733,56 @@ TbBool creature_can_do_job_for_player(const struct Thing *creatng, PlayerNumber
     return true;
 }
 
+/**
+ * Jobs which the player's rooms allow to be taken, shared by all creatures of that player.
+ * Rebuilt when the player's rooms change capacity, and on every new turn.
+ */
+struct CreatureJobBoard {
+    CreatureJob open_jobs;
+    GameTurn turn;
+    unsigned long rooms_generation;
+    TbBool valid;
+};
+
+static struct CreatureJobBoard job_board[DUNGEONS_COUNT];
+
+/**
+ * Returns jobs for which the player has a room, with spare capacity if the job needs it.
+ * Jobs which don't need a room are always open. The creature-related checks
+ * of creature_can_do_job_for_player() still have to be made for the open jobs.
+ */
+static CreatureJob get_player_open_jobs(PlayerNumber plyr_idx)
+{
+    if ((plyr_idx < 0) || (plyr_idx >= DUNGEONS_COUNT))
+        return ~(CreatureJob)0;
+    struct CreatureJobBoard* board = &job_board[plyr_idx];
+    unsigned long generation = get_room_capacity_generation(plyr_idx);
+    if (board->valid && (board->turn == game.play_gameturn) && (board->rooms_generation == generation))
+        return board->open_jobs;
+    board->open_jobs = 0;
+    for (long n = 1; n < game.conf.crtr_conf.jobs_count; n++)
+    {
+        CreatureJob new_job = 1ULL << (n - 1);
+        RoomRole job_rrole = get_room_role_for_job(new_job);
+        if (job_rrole != RoRoF_None)
+        {
+            if (!player_has_room_of_role(plyr_idx, job_rrole))
+                continue;
+            if ((get_flags_for_job(new_job) & JoKF_NeedsCapacity) != 0)
+            {
+                if (room_is_invalid(find_room_of_role_with_spare_capacity(plyr_idx, job_rrole, 1)))
+                    continue;
+            }
+        }
+        board->open_jobs |= new_job;
+    }
+    // Finding a room may have recomputed capacity totals, but it doesn't change them
+    board->rooms_generation = get_room_capacity_generation(plyr_idx);
+    board->turn = game.play_gameturn;
+    board->valid = true;
+    return board->open_jobs;
+}
+
 TbBool send_creature_to_job_for_player(struct Thing *creatng, PlayerNumber plyr_idx, CreatureJob new_job)
 {
     SYNCDBG(6,"Starting for %s index %d owner %d and job %s",thing_model_name(creatng),(int)creatng->index,(int)creatng->owner,creature_job_code_name(new_job));
@@ -1123,12 +1173,14 @@ TbBool attempt_job_preference(struct Thing *creatng, long jobpref)
         return false;
     }
     long n = CREATURE_RANDOM(creatng, game.conf.crtr_conf.jobs_count);
+    // Jobs which can't be done for lack of room are skipped without checking the creature
+    CreatureJob open_jobs = get_player_open_jobs(creatng->owner);
     for (long i = 0; i < game.conf.crtr_conf.jobs_count; i++, n = (n + 1) % game.conf.crtr_conf.jobs_count)
     {
         if (n == 0)
             continue;
         CreatureJob new_job = 1ULL << (n - 1);
-        if ((jobpref & new_job) != 0)
+        if ((jobpref & open_jobs & new_job) != 0)
         {
             SYNCDBG(19,"Check job %s",creature_job_code_name(new_job));
             if (creature_can_do_job_for_player(creatng, creatng->owner, new_job, JobChk_None))
@@ -1158,6 +1210,7 @@ TbBool attempt_job_secondary_preference(struct Thing *creatng, long jobpref)
     unsigned long select_val = CREATURE_RANDOM(creatng, 512);
     unsigned long select_delta = 512 / i;
     unsigned long select_curr = select_delta;
+    CreatureJob open_jobs = get_player_open_jobs(creatng->owner);
     // For some reason, this is a bit different than attempt_job_preference().
     // Probably needs unification
     for (i=1; i < game.conf.crtr_conf.jobs_count; i++)
@@ -1171,7 +1224,7 @@ TbBool attempt_job_secondary_preference(struct Thing *creatng, long jobpref)
         {
             select_curr += select_delta;
         } else
-        if (creature_can_do_job_for_player(creatng, creatng->owner, new_job, JobChk_None))
+        if (((open_jobs & new_job) != 0) && creature_can_do_job_for_player(creatng, creatng->owner, new_job, JobChk_None))
         {
             if (send_creature_to_job_for_player(creatng, creatng->owner, new_job)) {
                 return true;
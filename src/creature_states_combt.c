@@ -49,6 +49,7 @@
 #include "gui_soundmsgs.h"
 #include "game_legacy.h"
 #include "engine_redraw.h"
+#include "api.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -786,6 +787,10 @@ TbBool battle_add(struct Thing *fighter, struct Thing *enmtng)
         ERRORLOG("No free battle structures");
         return false;
     }
+    if (creature_battle_get(battle_id)->fighters_num == 0) {
+        api_event_with_data("BATTLE_STARTED", fighter->owner, creature_code_name(fighter->model),
+            fighter->mappos.x.stl.num, fighter->mappos.y.stl.num);
+    }
     // Add both fighter and enemy to the new battle
     insert_thing_in_battle_list(fighter, battle_id);
     if (enmctrl->battle_id <= 0) {
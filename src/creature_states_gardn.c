@@ -95,9 +95,11 @@ void person_eat_food(struct Thing *creatng, struct Thing *foodtng, struct Room *
         int required_cap = get_required_room_capacity_for_object(RoRoF_FoodStorage, foodtng->model, 0);
         if (room->used_capacity >= required_cap) {
             room->used_capacity -= required_cap;
+            room_capacity_changed(room);
         } else {
             ERRORLOG("Trying to remove some food not in room");
             room->used_capacity = 0;
+            room_capacity_changed(room);
         }
         delete_thing_structure(foodtng, 0);
     }
@@ -236,6 +236,7 @@ CrStateRet creature_add_lair_to_room(struct Thing *creatng, struct Room *room)
     struct CreatureControl* cctrl = creature_control_get_from_thing(creatng);
     room->content_per_model[creatng->model]++;
     room->used_capacity += get_required_room_capacity_for_object(RoRoF_LairStorage, 0, creatng->model);
+    room_capacity_changed(room);
     if ((cctrl->lair_room_id > 0) && (cctrl->lairtng_idx > 0))
     {
         struct Room* origroom = room_get(cctrl->lair_room_id);
@@ -35,9 +35,20 @@
 #include "config_spritecolors.h"
 #include "config_players.h"
 #include "room_library.h"
+#include "creature_control.h"
+#include "creature_states.h"
+#include "dungeon_data.h"
+#include "thing_data.h"
+#include "thing_list.h"
 #include "game_legacy.h"
 #include "post_inc.h"
 
+/******************************************************************************/
+/** Stats for each player, plus one slot for player numbers out of range. */
+static struct DungeonCreatureStats dungeon_creature_stats[PLAYERS_COUNT+1];
+static TbBool dungeon_creature_stats_valid[PLAYERS_COUNT+1];
+/** While non-zero, the world is not modified and gathered stats may be reused. */
+static int dungeon_stats_hold_count = 0;
 /******************************************************************************/
 TbBool load_stats_files(void)
 {
@@ -329,4 +340,152 @@ long update_dungeons_scores(void)
     }
     return k;
 }
+
+static void sweep_creatures_list_for_stats(ThingIndex thing_idx, PlayerNumber plyr_idx, long *counts, long *lost)
+{
+    unsigned long k = 0;
+    long i = thing_idx;
+    while (i != 0)
+    {
+        struct Thing* thing = thing_get(i);
+        if (thing_is_invalid(thing))
+        {
+            ERRORLOG("Jump to invalid thing detected");
+            break;
+        }
+        struct CreatureControl* cctrl = creature_control_get_from_thing(thing);
+        i = cctrl->players_next_creature_idx;
+        // Per creature code
+        if ((thing->class_id == TCls_Creature) && (thing->owner == plyr_idx) &&
+            (thing->model >= 0) && (thing->model < CREATURE_TYPES_MAX))
+        {
+            counts[thing->model]++;
+            if (creature_is_kept_in_custody_by_enemy_or_dying(thing))
+                lost[thing->model]++;
+        }
+        // Per creature code ends
+        k++;
+        if (k > THINGS_COUNT)
+        {
+            ERRORLOG("Infinite loop detected when sweeping things list");
+            break;
+        }
+    }
+}
+
+/**
+ * Gives creature counts of given player.
+ * The lists are swept on every call, unless stats are held by dungeon_stats_hold().
+ */
+const struct DungeonCreatureStats *get_dungeon_creature_stats(PlayerNumber plyr_idx)
+{
+    int slot = ((plyr_idx >= 0) && (plyr_idx < PLAYERS_COUNT)) ? plyr_idx : PLAYERS_COUNT;
+    struct DungeonCreatureStats* stats = &dungeon_creature_stats[slot];
+    if ((dungeon_stats_hold_count > 0) && dungeon_creature_stats_valid[slot] && (stats->plyr_idx == plyr_idx))
+        return stats;
+    SYNCDBG(18,"Gathering stats for player %d",(int)plyr_idx);
+    memset(stats, 0, sizeof(struct DungeonCreatureStats));
+    stats->plyr_idx = plyr_idx;
+    struct Dungeon* dungeon = get_players_num_dungeon(plyr_idx);
+    if (dungeon_invalid(dungeon))
+    {
+        // Invalid dungeon - use list of creatures not associated to any dungeon
+        stats->has_dungeon = false;
+        sweep_creatures_list_for_stats(game.nodungeon_creatr_list_start, plyr_idx, stats->creatr_list_count, stats->creatr_list_lost);
+    } else
+    {
+        stats->has_dungeon = true;
+        sweep_creatures_list_for_stats(dungeon->creatr_list_start, plyr_idx, stats->creatr_list_count, stats->creatr_list_lost);
+        sweep_creatures_list_for_stats(dungeon->digger_list_start, plyr_idx, stats->digger_list_count, stats->digger_list_lost);
+    }
+    dungeon_creature_stats_valid[slot] = (dungeon_stats_hold_count > 0);
+    return stats;
+}
+
+static long sum_stats_of_model(const long *counts, PlayerNumber plyr_idx, ThingModel crmodel)
+{
+    if (!is_creature_model_wildcard(crmodel))
+    {
+        if ((crmodel < 0) || (crmodel >= CREATURE_TYPES_MAX))
+            return 0;
+        return counts[crmodel];
+    }
+    long count = 0;
+    for (ThingModel model = 0; model < CREATURE_TYPES_MAX; model++)
+    {
+        if ((counts[model] != 0) && creature_model_matches_model(model, plyr_idx, crmodel))
+            count += counts[model];
+    }
+    return count;
+}
+
+/**
+ * Counts creatures of given model, giving the same result as count_player_creatures_of_model().
+ */
+long count_stats_creatures_of_model(const struct DungeonCreatureStats *stats, ThingModel crmodel)
+{
+    PlayerNumber plyr_idx = stats->plyr_idx;
+    ThingModel match_model = (is_creature_model_wildcard(crmodel)) ? CREATURE_ANY : crmodel;
+    if (!stats->has_dungeon) {
+        return sum_stats_of_model(stats->creatr_list_count, plyr_idx, match_model);
+    }
+    TbBool is_spec_digger = (crmodel > 0) && creature_kind_is_for_dungeon_diggers_list(plyr_idx, crmodel);
+    long count = 0;
+    if (((crmodel > 0) && (!is_creature_model_wildcard(crmodel)) && !is_spec_digger) ||
+        (crmodel == CREATURE_ANY) || (crmodel == CREATURE_NOT_A_DIGGER))
+    {
+        count += sum_stats_of_model(stats->creatr_list_count, plyr_idx, match_model);
+    }
+    if (((crmodel > 0) && (!is_creature_model_wildcard(crmodel)) && is_spec_digger) ||
+        (crmodel == CREATURE_ANY) || (crmodel == CREATURE_DIGGER))
+    {
+        count += sum_stats_of_model(stats->digger_list_count, plyr_idx, match_model);
+    }
+    return count;
+}
+
+/**
+ * Counts creatures of given model kept in custody by enemy or dying. Gives the same result as
+ * count_player_list_creatures_of_model_matching_bool_filter() with creature_is_kept_in_custody_by_enemy_or_dying().
+ */
+long count_stats_lost_creatures_of_model(const struct DungeonCreatureStats *stats, ThingModel crmodel)
+{
+    PlayerNumber plyr_idx = stats->plyr_idx;
+    ThingModel match_model = (crmodel <= 0) ? CREATURE_ANY : crmodel;
+    if (!stats->has_dungeon) {
+        return sum_stats_of_model(stats->creatr_list_lost, plyr_idx, match_model);
+    }
+    TbBool is_spec_digger = (crmodel > 0) && creature_kind_is_for_dungeon_diggers_list(plyr_idx, crmodel);
+    long count = 0;
+    if (((crmodel > 0) && !is_spec_digger) || (crmodel == CREATURE_ANY) || (crmodel == CREATURE_NOT_A_DIGGER)) {
+        count += sum_stats_of_model(stats->creatr_list_lost, plyr_idx, match_model);
+    }
+    if (((crmodel > 0) && is_spec_digger) || (crmodel == CREATURE_ANY) || (crmodel == CREATURE_DIGGER)) {
+        count += sum_stats_of_model(stats->digger_list_lost, plyr_idx, match_model);
+    }
+    return count;
+}
+
+/**
+ * Allows reusing gathered creature stats until dungeon_stats_release().
+ * To be used only around code which doesn't change the world, like evaluation of script conditions.
+ */
+void dungeon_stats_hold(void)
+{
+    if (dungeon_stats_hold_count == 0)
+        memset(dungeon_creature_stats_valid, 0, sizeof(dungeon_creature_stats_valid));
+    dungeon_stats_hold_count++;
+}
+
+void dungeon_stats_release(void)
+{
+    if (dungeon_stats_hold_count <= 0)
+    {
+        ERRORLOG("Stats released without being held");
+        return;
+    }
+    dungeon_stats_hold_count--;
+    if (dungeon_stats_hold_count == 0)
+        memset(dungeon_creature_stats_valid, 0, sizeof(dungeon_creature_stats_valid));
+}
 /******************************************************************************/
@@ -22,6 +22,7 @@
 #include "bflib_basics.h"
 #include "globals.h"
 #include "player_data.h"
+#include "creature_control.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -99,9 +100,33 @@ struct LevelStats {
 
 #pragma pack()
 /******************************************************************************/
+/**
+ * Creature counts of one player, gathered in a single sweep of its lists.
+ * For player without dungeon, the list of creatures not associated to any dungeon is swept.
+ * Read by script conditions and by the API through them; scoring and panels use counters kept in Dungeon.
+ */
+struct DungeonCreatureStats {
+    PlayerNumber plyr_idx;
+    TbBool has_dungeon;
+    /** Player creatures on the creatures list, per model. */
+    long creatr_list_count[CREATURE_TYPES_MAX];
+    /** Player creatures on the diggers list, per model. */
+    long digger_list_count[CREATURE_TYPES_MAX];
+    /** Creatures from creatures list kept in custody by enemy or dying, per model. */
+    long creatr_list_lost[CREATURE_TYPES_MAX];
+    /** Creatures from diggers list kept in custody by enemy or dying, per model. */
+    long digger_list_lost[CREATURE_TYPES_MAX];
+};
+/******************************************************************************/
 long update_dungeons_scores(void);
 TbBool load_stats_files(void);
 
+const struct DungeonCreatureStats *get_dungeon_creature_stats(PlayerNumber plyr_idx);
+long count_stats_creatures_of_model(const struct DungeonCreatureStats *stats, ThingModel crmodel);
+long count_stats_lost_creatures_of_model(const struct DungeonCreatureStats *stats, ThingModel crmodel);
+void dungeon_stats_hold(void);
+void dungeon_stats_release(void);
+
 /******************************************************************************/
 #ifdef __cplusplus
 }
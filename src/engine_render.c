@@ -56,10 +56,12 @@
 #include "kjm_input.h"
 #include "player_instances.h"
 #include "sprites.h"
+#include "thing_particles.h"
 #include "thing_stats.h"
 #include "thing_traps.h"
 #include "vidfade.h"
 #include "vidmode.h"
+#include "map_arena.h"
 
 #include "post_inc.h"
 
@@ -407,6 +409,9 @@ unsigned char *getpoly;
 unsigned char poly_pool[POLY_POOL_SIZE];
 unsigned char *poly_pool_end;
 struct BasicQ *buckets[BUCKETS_COUNT];
+struct DrawListStats drawlist_stats;
+/** End of the poly pool part which may contain data; the rest is kept zeroed. */
+static unsigned char *poly_pool_dirty_end = &poly_pool[POLY_POOL_SIZE];
 long cells_away;
 long max_i_can_see;
 const int MAX_I_CAN_SEE_OVERHEAD = (MINMAX_LENGTH/2)-2;
@@ -497,6 +502,7 @@ static const char splittypes[64] = {
 #endif
 /******************************************************************************/
 static void do_map_who(short tnglist_idx);
+static void do_map_who_for_particles(MapSubtlCoord cam_stl_x, MapSubtlCoord cam_stl_y);
 static void (*render_sprite_debug_fn) (struct Thing*, long scrpos_x, long scrpos_y) = NULL;
 static int render_sprite_debug_level = 0;
 static void draw_keepsprite_unscaled_in_buffer(unsigned short kspr_n, short angle, unsigned char current_frame, unsigned char *outbuf);
@@ -765,6 +771,42 @@ static TbBool is_free_space_in_poly_pool(int nitems)
     return (getpoly+(nitems*sizeof(struct BucketKindSlabSelector)) <= poly_pool_end);
 }
 
+/**
+ * Marks whole poly pool as containing data; to be used when the pool memory was borrowed for something else.
+ */
+void poly_pool_mark_dirty(void)
+{
+    poly_pool_dirty_end = &poly_pool[POLY_POOL_SIZE];
+}
+
+/**
+ * Empties the draw list, updating pool usage statistics of the list being dropped.
+ * @param zero_pool If true, the pool is zeroed; only the part used since last zeroing is cleared.
+ */
+static void reset_drawlist(TbBool zero_pool)
+{
+    if (getpoly != NULL)
+    {
+        if (getpoly > poly_pool_dirty_end)
+            poly_pool_dirty_end = getpoly;
+        drawlist_stats.pool_used = getpoly - poly_pool;
+        if (drawlist_stats.pool_used > drawlist_stats.pool_high_water)
+        {
+            drawlist_stats.pool_high_water = drawlist_stats.pool_used;
+            SYNCDBG(7,"Poly pool high-water mark is now %lu bytes",(unsigned long)drawlist_stats.pool_high_water);
+        }
+        if (getpoly >= poly_pool_end)
+            drawlist_stats.pool_overflows++;
+    }
+    getpoly = poly_pool;
+    memset(buckets, 0, sizeof(buckets));
+    if (zero_pool)
+    {
+        memset(poly_pool, 0, poly_pool_dirty_end - poly_pool);
+        poly_pool_dirty_end = poly_pool;
+    }
+}
+
 static void rotpers_parallel_3(struct EngineCoord *epos, struct M33 *matx, long zoom)
 {
     long factor_w;
@@ -953,7 +995,7 @@ struct WibbleTable *get_wibble_from_table(struct Camera *cam, long table_index,
 
 static struct BasicQ *get_bucket_item(int min_cor_z, enum QKinds kind, size_t size)
 {
-    if (getpoly >= poly_pool_end)
+    if (getpoly + size > poly_pool_end)
     {
         return NULL;
     }
@@ -4027,7 +4069,7 @@ unsigned short engine_remap_texture_blocks(long stl_x, long stl_y, unsigned shor
 {
     long slb_x = subtile_slab(stl_x);
     long slb_y = subtile_slab(stl_y);
-    return tex_id + (gameadd.slab_ext_data[get_slab_number(slb_x,slb_y)] & 0xF) * TEXTURE_BLOCKS_COUNT;
+    return tex_id + (map_arena.slab_ext_data[get_slab_number(slb_x,slb_y)] & 0xF) * TEXTURE_BLOCKS_COUNT;
 }
 
 static void do_a_plane_of_engine_columns_perspective(long stl_x, long stl_y, long plane_start, long plane_end)
@@ -6558,10 +6600,15 @@ static void display_drawlist(void) // Draws isometric and 1st person view. Not f
     thing_pointed_at = 0;
 
     // The bucket list is the final step in drawing something to the screen. Visuals are added to the bucket list in previous functions.
+    drawlist_stats.buckets_used = 0;
+    drawlist_stats.items_count = 0;
     for (bucket_num = BUCKETS_COUNT-1; bucket_num > 0; bucket_num--)
     {
+        if (buckets[bucket_num] != NULL)
+            drawlist_stats.buckets_used++;
         for (item.b = buckets[bucket_num]; item.b != NULL; item.b = item.b->next)
         {
+            drawlist_stats.items_count++;
             //JUSTLOG("%d",(int)item.b->kind);
             switch ( item.b->kind )
             {
@@ -6846,9 +6893,7 @@ void draw_view(struct Camera *cam, unsigned char a2)
     long y = interpolated_cam_mappos_y;
     long z = interpolated_cam_mappos_z;
 
-    getpoly = poly_pool;
-    memset(buckets, 0, sizeof(buckets));
-    memset(poly_pool, 0, sizeof(poly_pool));
+    reset_drawlist(true);
     if (map_volume_box.visible)
     {
         poly_pool_end_reserve(14);
@@ -6900,6 +6945,7 @@ void draw_view(struct Camera *cam, unsigned char a2)
     fiddle_gamut(xcell, ycell + (cells_away+1));
 
     draw_view_map_plane(cam, aposc, bposc, xcell, ycell);
+    do_map_who_for_particles(x >> 8, y >> 8);
 
     if ( (map_volume_box.visible) && (!game_is_busy_doing_gui()) )
     {
@@ -6914,8 +6960,7 @@ void draw_view(struct Camera *cam, unsigned char a2)
 
 static void clear_fast_bucket_list(void)
 {
-    getpoly = poly_pool;
-    memset(buckets, 0, sizeof(buckets));
+    reset_drawlist(false);
 }
 
 static void draw_texturedquad_block(struct BucketKindTexturedQuad *txquad)
@@ -8899,6 +8944,38 @@ static void do_map_who(short tnglist_idx)
     }
 }
 
+/**
+ * Adds effect particles around the camera to the draw list.
+ * Particles are not in the map things lists, so they're added in one batch after the map.
+ */
+static void do_map_who_for_particles(MapSubtlCoord cam_stl_x, MapSubtlCoord cam_stl_y)
+{
+    static struct Thing *particle_things[EFFECT_PARTICLES_COUNT];
+    long count = effect_particles_gather_visible(particle_things, EFFECT_PARTICLES_COUNT, my_player_number,
+        cam_stl_x - cells_away - 1, cam_stl_y - cells_away - 1, cam_stl_x + cells_away + 1, cam_stl_y + cells_away + 1);
+    for (long i = 0; i < count; i++)
+    {
+        struct Thing *thing = particle_things[i];
+        struct EngineCoord ecor;
+        ecor.field_8 = 0;
+        ecor.x = (thing->interp_mappos.x.val - map_x_pos);
+        ecor.z = (map_y_pos - thing->interp_mappos.y.val);
+        ecor.y = (thing->interp_mappos.z.val - map_z_pos);
+        rotpers(&ecor, &camera_matrix);
+        // Skip particles behind the camera in 1st person view
+        if ((ecor.field_8 & 0x0100) != 0)
+            continue;
+        if (getpoly >= poly_pool_end)
+            break;
+        int bckt_idx;
+        if ( lens_mode )
+          bckt_idx = (ecor.z - 64) / 16;
+        else
+          bckt_idx = (ecor.z - 64) / 16 - 6;
+        add_thing_sprite_to_polypool(thing, ecor.view_width, ecor.view_height, ecor.z, bckt_idx);
+    }
+}
+
 static void draw_frontview_thing_on_element(struct Thing *thing, struct Map *map, struct Camera *cam)
 {
     // The draw_frontview_thing_on_element() function is the FrontView equivalent of do_map_who_for_thing()
@@ -8977,6 +9054,27 @@ static void draw_frontview_thing_on_element(struct Thing *thing, struct Map *map
     thing->last_turn_drawn = game.play_gameturn;
 }
 
+/**
+ * Adds effect particles to the draw list in FrontView; equivalent of do_map_who_for_particles().
+ */
+static void draw_frontview_particles(struct Camera *cam)
+{
+    static struct Thing *particle_things[EFFECT_PARTICLES_COUNT];
+    long count = effect_particles_gather_visible(particle_things, EFFECT_PARTICLES_COUNT, my_player_number,
+        0, 0, gameadd.map_subtiles_x, gameadd.map_subtiles_y);
+    for (long i = 0; i < count; i++)
+    {
+        struct Thing *thing = particle_things[i];
+        long cx;
+        long cy;
+        long cz;
+        if (!is_free_space_in_poly_pool(1))
+            break;
+        convert_world_coord_to_front_view_screen_coord(&thing->interp_mappos,cam,&cx,&cy,&cz);
+        add_thing_sprite_to_polypool(thing, cx, cy, cy, cz-3);
+    }
+}
+
 static void draw_frontview_things_on_element(struct Map *mapblk, struct Camera *cam)
 {
     struct Thing *thing;
@@ -9144,6 +9242,7 @@ void draw_frontview_engine(struct Camera *cam)
         stl_x += x_step2[qdrant];
         stl_y += y_step2[qdrant];
     }
+    draw_frontview_particles(cam);
 
     display_fast_drawlist(cam);
     LbScreenLoadGraphicsWindow(&grwnd);
@@ -68,6 +68,15 @@ struct MapVolumeBox { // sizeof = 24
   long floor_height_z;
 };
 
+/** Draw list usage, for tuning the poly pool and buckets. */
+struct DrawListStats {
+    unsigned long items_count; //!< Items drawn in the last frame
+    unsigned long buckets_used; //!< Non-empty buckets in the last frame
+    size_t pool_used; //!< Poly pool bytes used by the last draw list
+    size_t pool_high_water; //!< Highest poly pool usage so far
+    unsigned long pool_overflows; //!< Draw lists which didn't fit in the pool
+};
+
 /******************************************************************************/
 // Stripey Line Color Arrays
 
@@ -94,6 +103,7 @@ struct stripey_line {
 
 extern struct stripey_line colored_stripey_lines[];
 extern unsigned char poly_pool[POLY_POOL_SIZE];
+extern struct DrawListStats drawlist_stats;
 extern unsigned char *poly_pool_end;
 extern long cells_away;
 extern float hud_scale;
@@ -145,6 +155,7 @@ void draw_map_volume_box(long cor1_x, long cor1_y, long cor2_x, long cor2_y, lon
 void update_engine_settings(struct PlayerInfo *player);
 void draw_view(struct Camera *cam, unsigned char a2);
 void draw_frontview_engine(struct Camera *cam);
+void poly_pool_mark_dirty(void);
 /******************************************************************************/
 #ifdef __cplusplus
 }
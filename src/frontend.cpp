@@ -899,18 +899,26 @@ TbResult frontend_load_data(void)
     // TODO: There is no "frontend_unload_data", find a better spot for this
     free_spritesheet(&frontend_sprite);
     ret = Lb_SUCCESS;
-    frontend_background = (unsigned char *)game.map;
 #ifdef SPRITE_FORMAT_V2
     fname = prepare_file_fmtpath(FGrp_LoData,"front-%d.raw",64);
 #else
     fname = prepare_file_path(FGrp_LoData,"front.raw");
 #endif
-    len = LbFileLoadAt(fname, frontend_background);
+    // Map arrays are sized for the level now, so the background needs its own buffer
+    len = LbFileLengthRnc(fname);
     if (len < 307200) {
-        ret = Lb_FAIL;
+        len = 307200;
+    }
+    unsigned char* buf = (unsigned char *)realloc(frontend_background, len);
+    if (buf != NULL) {
+        frontend_background = buf;
+        len = LbFileLoadAt(fname, frontend_background);
+    } else {
+        ERRORLOG("Cannot allocate %ld bytes for frontend background",len);
+        len = -1;
     }
-    if (len > sizeof(game.map)) {
-        WARNLOG("Reused memory area exceeded for frontend background.");
+    if (len < 307200) {
+        ret = Lb_FAIL;
     }
     char dat_fname[2048];
     char tab_fname[2048];
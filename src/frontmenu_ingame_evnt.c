@@ -805,6 +805,9 @@ void draw_frametime()
             case Frametime_Sleep:
                 text = buf_sprintf("Sleep: %f ms", display_value);
                 break;
+            case Frametime_Present:
+                text = buf_sprintf("Present: %f ms", display_value);
+                break;
         }
         LbTextDrawResized(0, (28+i)*tx_units_per_px, tx_units_per_px, text);
     }
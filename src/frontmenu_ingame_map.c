@@ -29,6 +29,7 @@
 #include "bflib_guibtns.h"
 #include "bflib_mouse.h"
 #include "bflib_planar.h"
+#include "bflib_coroutine.h"
 
 #include "frontend.h"
 #include "front_input.h"
@@ -47,6 +48,7 @@
 #include "vidfade.h"
 #include "player_instances.h"
 #include "engine_render.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 /******************************************************************************/
@@ -103,7 +105,6 @@ static unsigned char MapBackColours[256];
 static unsigned char PanelColours[16*PnC_End];
 static long PrevRoomHighlight;
 static long PrevDoorHighlight;
-static unsigned short PanelMap[MAX_SUBTILES_X*MAX_SUBTILES_Y];
 static struct InterpMinimap interp_minimap;
 
 long clicked_on_small_map;
@@ -804,7 +805,7 @@ void panel_map_update_subtile(PlayerNumber plyr_idx, MapSubtlCoord stl_x, MapSub
         }
 
     }
-    ushort *mapptr = &PanelMap[stl_num];
+    ushort *mapptr = &map_arena.panel_map[stl_num];
     *mapptr = col;
 }
 
@@ -813,6 +814,8 @@ void panel_map_update(long x, long y, long w, long h)
     SYNCDBG(17,"Starting for rect (%ld,%ld) at (%ld,%ld)",w,h,x,y);
     MapSubtlCoord stl_x;
     MapSubtlCoord stl_y;
+    if (map_arena.data == NULL)
+        return;
     for (stl_y = y; stl_y < y + h; stl_y++)
     {
         if (stl_y > gameadd.map_subtiles_y)
@@ -829,6 +832,34 @@ void panel_map_update(long x, long y, long w, long h)
     }
 }
 
+#define PANEL_MAP_ROWS_PER_STEP 8
+
+static CoroutineLoopState panel_map_update_all_step(CoroutineTask *task)
+{
+    panel_map_update(0, task->progress, gameadd.map_subtiles_x+1, PANEL_MAP_ROWS_PER_STEP);
+    task->progress += PANEL_MAP_ROWS_PER_STEP;
+    if (task->progress > gameadd.map_subtiles_y)
+        return CLS_CONTINUE;
+    return CLS_REPEAT;
+}
+
+/**
+ * Updates the whole panel map over the next few frames, instead of doing it at once.
+ * If the update is already in progress, it is started again from the top.
+ */
+void panel_map_update_all_sliced(void)
+{
+    CoroutineTask *task = coroutine_task_find(&coroutine_frame_tasks, panel_map_update_all_step, NULL);
+    if (task == NULL) {
+        task = coroutine_task_start(&coroutine_frame_tasks, "PanelMapUpdate", panel_map_update_all_step, NULL, 2);
+    }
+    if (task == NULL) {
+        panel_map_update(0, 0, gameadd.map_subtiles_x+1, gameadd.map_subtiles_y+1);
+        return;
+    }
+    task->progress = 0;
+}
+
 static void do_map_rotate_stuff(long relpos_x, long relpos_y, long *stl_x, long *stl_y, long zoom)
 {
     const struct PlayerInfo *player = get_my_player();
@@ -1339,7 +1370,7 @@ void panel_map_draw_slabs(long x, long y, long units_per_px, long zoom)
             pnmap_idx = ((precor_x>>16)) + (((precor_y>>16)) * (gameadd.map_subtiles_x + 1) );
             int pncol_idx;
             //TODO reenable background
-            pncol_idx = PanelMap[pnmap_idx] + (*bkgnd * PnC_End);
+            pncol_idx = map_arena.panel_map[pnmap_idx] + (*bkgnd * PnC_End);
             *out = PanelColours[pncol_idx];
             precor_x += shift_y;
             precor_y -= shift_x;
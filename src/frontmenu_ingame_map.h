@@ -35,6 +35,7 @@ extern unsigned char grabbed_small_map;
 extern long clicked_on_small_map;
 /******************************************************************************/
 void panel_map_update(long x, long y, long w, long h);
+void panel_map_update_all_sliced(void);
 void panel_map_draw_slabs(long x, long y, long units_per_px, long zoom);
 void panel_map_draw_overlay_things(long units_per_px, long zoom, long basic_zoom);
 
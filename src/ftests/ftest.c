@@ -1,4 +1,5 @@
 #include "ftest.h"
+#include "ftest_perf.h"
 
 #ifdef FUNCTESTING
 
@@ -10,7 +11,7 @@
 #include "../slab_data.h"
 #include "../room_util.h"
 #include "../player_instances.h"
-#includw "../gui_msgs.h"
+#include "../gui_msgs.h"
 
 #include "../post_inc.h"
 
@@ -184,7 +185,8 @@ TbBool ftest_fill_teststorun_by_name(char* const name)
     for(unsigned long i = 0; i < FTEST_MAX_TESTS; ++i) { vars->tests_to_run[i] = NULL; }
 
     TbBool too_many_tests = false;
-    for(unsigned short test_list_id = 0; test_list_id < 2; ++test_list_id)
+    TbBool performance_mode = flag_is_set(start_params.functest_flags, FTF_PerformanceMode);
+    for(unsigned short test_list_id = 0; test_list_id < 3; ++test_list_id)
     {
         struct FTestConfig* current_test_list = NULL;
 
@@ -192,19 +194,31 @@ TbBool ftest_fill_teststorun_by_name(char* const name)
         {
             case 0:
             {
-                current_test_list = conf->tests_list;
+                if(!performance_mode)
+                {
+                    current_test_list = conf->tests_list;
+                }
                 break;
             }
 
             case 1:
             {
-                if(flag_is_set(start_params.functest_flags, FTF_IncludeLongTests))
+                if(!performance_mode && flag_is_set(start_params.functest_flags, FTF_IncludeLongTests))
                 {
                     current_test_list = conf->long_running_tests_list;
                 }
                 break;
             }
 
+            case 2:
+            {
+                if(performance_mode)
+                {
+                    current_test_list = conf->performance_tests_list;
+                }
+                break;
+            }
+
             default:
                 break;
         }
@@ -450,6 +464,10 @@ FTestFrameworkState ftest_update(FTestFrameworkState* const out_prev_state)
             if(vars->pending_init->init_func)
             {
                 vars->pending_init->init_func();
+                if(flag_is_set(start_params.functest_flags, FTF_PerformanceMode))
+                {
+                    ftest_perf_start(vars->pending_init);
+                }
                 vars->pending_init = NULL;
             }
             else
@@ -465,6 +483,8 @@ FTestFrameworkState ftest_update(FTestFrameworkState* const out_prev_state)
             FTEST_FRAMEWORK_ABORT("Missing test config... this shouldn't happen.");
         }
 
+        ftest_perf_sample();
+
         const unsigned long ftest_actions_length = sizeof(vars->actions_func_list) / sizeof(vars->actions_func_list[0]);
         if(vars->current_action < ftest_actions_length)
         {
@@ -516,6 +536,12 @@ FTestFrameworkState ftest_update(FTestFrameworkState* const out_prev_state)
             }
         }
 
+        if(vars->current_action >= ftest_actions_length)
+        {
+            // compare with the baseline before deciding whether the test passed
+            ftest_perf_finish(current_test_config, NULL);
+        }
+
         TbBool test_failed = flag_is_set(start_params.functest_flags, FTF_TestFailed);
         TbBool is_done_actions = vars->current_action >= ftest_actions_length || test_failed; // actions completed, OR test failed
         if(is_done_actions)
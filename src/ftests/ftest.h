@@ -82,6 +82,26 @@ extern const char* FTestFrameworkState_Strings[];
 
 const char* ftest_get_frameworkstate_name(FTestFrameworkState state);
 
+/**
+ * @brief Expected performance of a test, checked when running with -ftestsperf (optional)
+ * Values set to 0 are not checked. Turn times are machine-dependent, so they are allowed to be worse by tolerance_percent.
+ */
+/**
+ * @brief Baseline value of a performance test which wasn't recorded yet, such values aren't checked
+ * 
+ */
+#define FTEST_PERF_NOT_RECORDED (-1)
+
+struct FTestPerfBaseline
+{
+    float turn_p50_ms;
+    float turn_p95_ms;
+    float turn_p99_ms;
+    long things_peak;
+    long particles_peak;
+    unsigned short tolerance_percent;
+};
+
 /**
  * @brief Configuration object for a functional test
  * 
@@ -129,12 +149,19 @@ struct FTestConfig {
      * 
      */
     unsigned short repeat_n_times;
+
+    /**
+     * @brief Expected results for tests inside performance_tests_list (optional)
+     * 
+     */
+    struct FTestPerfBaseline perf_baseline;
 };
 
 struct ftest_onlyappendtests__config
 {
     struct FTestConfig tests_list[FTEST_MAX_TESTS];
     struct FTestConfig long_running_tests_list[FTEST_MAX_TESTS];
+    struct FTestConfig performance_tests_list[FTEST_MAX_TESTS];
 };
 extern struct ftest_onlyappendtests__config ftest_onlyappendtests__conf;
 
@@ -16,6 +16,8 @@
 #include "tests/ftest_bug_invisible_units_cant_select.h"
 #include "tests/ftest_bug_pathing_stair_treasury.h"
 #include "tests/ftest_bug_ai_bridge.h"
+#include "tests/ftest_perf_scenarios.h"
+#include "tests/ftest_sim_context.h"
 // append your test include here, eg: #include "tests/ftest_your_test_header.h"
 
 #include "../post_inc.h"
@@ -39,6 +41,7 @@ struct ftest_onlyappendtests__config ftest_onlyappendtests__conf = {
          { .test_name="bug_imp_goldseam_dig",               .init_func=ftest_bug_imp_goldseam_dig_init,             .level_file="keeporig", .level=1,  .frame_skip=8 },
          { .test_name="bug_pathing_stair_treasury",         .init_func=ftest_bug_pathing_stair_treasury_init,       .level_file="keeporig", .level=1,  .frame_skip=8 },
          { .test_name="bug_invisible_units_cant_select",    .init_func=ftest_bug_invisible_units_cant_select_init,  .level_file="keeporig", .level=1,  .frame_skip=0 },
+         { .test_name="sim_context_roundtrip",              .init_func=ftest_sim_context_roundtrip_init,            .level_file="keeporig", .level=1,  .frame_skip=8, .seed=1 },
 
          // WIP TEST { .test_name="bug_pathing_pillar_circling",        .init_func=ftest_bug_pathing_pillar_circling_init,      .level_file="keeporig", .level=1, .frame_skip=0 },
          // WIP TEST { .test_name="bug_invisible_units_cant_select",    .init_func=ftest_bug_invisible_units_cant_select_init,  .level_file="lostlvls", .level=103, .frame_skip=0 },
@@ -48,6 +51,17 @@ struct ftest_onlyappendtests__config ftest_onlyappendtests__conf = {
     // place long-running tests in this list, to include them use the -includelongtests flag
     .long_running_tests_list = {
         { .test_name="bug_ai_bridge",                      .init_func=ftest_bug_ai_bridge_init,                    .level_file="keeporig", .level=15, .frame_skip=128, .seed=1, .repeat_n_times=100 },
+    },
+
+    // place performance tests in this list, they are run with the -ftestsperf flag (instead of the lists above)
+    // baseline values come from the "performance:" log line of a run on the reference machine, values set to FTEST_PERF_NOT_RECORDED aren't checked until they are recorded
+    .performance_tests_list = {
+        { .test_name="perf_big_battle",                    .init_func=ftest_perf_big_battle_init,                  .level_file="keeporig", .level=1,  .frame_skip=128, .seed=1,
+            .perf_baseline={ .turn_p50_ms=FTEST_PERF_NOT_RECORDED, .turn_p95_ms=FTEST_PERF_NOT_RECORDED, .turn_p99_ms=FTEST_PERF_NOT_RECORDED, .things_peak=FTEST_PERF_NOT_RECORDED, .particles_peak=FTEST_PERF_NOT_RECORDED, .tolerance_percent=25 } },
+        { .test_name="perf_mass_digging",                  .init_func=ftest_perf_mass_digging_init,                .level_file="keeporig", .level=1,  .frame_skip=128, .seed=1,
+            .perf_baseline={ .turn_p50_ms=FTEST_PERF_NOT_RECORDED, .turn_p95_ms=FTEST_PERF_NOT_RECORDED, .turn_p99_ms=FTEST_PERF_NOT_RECORDED, .things_peak=FTEST_PERF_NOT_RECORDED, .particles_peak=FTEST_PERF_NOT_RECORDED, .tolerance_percent=25 } },
+        { .test_name="perf_many_ai",                       .init_func=ftest_perf_many_ai_init,                     .level_file="keeporig", .level=15, .frame_skip=128, .seed=1,
+            .perf_baseline={ .turn_p50_ms=FTEST_PERF_NOT_RECORDED, .turn_p95_ms=FTEST_PERF_NOT_RECORDED, .turn_p99_ms=FTEST_PERF_NOT_RECORDED, .things_peak=FTEST_PERF_NOT_RECORDED, .particles_peak=FTEST_PERF_NOT_RECORDED, .tolerance_percent=25 } },
     }
 };
 
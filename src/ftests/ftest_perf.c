@@ -0,0 +1,167 @@
+#include "ftest_perf.h"
+
+#ifdef FUNCTESTING
+
+#include "../pre_inc.h"
+
+#include "../bflib_datetm.h"
+#include "../game_legacy.h"
+#include "../keeperfx.hpp"
+#include "../thing_particles.h"
+
+#include "../post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ftest_perf__variables
+{
+    TbBool recording;
+    TbBool skip_next_sample;
+    unsigned long turns;
+    unsigned long things_peak;
+    unsigned long particles_peak;
+    float turn_times[FTEST_PERF_MAX_TURNS];
+};
+static struct ftest_perf__variables ftest_perf__vars;
+
+static int ftest_perf_compare_times(const void* a, const void* b)
+{
+    float time_a = *(const float*)a;
+    float time_b = *(const float*)b;
+    return (time_a > time_b) - (time_a < time_b);
+}
+
+/**
+ * @brief Returns the given percentile of sorted turn times, using nearest-rank method
+ * 
+ */
+static float ftest_perf_percentile(const float* sorted_times, unsigned long count, unsigned short percentile)
+{
+    if(count == 0)
+    {
+        return 0.0f;
+    }
+    unsigned long rank = (count * percentile + 99) / 100;
+    if(rank < 1)
+    {
+        rank = 1;
+    }
+    return sorted_times[rank - 1];
+}
+
+/**
+ * @brief Checks a measured value against the baseline value, a baseline which wasn't recorded is skipped
+ * 
+ */
+static TbBool ftest_perf_check(const char* test_name, const char* what, double measured, double baseline, unsigned short tolerance_percent)
+{
+    if(baseline < 0)
+    {
+        FTESTLOG("Test %s: no baseline recorded for %s, copy it from the performance line above", test_name, what);
+        return true;
+    }
+    double limit = baseline * (100 + tolerance_percent) / 100.0;
+    if(measured > limit)
+    {
+        FTEST_FAIL_TEST("Test %s: %s is %.3f, baseline %.3f allows up to %.3f", test_name, what, measured, baseline, limit);
+        return false;
+    }
+    return true;
+}
+
+void ftest_perf_start(const struct FTestConfig* const test_config)
+{
+    struct ftest_perf__variables* const vars = &ftest_perf__vars;
+
+    FTESTLOG("Recording performance of test %s", test_config->test_name);
+    vars->recording = true;
+    // the turn on which the test init function was called isn't measured
+    vars->skip_next_sample = true;
+    vars->turns = 0;
+    vars->things_peak = 0;
+    vars->particles_peak = 0;
+}
+
+void ftest_perf_sample()
+{
+    struct ftest_perf__variables* const vars = &ftest_perf__vars;
+
+    if(!vars->recording)
+    {
+        return;
+    }
+
+    if(game.free_things_start_index > vars->things_peak)
+    {
+        vars->things_peak = game.free_things_start_index;
+    }
+    if((unsigned long)effect_particles.count > vars->particles_peak)
+    {
+        vars->particles_peak = effect_particles.count;
+    }
+
+    if(vars->skip_next_sample)
+    {
+        vars->skip_next_sample = false;
+        return;
+    }
+    if(vars->turns < FTEST_PERF_MAX_TURNS)
+    {
+        // logic time of the previous turn, the current one is being measured right now
+        vars->turn_times[vars->turns++] = frametime_measurements.frametime_current[Frametime_Logic];
+    }
+}
+
+TbBool ftest_perf_finish(const struct FTestConfig* const test_config, struct FTestPerfResults* const out_results)
+{
+    struct ftest_perf__variables* const vars = &ftest_perf__vars;
+
+    if(!vars->recording)
+    {
+        return true;
+    }
+    vars->recording = false;
+
+    struct FTestPerfResults results;
+    qsort(vars->turn_times, vars->turns, sizeof(vars->turn_times[0]), ftest_perf_compare_times);
+    results.turns = vars->turns;
+    results.turn_p50_ms = ftest_perf_percentile(vars->turn_times, vars->turns, 50);
+    results.turn_p95_ms = ftest_perf_percentile(vars->turn_times, vars->turns, 95);
+    results.turn_p99_ms = ftest_perf_percentile(vars->turn_times, vars->turns, 99);
+    results.turn_max_ms = ftest_perf_percentile(vars->turn_times, vars->turns, 100);
+    results.things_peak = vars->things_peak;
+    results.particles_peak = vars->particles_peak;
+
+    // this line is meant to be copied into the baseline inside ftest_list.c
+    FTESTLOG("Test %s performance: turns=%lu .turn_p50_ms=%.3f, .turn_p95_ms=%.3f, .turn_p99_ms=%.3f, .things_peak=%lu, .particles_peak=%lu (max turn %.3f ms)",
+        test_config->test_name, results.turns, results.turn_p50_ms, results.turn_p95_ms, results.turn_p99_ms,
+        results.things_peak, results.particles_peak, results.turn_max_ms);
+
+    const struct FTestPerfBaseline* const baseline = &test_config->perf_baseline;
+    unsigned short tolerance = baseline->tolerance_percent;
+    if(tolerance == 0)
+    {
+        tolerance = FTEST_PERF_DEFAULT_TOLERANCE_PERCENT;
+    }
+    // the pools usage doesn't depend on the machine, so it is compared without tolerance
+    TbBool result = true;
+    result &= ftest_perf_check(test_config->test_name, "turn time p50", results.turn_p50_ms, baseline->turn_p50_ms, tolerance);
+    result &= ftest_perf_check(test_config->test_name, "turn time p95", results.turn_p95_ms, baseline->turn_p95_ms, tolerance);
+    result &= ftest_perf_check(test_config->test_name, "turn time p99", results.turn_p99_ms, baseline->turn_p99_ms, tolerance);
+    result &= ftest_perf_check(test_config->test_name, "things peak", results.things_peak, baseline->things_peak, 0);
+    result &= ftest_perf_check(test_config->test_name, "particles peak", results.particles_peak, baseline->particles_peak, 0);
+
+    if(out_results != NULL)
+    {
+        (*out_results) = results;
+    }
+    return result;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FUNCTESTING
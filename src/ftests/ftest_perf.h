@@ -0,0 +1,65 @@
+/**
+ * @file ftest_perf.h
+ * @brief Performance mode of the Functional Test Framework
+ * Records game turn times and peak usage of the things/particles pools while a test runs,
+ * and compares them against the baseline given for the test inside ftest_list.c
+ * @version 0.1
+ * @date 2026-10-19
+ * 
+ * @copyright Copyright (c) 2026
+ */
+
+#pragma once
+
+#include "../globals.h"
+
+#ifdef FUNCTESTING
+
+#include "ftest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FTEST_PERF_MAX_TURNS 65536
+#define FTEST_PERF_DEFAULT_TOLERANCE_PERCENT 25
+
+/**
+ * @brief Results of a single performance test run
+ * 
+ */
+struct FTestPerfResults
+{
+    unsigned long turns;
+    float turn_p50_ms;
+    float turn_p95_ms;
+    float turn_p99_ms;
+    float turn_max_ms;
+    unsigned long things_peak;
+    unsigned long particles_peak;
+};
+
+/**
+ * @brief Starts recording for the given test, called once the test init function is done
+ * 
+ */
+void ftest_perf_start(const struct FTestConfig* const test_config);
+
+/**
+ * @brief Records the previous game turn, called once per game turn while the test runs
+ * 
+ */
+void ftest_perf_sample();
+
+/**
+ * @brief Stops recording, logs results and fails the test if they're worse than the baseline
+ * 
+ * @return TbBool true if the results are within the baseline tolerance
+ */
+TbBool ftest_perf_finish(const struct FTestConfig* const test_config, struct FTestPerfResults* const out_results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FUNCTESTING
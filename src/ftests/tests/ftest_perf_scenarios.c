@@ -0,0 +1,206 @@
+#include "ftest_perf_scenarios.h"
+
+#ifdef FUNCTESTING
+
+#include "../../pre_inc.h"
+
+#include "../ftest.h"
+#include "../ftest_util.h"
+
+#include "../../game_legacy.h"
+#include "../../keeperfx.hpp"
+#include "../../player_instances.h"
+#include "../../thing_creature.h"
+#include "../../dungeon_data.h"
+#include "../../map_data.h"
+#include "../../gui_msgs.h"
+#include "../../player_computer.h"
+#include "../../player_data.h"
+
+#include "../../post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Performance scenarios; they only put load on the game and run for a fixed amount of turns.
+ * The results are checked by the performance mode against the baselines inside ftest_list.c
+ */
+struct ftest_perf_scenarios__variables
+{
+    MapSlabCoord slb_x_from;
+    MapSlabCoord slb_y_from;
+    MapSlabCoord slb_x_to;
+    MapSlabCoord slb_y_to;
+    unsigned short creatures_per_side;
+    CrtrExpLevel max_level;
+    unsigned short min_computer_players;
+};
+struct ftest_perf_scenarios__variables ftest_perf_big_battle__vars = {
+    .slb_x_from = 50,
+    .slb_y_from = 50,
+    .slb_x_to = 70,
+    .slb_y_to = 70,
+    .creatures_per_side = 80,
+    .max_level = 6
+};
+struct ftest_perf_scenarios__variables ftest_perf_mass_digging__vars = {
+    .slb_x_from = 26,
+    .slb_y_from = 30,
+    .slb_x_to = 56,
+    .slb_y_to = 58,
+    .creatures_per_side = 40,
+    .max_level = 0
+};
+struct ftest_perf_scenarios__variables ftest_perf_many_ai__vars = {
+    .min_computer_players = 2
+};
+
+// forward declarations - tests
+FTestActionResult ftest_perf_big_battle_action001__spawn_armies(struct FTestActionArgs* const args);
+FTestActionResult ftest_perf_mass_digging_action001__spawn_imps_and_dig(struct FTestActionArgs* const args);
+FTestActionResult ftest_perf_many_ai_action001__hand_keepers_to_computer(struct FTestActionArgs* const args);
+FTestActionResult ftest_perf_scenarios_action__end_test(struct FTestActionArgs* const args);
+
+TbBool ftest_perf_big_battle_init()
+{
+    ftest_append_action(ftest_perf_big_battle_action001__spawn_armies,    10,     &ftest_perf_big_battle__vars);
+    ftest_append_action(ftest_perf_scenarios_action__end_test,            1200,   &ftest_perf_big_battle__vars);
+
+    return true;
+}
+
+TbBool ftest_perf_mass_digging_init()
+{
+    ftest_append_action(ftest_perf_mass_digging_action001__spawn_imps_and_dig,  10,     &ftest_perf_mass_digging__vars);
+    ftest_append_action(ftest_perf_scenarios_action__end_test,                  2000,   &ftest_perf_mass_digging__vars);
+
+    return true;
+}
+
+TbBool ftest_perf_many_ai_init()
+{
+    ftest_append_action(ftest_perf_many_ai_action001__hand_keepers_to_computer, 10,     &ftest_perf_many_ai__vars);
+    ftest_append_action(ftest_perf_scenarios_action__end_test,                  4000,   &ftest_perf_many_ai__vars);
+
+    return true;
+}
+
+FTestActionResult ftest_perf_big_battle_action001__spawn_armies(struct FTestActionArgs* const args)
+{
+    struct ftest_perf_scenarios__variables* const vars = args->data;
+
+    ftest_util_reveal_map(PLAYER0);
+
+    // open arena, keeper creatures on the west side and heroes on the east side
+    if(!ftest_util_replace_slabs(vars->slb_x_from, vars->slb_y_from, vars->slb_x_to, vars->slb_y_to, SlbT_CLAIMED, PLAYER0))
+    {
+        FTEST_FAIL_TEST("Failed to create arena");
+        return FTRs_Go_To_Next_Action;
+    }
+
+    MapSlabCoord slb_x_mid = (vars->slb_x_from + vars->slb_x_to) / 2;
+    MapSlabDelta slb_h = vars->slb_y_to - vars->slb_y_from + 1;
+    for(unsigned short i = 0; i < vars->creatures_per_side; ++i)
+    {
+        MapSlabCoord slb_y = vars->slb_y_from + (i % slb_h);
+        MapSlabCoord slb_x_offset = i / slb_h;
+        struct Thing* keeper_creature = ftest_util_create_random_creature(subtile_coord_center(slab_subtile_center(slb_x_mid - 2 - slb_x_offset)),
+            subtile_coord_center(slab_subtile_center(slb_y)), PLAYER0, vars->max_level);
+        struct Thing* hero_creature = ftest_util_create_random_creature(subtile_coord_center(slab_subtile_center(slb_x_mid + 2 + slb_x_offset)),
+            subtile_coord_center(slab_subtile_center(slb_y)), PLAYER_GOOD, vars->max_level);
+        if(thing_is_invalid(keeper_creature) || thing_is_invalid(hero_creature))
+        {
+            FTEST_FAIL_TEST("Failed to create creatures for the battle");
+            return FTRs_Go_To_Next_Action;
+        }
+    }
+
+    ftest_util_move_camera_to_slab(slb_x_mid, (vars->slb_y_from + vars->slb_y_to) / 2, PLAYER0);
+
+    return FTRs_Go_To_Next_Action;
+}
+
+FTestActionResult ftest_perf_mass_digging_action001__spawn_imps_and_dig(struct FTestActionArgs* const args)
+{
+    struct ftest_perf_scenarios__variables* const vars = args->data;
+
+    ftest_util_reveal_map(PLAYER0);
+
+    struct Thing* heartng = get_player_soul_container(PLAYER0);
+    if(thing_is_invalid(heartng))
+    {
+        FTEST_FAIL_TEST("Failed to find dungeon heart");
+        return FTRs_Go_To_Next_Action;
+    }
+
+    for(unsigned short i = 0; i < vars->creatures_per_side; ++i)
+    {
+        struct Thing* imp = create_owned_special_digger(heartng->mappos.x.val, heartng->mappos.y.val, PLAYER0);
+        if(thing_is_invalid(imp))
+        {
+            FTEST_FAIL_TEST("Failed to create imp %d", i);
+            return FTRs_Go_To_Next_Action;
+        }
+    }
+
+    // mark everything diggable around the dungeon; slabs which can't be dug are just skipped
+    for(MapSlabCoord slb_y = vars->slb_y_from; slb_y <= vars->slb_y_to; ++slb_y)
+    {
+        for(MapSlabCoord slb_x = vars->slb_x_from; slb_x <= vars->slb_x_to; ++slb_x)
+        {
+            game_action(PLAYER0, GA_MarkDig, 0, slab_subtile_center(slb_x), slab_subtile_center(slb_y), 1, 1);
+        }
+    }
+
+    ftest_util_move_camera_to_thing(heartng, PLAYER0);
+
+    return FTRs_Go_To_Next_Action;
+}
+
+FTestActionResult ftest_perf_many_ai_action001__hand_keepers_to_computer(struct FTestActionArgs* const args)
+{
+    struct ftest_perf_scenarios__variables* const vars = args->data;
+
+    ftest_util_reveal_map(PLAYER0);
+
+    // the other keepers are computer players since level start, the local player gets the computer assistant
+    unsigned short computer_players = 0;
+    for(PlayerNumber plyr_idx = 0; plyr_idx < PLAYERS_COUNT; ++plyr_idx)
+    {
+        struct PlayerInfo* player = get_player(plyr_idx);
+        if(!player_exists(player) || !player_is_keeper(plyr_idx) || thing_is_invalid(get_player_soul_container(plyr_idx)))
+        {
+            continue;
+        }
+        struct Dungeon* dungeon = get_players_dungeon(player);
+        if((player->allocflags & PlaF_CompCtrl) == 0 && (dungeon->computer_enabled & 0x01) == 0)
+        {
+            if(!setup_a_computer_player(plyr_idx, 0) || !toggle_computer_player(plyr_idx))
+            {
+                FTEST_FAIL_TEST("Failed to hand player %d to the computer", (int)plyr_idx);
+                return FTRs_Go_To_Next_Action;
+            }
+        }
+        computer_players++;
+    }
+    FTESTLOG("%d keepers are computer players", (int)computer_players);
+    if(computer_players < vars->min_computer_players)
+    {
+        FTEST_FAIL_TEST("Level has %d keepers, at least %d are needed", (int)computer_players, (int)vars->min_computer_players);
+        return FTRs_Go_To_Next_Action;
+    }
+
+    ftest_util_move_camera_to_thing(get_player_soul_container(PLAYER0), PLAYER0);
+
+    return FTRs_Go_To_Next_Action;
+}
+
+FTestActionResult ftest_perf_scenarios_action__end_test(struct FTestActionArgs* const args)
+{
+    // nothing to check here, the performance mode compares the results when the actions are done
+    return FTRs_Go_To_Next_Action;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../../globals.h"
+
+#ifdef FUNCTESTING
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char TbBool; //redefine rather than include extraneus header info
+
+TbBool ftest_perf_big_battle_init();
+TbBool ftest_perf_mass_digging_init();
+TbBool ftest_perf_many_ai_init();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FUNCTESTING
@@ -0,0 +1,151 @@
+#include "ftest_sim_context.h"
+
+#ifdef FUNCTESTING
+
+#include "../../pre_inc.h"
+
+#include "../ftest.h"
+#include "../ftest_util.h"
+
+#include "../../game_legacy.h"
+#include "../../keeperfx.hpp"
+#include "../../net_sync.h"
+#include "../../player_instances.h"
+#include "../../sim_context.h"
+#include "../../thing_creature.h"
+#include "../../dungeon_data.h"
+#include "../../map_data.h"
+
+#include "../../post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Stores the match into simulation contexts and steps them with the headless driver.
+ * Two copies of the same match have to end in the same state, and switching
+ * between matches has to give back exactly the state which was stored.
+ */
+struct ftest_sim_context__variables
+{
+    MapSlabCoord slb_x_mid;
+    MapSlabCoord slb_y_mid;
+    unsigned short creatures_per_side;
+    GameTurn step_turns;
+};
+struct ftest_sim_context__variables ftest_sim_context_roundtrip__vars = {
+    .slb_x_mid = 60,
+    .slb_y_mid = 60,
+    .creatures_per_side = 10,
+    .step_turns = 300
+};
+
+// forward declarations - tests
+FTestActionResult ftest_sim_context_action001__spawn_creatures(struct FTestActionArgs* const args);
+FTestActionResult ftest_sim_context_action002__step_copies(struct FTestActionArgs* const args);
+FTestActionResult ftest_sim_context_action003__end_test(struct FTestActionArgs* const args);
+
+TbBool ftest_sim_context_roundtrip_init()
+{
+    ftest_append_action(ftest_sim_context_action001__spawn_creatures,   10,     &ftest_sim_context_roundtrip__vars);
+    ftest_append_action(ftest_sim_context_action002__step_copies,       50,     &ftest_sim_context_roundtrip__vars);
+    ftest_append_action(ftest_sim_context_action003__end_test,          50,     &ftest_sim_context_roundtrip__vars);
+
+    return true;
+}
+
+FTestActionResult ftest_sim_context_action001__spawn_creatures(struct FTestActionArgs* const args)
+{
+    struct ftest_sim_context__variables* const vars = args->data;
+
+    ftest_util_reveal_map(PLAYER0);
+
+    // a fight gives the simulation plenty of random rolls, paths and things to create and remove
+    if(!ftest_util_replace_slabs(vars->slb_x_mid - 5, vars->slb_y_mid - 5, vars->slb_x_mid + 5, vars->slb_y_mid + 5, SlbT_CLAIMED, PLAYER0))
+    {
+        FTEST_FAIL_TEST("Failed to create arena");
+        return FTRs_Go_To_Next_Action;
+    }
+    for(unsigned short i = 0; i < vars->creatures_per_side; ++i)
+    {
+        MapSlabCoord slb_y = vars->slb_y_mid - 4 + (i % 9);
+        struct Thing* keeper_creature = ftest_util_create_random_creature(subtile_coord_center(slab_subtile_center(vars->slb_x_mid - 3)),
+            subtile_coord_center(slab_subtile_center(slb_y)), PLAYER0, 4);
+        struct Thing* hero_creature = ftest_util_create_random_creature(subtile_coord_center(slab_subtile_center(vars->slb_x_mid + 3)),
+            subtile_coord_center(slab_subtile_center(slb_y)), PLAYER_GOOD, 4);
+        if(thing_is_invalid(keeper_creature) || thing_is_invalid(hero_creature))
+        {
+            FTEST_FAIL_TEST("Failed to create creatures");
+            return FTRs_Go_To_Next_Action;
+        }
+    }
+
+    ftest_util_move_camera_to_slab(vars->slb_x_mid, vars->slb_y_mid, PLAYER0);
+
+    return FTRs_Go_To_Next_Action;
+}
+
+FTestActionResult ftest_sim_context_action002__step_copies(struct FTestActionArgs* const args)
+{
+    struct ftest_sim_context__variables* const vars = args->data;
+
+    struct SimContext original = {0};
+    struct SimContext copy_a = {0};
+    struct SimContext copy_b = {0};
+    if(!sim_context_alloc(&original) || !sim_context_alloc(&copy_a) || !sim_context_alloc(&copy_b))
+    {
+        sim_context_free(&copy_b);
+        sim_context_free(&copy_a);
+        sim_context_free(&original);
+        FTEST_FRAMEWORK_ABORT("Failed to allocate simulation contexts");
+        return FTRs_Go_To_Next_Action;
+    }
+    sim_context_store(&original);
+    sim_context_store(&copy_a);
+    sim_context_store(&copy_b);
+    TbBigChecksum stored_hash = state_hash_total();
+
+    // restoring right after storing must not change anything
+    sim_context_restore(&copy_a);
+    if(state_hash_total() != stored_hash)
+    {
+        FTEST_FAIL_TEST("State changed by restoring, hash %08lx instead of %08lx", (unsigned long)state_hash_total(), (unsigned long)stored_hash);
+    }
+
+    sim_context_step(&copy_a, vars->step_turns);
+    TbBigChecksum hash_a = state_hash_total();
+    unsigned long seed_a = game.action_rand_seed;
+    GameTurn turn_a = game.play_gameturn;
+
+    // copy b is stepped after copy a was simulated in the same globals
+    sim_context_step(&copy_b, vars->step_turns);
+    if((state_hash_total() != hash_a) || (game.action_rand_seed != seed_a) || (game.play_gameturn != turn_a))
+    {
+        FTEST_FAIL_TEST("Copies of the match diverged, hash %08lx and %08lx at turn %lu",
+            (unsigned long)hash_a, (unsigned long)state_hash_total(), (unsigned long)game.play_gameturn);
+    }
+
+    // switching back to copy a gives the state it was left in
+    sim_context_restore(&copy_a);
+    if(state_hash_total() != hash_a)
+    {
+        FTEST_FAIL_TEST("Switching back changed the match, hash %08lx instead of %08lx", (unsigned long)state_hash_total(), (unsigned long)hash_a);
+    }
+
+    sim_context_restore(&original);
+    FTESTLOG("Stepped two copies of the match by %lu turns, hash %08lx", (unsigned long)vars->step_turns, (unsigned long)hash_a);
+
+    sim_context_free(&copy_b);
+    sim_context_free(&copy_a);
+    sim_context_free(&original);
+    return FTRs_Go_To_Next_Action;
+}
+
+FTestActionResult ftest_sim_context_action003__end_test(struct FTestActionArgs* const args)
+{
+    // the match goes on from the original state
+    return FTRs_Go_To_Next_Action;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../../globals.h"
+
+#ifdef FUNCTESTING
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char TbBool;
+
+TbBool ftest_sim_context_roundtrip_init();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FUNCTESTING
@@ -24,6 +24,7 @@
 
 #include "map_data.h"
 #include "game_merge.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 /******************************************************************************/
@@ -33,16 +34,18 @@ long get_subtile_lightness(const struct LightsShadows * lish, MapSubtlCoord stl_
     if (stl_y > gameadd.map_subtiles_y) stl_y = gameadd.map_subtiles_y;
     if (stl_x < 0)  stl_x = 0;
     if (stl_y < 0) stl_y = 0;
-    return lish->subtile_lightness[get_subtile_number(stl_x,stl_y)];
+    return map_arena.subtile_lightness[get_subtile_number(stl_x,stl_y)];
 }
 
 void clear_subtiles_lightness(struct LightsShadows * lish)
 {
+    if (map_arena.data == NULL)
+        return;
     for (MapSubtlCoord y = 0; y < (gameadd.map_subtiles_y + 1); y++)
     {
         for (MapSubtlCoord x = 0; x < (gameadd.map_subtiles_x + 1); x++)
         {
-            unsigned short* wptr = &lish->subtile_lightness[get_subtile_number(x, y)];
+            unsigned short* wptr = &map_arena.subtile_lightness[get_subtile_number(x, y)];
             *wptr = MINIMUM_LIGHTNESS;
         }
     }
@@ -68,6 +71,11 @@ void clear_shadow_limits(struct LightsShadows * lish)
 void clear_light_system(struct LightsShadows * lish)
 {
     memset(lish, 0, sizeof(struct LightsShadows));
+    if (map_arena.data != NULL)
+    {
+        memset(map_arena.stat_light_map, 0, map_arena.subtiles_count * sizeof(unsigned short));
+        memset(map_arena.subtile_lightness, 0, map_arena.subtiles_count * sizeof(unsigned short));
+    }
 }
 
 /******************************************************************************/
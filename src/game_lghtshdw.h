@@ -56,13 +56,11 @@ struct LightsShadows {
     unsigned char shadow_limits[SHADOW_LIMITS_COUNT];
     struct Light lights[LIGHTS_COUNT];
     struct ShadowCache shadow_cache[SHADOW_CACHE_COUNT];
-    unsigned short stat_light_map[MAX_SUBTILES_X*MAX_SUBTILES_Y];
     long global_ambient_light;
     TbBool light_enabled;
     TbBool lighting_tables_initialised;
     unsigned long light_rand_seed;
     int lighting_tables_count; // number of entries in lighting_tables
-    unsigned short subtile_lightness[MAX_SUBTILES_X*MAX_SUBTILES_Y];
 };
 
 #pragma pack()
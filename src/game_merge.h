@@ -174,8 +174,6 @@ struct GameAdd {
     TbBool heart_lost_quick_message;
     unsigned long heart_lost_message_id;
     long heart_lost_message_target;
-    unsigned char slab_ext_data[MAX_TILES_X*MAX_TILES_Y];
-    unsigned char slab_ext_data_initial[MAX_TILES_X*MAX_TILES_Y];
     float delta_time;
     long double process_turn_time;
     float flash_button_time;
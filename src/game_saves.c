@@ -45,6 +45,9 @@
 #include "keeperfx.hpp"
 #include "api.h"
 #include "lvl_filesdk1.h"
+#include "map_blocks.h"
+#include "map_arena.h"
+#include "sim_context.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -74,6 +77,57 @@ TbBool is_primitive_save_version(long filesize)
     return false;
 }
 
+/**
+ * Writes the map arrays chunk; the arrays are preceded by map dimensions.
+ */
+static TbBool save_map_arena_chunk(TbFileHandle fhandle)
+{
+    struct FileChunkHeader hdr;
+    struct MapArenaHeader mahdr;
+    mahdr.tiles_x = map_arena.tiles_x;
+    mahdr.tiles_y = map_arena.tiles_y;
+    mahdr.size = map_arena.size;
+    hdr.id = SGC_MapArena;
+    hdr.ver = 0;
+    hdr.len = sizeof(struct MapArenaHeader) + map_arena.size;
+    if (LbFileWrite(fhandle, &hdr, sizeof(struct FileChunkHeader)) != sizeof(struct FileChunkHeader))
+        return false;
+    if (LbFileWrite(fhandle, &mahdr, sizeof(struct MapArenaHeader)) != sizeof(struct MapArenaHeader))
+        return false;
+    return (LbFileWrite(fhandle, map_arena.data, map_arena.size) == map_arena.size);
+}
+
+/**
+ * Reads the map arrays chunk; requires GameAdd chunk to be loaded before, as map size is stored there.
+ */
+static TbBool load_map_arena_chunk(TbFileHandle fhandle, const struct FileChunkHeader *hdr)
+{
+    struct MapArenaHeader mahdr;
+    if ((hdr->len < sizeof(struct MapArenaHeader)) ||
+        (LbFileRead(fhandle, &mahdr, sizeof(struct MapArenaHeader)) != sizeof(struct MapArenaHeader)))
+    {
+        WARNLOG("Could not read MapArena chunk");
+        return false;
+    }
+    if ((mahdr.tiles_x != gameadd.map_tiles_x) || (mahdr.tiles_y != gameadd.map_tiles_y) ||
+        (mahdr.size != map_arena_size(mahdr.tiles_x, mahdr.tiles_y)) ||
+        (hdr->len != sizeof(struct MapArenaHeader) + mahdr.size))
+    {
+        if (LbFileSeek(fhandle, hdr->len - sizeof(struct MapArenaHeader), Lb_FILE_SEEK_CURRENT) < 0)
+            LbFileSeek(fhandle, 0, Lb_FILE_SEEK_END);
+        WARNLOG("Incompatible MapArena chunk");
+        return false;
+    }
+    if (!map_arena_alloc(mahdr.tiles_x, mahdr.tiles_y))
+        return false;
+    if (LbFileRead(fhandle, map_arena.data, mahdr.size) != mahdr.size)
+    {
+        WARNLOG("Could not read MapArena chunk");
+        return false;
+    }
+    return true;
+}
+
 TbBool save_game_chunks(TbFileHandle fhandle,struct CatalogueEntry *centry)
 {
     struct FileChunkHeader hdr;
@@ -104,6 +158,10 @@ TbBool save_game_chunks(TbFileHandle fhandle,struct CatalogueEntry *centry)
         if (LbFileWrite(fhandle, &gameadd, sizeof(struct GameAdd)) == sizeof(struct GameAdd))
             chunks_done |= SGF_GameAdd;
     }
+    { // Map arrays chunk
+        if (save_map_arena_chunk(fhandle))
+            chunks_done |= SGF_MapArena;
+    }
     { // IntralevelData data chunk
         hdr.id = SGC_IntralevelData;
         hdr.ver = 0;
@@ -156,9 +214,13 @@ TbBool save_packet_chunks(TbFileHandle fhandle,struct CatalogueEntry *centry)
             if (LbFileWrite(fhandle, &gameadd, sizeof(struct GameAdd)) == sizeof(struct GameAdd))
                 chunks_done |= SGF_GameAdd;
         }
+        { // Map arrays chunk
+            if (save_map_arena_chunk(fhandle))
+                chunks_done |= SGF_MapArena;
+        }
     }
-    { // Packet file data start indicator
-        hdr.id = SGC_PacketData;
+    { // Packet file data start indicator; data is stored in compressed blocks
+        hdr.id = SGC_PacketBlocks;
         hdr.ver = 0;
         hdr.len = 0;
         if (LbFileWrite(fhandle, &hdr, sizeof(struct FileChunkHeader)) == sizeof(struct FileChunkHeader))
@@ -228,6 +290,10 @@ int load_game_chunks(TbFileHandle fhandle,struct CatalogueEntry *centry)
                 WARNLOG("Could not read GameOrig chunk");
             }
             break;
+        case SGC_MapArena:
+            if (load_map_arena_chunk(fhandle, &hdr))
+                chunks_done |= SGF_MapArena;
+            break;
         case SGC_PacketHeader:
             if (hdr.len != sizeof(struct PacketSaveHead))
             {
@@ -244,6 +310,7 @@ int load_game_chunks(TbFileHandle fhandle,struct CatalogueEntry *centry)
             }
             break;
         case SGC_PacketData:
+        case SGC_PacketBlocks:
             if (hdr.len != 0)
             {
                 if (LbFileSeek(fhandle, hdr.len, Lb_FILE_SEEK_CURRENT) < 0)
@@ -377,6 +444,7 @@ TbBool load_game(long slot_num)
     LbFileClose(fh);
     snprintf(game.campaign_fname, sizeof(game.campaign_fname), "%s", campaign.fname);
     reinit_level_after_load();
+    clear_world_caches();
     output_message(SMsg_GameLoaded, 0, true);
     panel_map_update(0, 0, gameadd.map_subtiles_x+1, gameadd.map_subtiles_y+1);
     calculate_moon_phase(false,false);
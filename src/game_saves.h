@@ -38,19 +38,22 @@ enum SaveGameChunks {
      SGC_PacketHeader   = 0x52444850, //"PHDR"
      SGC_PacketData     = 0x544B4350, //"PCKT"
      SGC_IntralevelData = 0x4C564C49, //"ILVL"
+     SGC_PacketBlocks   = 0x4B4C4250, //"PBLK"
+     SGC_MapArena       = 0x4150414D, //"MAPA"
 };
 
 enum SaveGameChunkFlags {
      SGF_InfoBlock      = 0x0001,
      SGF_GameOrig       = 0x0002,
      SGF_GameAdd        = 0x0004,
+     SGF_MapArena       = 0x0008,
      SGF_PacketHeader   = 0x0100,
      SGF_PacketData     = 0x0200,
      SGF_IntralevelData = 0x0400,
 };
-#define SGF_SavedGame      (SGF_InfoBlock|SGF_GameOrig|SGF_GameAdd|SGF_IntralevelData)
+#define SGF_SavedGame      (SGF_InfoBlock|SGF_GameOrig|SGF_GameAdd|SGF_MapArena|SGF_IntralevelData)
 #define SGF_PacketStart    (SGF_PacketHeader|SGF_PacketData|SGF_InfoBlock)
-#define SGF_PacketContinue (SGF_PacketHeader|SGF_PacketData|SGF_InfoBlock|SGF_GameOrig|SGF_GameAdd)
+#define SGF_PacketContinue (SGF_PacketHeader|SGF_PacketData|SGF_InfoBlock|SGF_GameOrig|SGF_GameAdd|SGF_MapArena)
 
 enum GameLoadStatus {
     GLoad_Failed = 0,
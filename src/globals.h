@@ -160,10 +160,9 @@ extern "C" {
   #define AIDBG(dblv,format, ...)
 #endif
 
-#define MAX_TILES_X 170
-#define MAX_TILES_Y 170
-#define MAX_SUBTILES_X 511
-#define MAX_SUBTILES_Y 511
+/** Map arrays are allocated for each level; size is limited by triangulation, which keeps subtile coords in shorts. */
+#define MAX_TILES_X (SHRT_MAX / 3)
+#define MAX_TILES_Y (SHRT_MAX / 3)
 
 #pragma pack(1)
 
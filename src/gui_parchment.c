@@ -95,6 +95,7 @@ void reload_parchment_file(TbBool hires)
       fname = prepare_file_path(FGrp_StdData,"gmap32.raw");
 #endif
       LbFileLoadAt(fname, poly_pool);
+      poly_pool_mark_dirty();
   }
   parchment_loaded = 1;
 }
@@ -30,6 +30,7 @@
 #include "config_terrain.h"
 #include "game_merge.h"
 #include "game_legacy.h"
+#include "net_rollback.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -322,6 +323,9 @@ struct SMessage messages[] = {
  */
 TbBool output_message(long msg_idx, long delay, TbBool queue)
 {
+    // When simulating turns again, the messages were already said
+    if (network_rollback_resimulating())
+        return false;
     if (msg_idx < 0)
     {
         if (!speech_sample_playing())
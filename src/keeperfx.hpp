@@ -112,6 +112,7 @@ enum FunctestFlags {
     FTF_LevelLoaded         = 0x08, // For tracking if map is ready
     FTF_ExitOnTestFailure   = 0x10, // If users want to exit on any test failure
     FTF_IncludeLongTests    = 0x20, // If users want to run the long running test list
+    FTF_PerformanceMode     = 0x40, // Run the performance test list, and compare results with baselines
 };
 #endif
 
@@ -147,6 +148,9 @@ struct StartupParameters {
     TbBool overrides[CMDLINE_OVERRIDES];
     char config_file[CMDLN_MAXLEN+1];
     GameTurn pause_at_gameturn;
+    TbBool network_rollback;
+    char archive_fname[CMDLN_MAXLEN+1];
+    TbBool archive_build;
 #ifdef FUNCTESTING
     unsigned char functest_flags;
     char functest_name[FTEST_MAX_NAME_LENGTH];
@@ -219,6 +223,7 @@ short setup_game(void);
 void game_loop(void);
 short reset_game(void);
 void update(void);
+void update_game_world(void);
 
 TbBool can_thing_be_queried(struct Thing *thing, PlayerNumber plyr_idx);
 struct Thing *get_queryable_object_near(MapCoord pos_x, MapCoord pos_y, long plyr_idx);
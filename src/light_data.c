@@ -32,6 +32,7 @@
 #include "game_legacy.h"
 #include "value_util.h"
 
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -710,12 +711,14 @@ void clear_stat_light_map(void)
     game.lish.global_ambient_light = 32;
     game.lish.light_enabled = 0;
     game.lish.light_rand_seed = 0;
+    if (map_arena.data == NULL)
+        return;
     for (unsigned long y = 0; y < (gameadd.map_subtiles_y + 1); y++)
     {
         for (unsigned long x = 0; x < (gameadd.map_subtiles_x + 1); x++)
         {
             unsigned long i = get_subtile_number(x, y);
-            game.lish.stat_light_map[i] = 0;
+            map_arena.stat_light_map[i] = 0;
         }
     }
 }
@@ -1501,7 +1504,7 @@ static void light_stat_light_map_clear_area(MapSubtlCoord start_stl_x, MapSubtlC
         }
         for (stl_x = start_stl_x; stl_x <= end_stl_x; stl_x++)
         {
-          light_map = &game.lish.stat_light_map[get_subtile_number(stl_x,stl_y)];
+          light_map = &map_arena.stat_light_map[get_subtile_number(stl_x,stl_y)];
           stl_x_min_1 = stl_x - 1;
           if ( stl_x_min_1 < 0 )
           {
@@ -1643,7 +1646,7 @@ static char light_render_light_dynamic_uncached(struct Light *lgt, int radius, i
         int diagonal_length = LbDiagonalLength(unk_4_x, unk_4_y);
         short lightness = intensity * (radius - diagonal_length) / radius;
         SubtlCodedCoords light_stl_num = get_subtile_number(lgt->mappos.x.stl.num,lgt->mappos.y.stl.num);
-        unsigned short *stl_lightness_ptr = &game.lish.subtile_lightness[light_stl_num];
+        unsigned short *stl_lightness_ptr = &map_arena.subtile_lightness[light_stl_num];
         if ( *stl_lightness_ptr < lightness )
             *stl_lightness_ptr = lightness;
         struct LightingTable *lighting_table_pointer = &game.lish.lighting_tables[0];
@@ -1732,7 +1735,7 @@ static char light_render_light_dynamic_uncached(struct Light *lgt, int radius, i
                                 lighting_tables_idx = intensity * (radius - diagonal_length2) / radius;
                                 if ( lighting_tables_idx <= game.lish.global_ambient_light )
                                     return lighting_tables_idx;
-                                unsigned short *stl_lightness_ptr2 = &game.lish.subtile_lightness[get_subtile_number(stl_x,stl_y)];
+                                unsigned short *stl_lightness_ptr2 = &map_arena.subtile_lightness[get_subtile_number(stl_x,stl_y)];
                                 if ( *stl_lightness_ptr2 < lighting_tables_idx )
                                     *stl_lightness_ptr2 = lighting_tables_idx;
                             }
@@ -1762,9 +1765,9 @@ static char light_render_light_dynamic(struct Light *lgt, int radius, int render
         shadow_cache->field_1[lighting_tables_idx] |= 1 << (31 - lighting_tables_idx);
         int diagonal_length = LbDiagonalLength(lgt->mappos.x.stl.pos, lgt->mappos.y.stl.pos);
         int intensity = render_intensity * (radius - diagonal_length) / radius;
-        if (lish->subtile_lightness[stl_num] < intensity)
+        if (map_arena.subtile_lightness[stl_num] < intensity)
         {
-            lish->subtile_lightness[stl_num] = intensity;
+            map_arena.subtile_lightness[stl_num] = intensity;
         }
         struct LightingTable *lighting_table = &lish->lighting_tables[0];
         stl_num = get_subtile_number(lish->lighting_tables_count, stl_num_decode_y(stl_num));
@@ -1871,9 +1874,9 @@ static char light_render_light_dynamic(struct Light *lgt, int radius, int render
                             }
                             shadow_cache->field_1[lighting_tables_idx + lighting_table->delta_y] |= 1 << (31 - lighting_table->delta_x - (char)lighting_tables_idx);
                             SubtlCodedCoords next_stl = get_subtile_number(stl_x, stl_y);
-                            if (lish->subtile_lightness[next_stl] < stl_num)
+                            if (map_arena.subtile_lightness[next_stl] < stl_num)
                             {
-                                lish->subtile_lightness[next_stl] = stl_num;
+                                map_arena.subtile_lightness[next_stl] = stl_num;
                             }
                         }
                     }
@@ -1899,9 +1902,9 @@ static int light_render_light_static(struct Light *lgt, int radius, int intensit
         int diagonal_length = LbDiagonalLength(x, y);
         unsigned short lightness = intensity * (radius - diagonal_length) / radius;
         unsigned int light_map_idx = get_subtile_number(lgt->mappos.x.stl.num,lgt->mappos.y.stl.num);
-        if (lish->stat_light_map[light_map_idx] < lightness)
+        if (map_arena.stat_light_map[light_map_idx] < lightness)
         {
-            lish->stat_light_map[light_map_idx] = lightness;
+            map_arena.stat_light_map[light_map_idx] = lightness;
         }
         unsigned int lighting_table_idx = 0;
         for (floor_filled_stls = lish->lighting_tables_count;
@@ -1984,8 +1987,8 @@ static int light_render_light_static(struct Light *lgt, int radius, int intensit
                         if (floor_filled_stls <= lish->global_ambient_light)
                             return floor_filled_stls;
                         SubtlCodedCoords next_stl = get_subtile_number(stl_x,stl_y);
-                        if (lish->stat_light_map[next_stl] < floor_filled_stls)
-                            lish->stat_light_map[next_stl] = floor_filled_stls;
+                        if (map_arena.stat_light_map[next_stl] < floor_filled_stls)
+                            map_arena.stat_light_map[next_stl] = floor_filled_stls;
                     }
                 }
             }
@@ -2108,7 +2111,7 @@ static char light_render_light(struct Light* lgt)
         MapSubtlCoord stl_x = coord_subtile(x_start);
         MapSubtlCoord stl_y = coord_subtile(y_start);
         int v33 = stl_x - coord_subtile(x_end) + gameadd.map_subtiles_x;
-        unsigned short* lightness = &game.lish.subtile_lightness[get_subtile_number(stl_x, stl_y)];
+        unsigned short* lightness = &map_arena.subtile_lightness[get_subtile_number(stl_x, stl_y)];
         struct ShadowCache *shdc = &game.lish.shadow_cache[lgt->shadow_index];
         lighting_tables_idx = *shdc->field_1;
         if ( y_end >= y_start )
@@ -2199,8 +2202,8 @@ static void light_render_area(MapSubtlCoord startx, MapSubtlCoord starty, MapSub
 
   if ( starty <= endy )
   {
-    unsigned short *stl_lightness = &game.lish.subtile_lightness[start_num];
-    unsigned short *stat_light_map = &game.lish.stat_light_map[start_num];
+    unsigned short *stl_lightness = &map_arena.subtile_lightness[start_num];
+    unsigned short *stat_light_map = &map_arena.stat_light_map[start_num];
 
     MapSubtlDelta y = endy - starty + 1;
     do
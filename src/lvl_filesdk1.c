@@ -25,6 +25,7 @@
 #include "bflib_dernc.h"
 #include "bflib_bufrw.h"
 #include "bflib_fileio.h"
+#include "bflib_datetm.h"
 
 #include "front_simple.h"
 #include "config.h"
@@ -42,6 +43,8 @@
 #include "player_instances.h"
 
 #include <toml.h>
+#include <SDL2/SDL.h>
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -117,6 +120,134 @@ struct LegacyInitLight { // sizeof=0x14
 /******************************************************************************/
 
 
+#define LEVEL_PREFETCH_THREADS 4
+
+/**
+ * Map file read and unpacked in advance by a loader thread.
+ */
+struct LevelFilePrefetch {
+    const char *fext;
+    char fname[2048];
+    unsigned char *buf;
+    long size;
+};
+
+/**
+ * Map files which don't depend on each other; they're read and unpacked
+ * concurrently, then decoded in the usual order by load_level_file().
+ */
+static const char *level_prefetch_exts[] = {
+    "dat", "flg", "clm", "lgtfx", "lgt", "own", "wib", "inf", "aptfx", "apt", "slb", "tngfx", "tng", "wlb",
+};
+
+#define LEVEL_PREFETCH_COUNT (sizeof(level_prefetch_exts)/sizeof(level_prefetch_exts[0]))
+
+static struct LevelFilePrefetch level_prefetch[LEVEL_PREFETCH_COUNT];
+static LevelNumber level_prefetch_lvnum = SINGLEPLAYER_NOTSTARTED;
+static SDL_atomic_t level_prefetch_next;
+
+static void prefetch_level_file(struct LevelFilePrefetch *lpf)
+{
+    lpf->buf = NULL;
+    lpf->size = LbFileLengthRnc(lpf->fname);
+    if (lpf->size <= 0)
+        return;
+    lpf->buf = calloc(lpf->size + 16, 1);
+    if (lpf->buf == NULL)
+        return;
+    lpf->size = LbFileLoadAt(lpf->fname, lpf->buf);
+    if (lpf->size <= 0)
+    {
+        free(lpf->buf);
+        lpf->buf = NULL;
+    }
+}
+
+static int prefetch_level_files_thread(void *data)
+{
+    while (1)
+    {
+        int i = SDL_AtomicAdd(&level_prefetch_next, 1);
+        if (i >= (int)LEVEL_PREFETCH_COUNT)
+            break;
+        prefetch_level_file(&level_prefetch[i]);
+    }
+    return 0;
+}
+
+/**
+ * Reads and unpacks map files of given level using a few loader threads.
+ * The files are then taken by load_single_map_file_to_buffer() instead of reading them again.
+ */
+static void prefetch_level_files(LevelNumber lvnum, short fgroup)
+{
+    // File names are prepared here, as prepare_file_fmtpath() uses a static buffer
+    for (int i = 0; i < (int)LEVEL_PREFETCH_COUNT; i++)
+    {
+        struct LevelFilePrefetch* lpf = &level_prefetch[i];
+        lpf->fext = level_prefetch_exts[i];
+        snprintf(lpf->fname, sizeof(lpf->fname), "%s", prepare_file_fmtpath(fgroup, "map%05lu.%s", (unsigned long)lvnum, lpf->fext));
+        lpf->buf = NULL;
+        lpf->size = 0;
+    }
+    // Make sure the CRC table is filled before unpacking starts on many threads
+    rnc_crc(NULL, 0);
+    SDL_AtomicSet(&level_prefetch_next, 0);
+    SDL_Thread *threads[LEVEL_PREFETCH_THREADS];
+    int threads_count = min(SDL_GetCPUCount(), LEVEL_PREFETCH_THREADS);
+    for (int i = 0; i < threads_count; i++)
+    {
+        threads[i] = SDL_CreateThread(prefetch_level_files_thread, "LevelLoader", NULL);
+        if (threads[i] == NULL) {
+            WARNLOG("Failed to create level loader thread: %s", SDL_GetError());
+        }
+    }
+    // The main thread does its share too, and the remaining work if no thread was created
+    prefetch_level_files_thread(NULL);
+    for (int i = 0; i < threads_count; i++)
+    {
+        if (threads[i] != NULL)
+            SDL_WaitThread(threads[i], NULL);
+    }
+    level_prefetch_lvnum = lvnum;
+}
+
+/**
+ * Frees prefetched files which weren't used by the level loading.
+ */
+static void free_level_prefetch(void)
+{
+    for (int i = 0; i < (int)LEVEL_PREFETCH_COUNT; i++)
+    {
+        free(level_prefetch[i].buf);
+        level_prefetch[i].buf = NULL;
+        level_prefetch[i].size = 0;
+    }
+    level_prefetch_lvnum = SINGLEPLAYER_NOTSTARTED;
+}
+
+/**
+ * Takes map file from the prefetched ones, if it is there.
+ * @return Returns true if the file was prefetched, even if it couldn't be loaded.
+ */
+static TbBool take_prefetched_level_file(LevelNumber lvnum, const char *fext, unsigned char **buf, long *fsize)
+{
+    if (lvnum != level_prefetch_lvnum)
+        return false;
+    for (int i = 0; i < (int)LEVEL_PREFETCH_COUNT; i++)
+    {
+        struct LevelFilePrefetch* lpf = &level_prefetch[i];
+        if (strcmp(lpf->fext, fext) != 0)
+            continue;
+        *buf = lpf->buf;
+        *fsize = (lpf->buf != NULL) ? lpf->size : -1;
+        lpf->buf = NULL;
+        lpf->size = 0;
+        return true;
+    }
+    return false;
+}
+
 /**
  * Loads map file with given level number and file extension.
  * @return Returns NULL if the file doesn't exist or is smaller than ldsize;
@@ -125,9 +256,26 @@ struct LegacyInitLight { // sizeof=0x14
  */
 unsigned char *load_single_map_file_to_buffer(LevelNumber lvnum,const char *fext,long *ldsize,unsigned short flags)
 {
+  unsigned char* buf;
+  long fsize;
+  if (take_prefetched_level_file(lvnum, fext, &buf, &fsize))
+  {
+      if (fsize < *ldsize)
+      {
+          if ((flags & LMFF_Optional) == 0)
+              WARNMSG("Map file \"map%05lu.%s\" doesn't exist or is too small.", lvnum, fext);
+          else
+              SYNCMSG("Optional file \"map%05lu.%s\" doesn't exist or is too small.", lvnum, fext);
+          free(buf);
+          return NULL;
+      }
+      *ldsize = fsize;
+      SYNCDBG(7,"Map file \"map%05lu.%s\" taken from prefetched.",lvnum,fext);
+      return buf;
+  }
   short fgroup = get_level_fgroup(lvnum);
   char* fname = prepare_file_fmtpath(fgroup, "map%05lu.%s", lvnum, fext);
-  long fsize = LbFileLengthRnc(fname);
+  fsize = LbFileLengthRnc(fname);
   if (fsize < *ldsize)
   {
       if ((flags & LMFF_Optional) == 0)
@@ -136,7 +284,7 @@ unsigned char *load_single_map_file_to_buffer(LevelNumber lvnum,const char *fext
           SYNCMSG("Optional file \"map%05lu.%s\" doesn't exist or is too small.", lvnum, fext);
       return NULL;
   }
-  unsigned char* buf = calloc(fsize + 16, 1);
+  buf = calloc(fsize + 16, 1);
   if (buf == NULL)
   {
     if ((flags & LMFF_Optional) == 0)
@@ -574,7 +722,7 @@ TbBool level_lof_file_parse(const char *fname, char *buf, long len)
             if (get_conf_parameter_single(buf,&pos,len,word_buf,sizeof(word_buf)) > 0)
             {
                 k = atoi(word_buf);
-                if (k > 0)
+                if ((k > 0) && (k <= MAX_TILES_X))
                 {
                   lvinfo->mapsize_x = k;
                   n++;
@@ -583,7 +731,7 @@ TbBool level_lof_file_parse(const char *fname, char *buf, long len)
             if (get_conf_parameter_single(buf,&pos,len,word_buf,sizeof(word_buf)) > 0)
             {
                 k = atoi(word_buf);
-                if (k > 0)
+                if ((k > 0) && (k <= MAX_TILES_Y))
                 {
                   lvinfo->mapsize_y = k;
                   n++;
@@ -673,7 +821,7 @@ TbBool load_column_file(LevelNumber lv_num)
     // Fill the columns
     for (long k = 0; k < total; k++)
     {
-        struct Column* colmn = &game.columns_data[k];
+        struct Column* colmn = &map_arena.columns[k];
         memcpy(colmn, &buf[i], sizeof(struct Column));
         //Update top cube in the column
         unsigned short n = find_column_height(colmn);
@@ -711,7 +859,7 @@ TbBool load_map_data_file(LevelNumber lv_num)
         for (x=0; x < (gameadd.map_subtiles_x+1); x++)
         {
             mapblk = get_map_block_at(x,y);
-            unsigned short* wptr = &game.lish.subtile_lightness[get_subtile_number(x, y)];
+            unsigned short* wptr = &map_arena.subtile_lightness[get_subtile_number(x, y)];
             *wptr = 32;
             mapblk->mapwho = 0;
             mapblk->filled_subtiles = 0;
@@ -1342,21 +1490,23 @@ static void load_ext_slabs(LevelNumber lvnum)
 {
     short fgroup = get_level_fgroup(lvnum);
     char* fname = prepare_file_fmtpath(fgroup, "map%05lu.slx", (unsigned long)lvnum);
+    long slb_count = gameadd.map_tiles_x * gameadd.map_tiles_y;
     if (LbFileExists(fname))
     {
-        if (gameadd.map_tiles_x * gameadd.map_tiles_y != LbFileLoadAt(fname, gameadd.slab_ext_data))
+        // The array is sized for the map, so the file can't be larger
+        if ((LbFileLengthRnc(fname) != slb_count) || (LbFileLoadAt(fname, map_arena.slab_ext_data) != slb_count))
         {
             JUSTLOG("Invalid ExtSlab data from %s", fname);
-            memset(gameadd.slab_ext_data, 0, sizeof(gameadd.slab_ext_data));
+            memset(map_arena.slab_ext_data, 0, slb_count);
         }
         SYNCDBG(1, "ExtSlab file:%s ok", fname);
     }
     else
     {
         SYNCDBG(1, "No ExtSlab file:%s", fname);
-        memset(gameadd.slab_ext_data, 0, sizeof(gameadd.slab_ext_data));
+        memset(map_arena.slab_ext_data, 0, slb_count);
     }
-    memcpy(&gameadd.slab_ext_data_initial,&gameadd.slab_ext_data, sizeof(gameadd.slab_ext_data));
+    memcpy(map_arena.slab_ext_data_initial, map_arena.slab_ext_data, slb_count);
 }
 
 void load_map_string_data(struct GameCampaign *campgn, LevelNumber lvnum, short fgroup)
@@ -1419,6 +1569,9 @@ static TbBool load_level_file(LevelNumber lvnum)
     if (LbFileExists(fname))
     {
         result = true;
+        TbClockMSec start_time = LbTimerClock();
+        prefetch_level_files(lvnum, fgroup);
+        TbClockMSec read_time = LbTimerClock();
         struct GameCampaign *campgn = &campaign;
         load_map_string_data(campgn, lvnum, fgroup);
         load_map_data_file(lvnum);
@@ -1463,6 +1616,9 @@ static TbBool load_level_file(LevelNumber lvnum)
         {
             load_ext_slabs(lvnum);
         }
+        free_level_prefetch();
+        SYNCMSG("Level \"map%05lu\" loaded; reading files took %lu ms, decoding %lu ms.", (unsigned long)lvnum,
+            (unsigned long)(read_time - start_time), (unsigned long)(LbTimerClock() - read_time));
     } else
     {
         ERRORLOG("The level \"map%05lu\" doesn't exist; creating empty map.",lvnum);
@@ -52,6 +52,7 @@
 #include "thing_effects.h"
 #include "thing_navigate.h"
 #include "thing_physics.h"
+#include "map_arena.h"
 
 #include "post_inc.h"
 
@@ -2148,6 +2149,7 @@ static void set_room_configuration_process(struct ScriptContext *context)
             roomst->roles = context->value->ulongs[1];
             if (context->value->ulongs[2] > 0)
                 roomst->roles |= context->value->ulongs[2];
+            clear_room_capacity_cache();
             break;
         case 14: // TotalCapacity
             roomst->update_total_capacity_idx = value;
@@ -5555,11 +5557,11 @@ static void set_texture_process(struct ScriptContext *context)
                 {
                     if (texture_id == 0)
                     {
-                        gameadd.slab_ext_data[get_slab_number(slb_x,slb_y)] = gameadd.slab_ext_data_initial[get_slab_number(slb_x,slb_y)];
+                        map_arena.slab_ext_data[get_slab_number(slb_x,slb_y)] = map_arena.slab_ext_data_initial[get_slab_number(slb_x,slb_y)];
                     }
                     else
                     {
-                        gameadd.slab_ext_data[get_slab_number(slb_x,slb_y)] = texture_id;
+                        map_arena.slab_ext_data[get_slab_number(slb_x,slb_y)] = texture_id;
                     }
                 }
             }
@@ -6402,7 +6404,7 @@ static void set_game_rule_process(struct ScriptContext* context)
         //this one is a special case because it updates minimap
         SCRIPTDBG(7,"Changing Game Rule '%s' from %d to %ld", rulename, game.conf.rules.game.allies_share_vision, rulevalue);
         game.conf.rules.game.allies_share_vision = (TbBool)rulevalue;
-        panel_map_update(0, 0, gameadd.map_subtiles_x + 1, gameadd.map_subtiles_y + 1);
+        panel_map_update_all_sliced();
         break;
     case 3: //MapCreatureLimit
         //this one is a special case because it needs to kill of additional creatures
@@ -6913,8 +6915,8 @@ static void change_slab_texture_process(struct ScriptContext* context)
     else
     {
         SlabCodedCoords slb_num = get_slab_number(context->value->shorts[0], context->value->shorts[1]);
-        gameadd.slab_ext_data[slb_num] = context->value->bytes[4];
-        gameadd.slab_ext_data_initial[slb_num] = context->value->bytes[4];
+        map_arena.slab_ext_data[slb_num] = context->value->bytes[4];
+        map_arena.slab_ext_data_initial[slb_num] = context->value->bytes[4];
     }
 }
 
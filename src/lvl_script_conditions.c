@@ -20,6 +20,7 @@
 
 #include "globals.h"
 #include "dungeon_data.h"
+#include "dungeon_stats.h"
 #include "config_magic.h"
 #include "game_legacy.h"
 #include "room_entrance.h"
@@ -56,7 +57,7 @@ long get_condition_value(PlayerNumber plyr_idx, unsigned char valtype, short val
         dungeon = get_dungeon(plyr_idx);
         return dungeon->times_breached_dungeon;
     case SVar_CREATURE_NUM:
-        return count_player_creatures_of_model(plyr_idx, validx);
+        return count_stats_creatures_of_model(get_dungeon_creature_stats(plyr_idx), validx);
     case SVar_TOTAL_DIGGERS:
         dungeon = get_dungeon(plyr_idx);
         return dungeon->num_active_diggers;
@@ -220,13 +221,13 @@ long get_condition_value(PlayerNumber plyr_idx, unsigned char valtype, short val
     case SVar_CONTROLS_CREATURE: // IF_CONTROLS(CREATURE)
         dungeon = get_dungeon(plyr_idx);
         return dungeon->owned_creatures_of_model[validx%game.conf.crtr_conf.model_count]
-          - count_player_list_creatures_of_model_matching_bool_filter(plyr_idx, validx, creature_is_kept_in_custody_by_enemy_or_dying);
+          - count_stats_lost_creatures_of_model(get_dungeon_creature_stats(plyr_idx), validx);
     case SVar_CONTROLS_TOTAL_CREATURES:// IF_CONTROLS(TOTAL_CREATURES)
         dungeon = get_dungeon(plyr_idx);
-        return dungeon->num_active_creatrs - count_player_creatures_not_counting_to_total(plyr_idx);
+        return dungeon->num_active_creatrs - count_stats_lost_creatures_of_model(get_dungeon_creature_stats(plyr_idx), CREATURE_NOT_A_DIGGER);
     case SVar_CONTROLS_TOTAL_DIGGERS:// IF_CONTROLS(TOTAL_DIGGERS)
         dungeon = get_dungeon(plyr_idx);
-        return dungeon->num_active_diggers - count_player_diggers_not_counting_to_total(plyr_idx);
+        return dungeon->num_active_diggers - count_stats_lost_creatures_of_model(get_dungeon_creature_stats(plyr_idx), CREATURE_DIGGER);
     case SVar_ALL_DUNGEONS_DESTROYED:
     {
         player = get_player(plyr_idx);
@@ -413,10 +414,13 @@ void process_conditions(void)
 {
     if (gameadd.script.conditions_num > CONDITIONS_COUNT)
       gameadd.script.conditions_num = CONDITIONS_COUNT;
+    // Conditions only read the world, so creature stats can be gathered once for all of them
+    dungeon_stats_hold();
     for (long i = 0; i < gameadd.script.conditions_num; i++)
     {
       process_condition(&gameadd.script.conditions[i], i);
     }
+    dungeon_stats_release();
 }
 
 long pop_condition(void)
@@ -79,6 +79,18 @@ unsigned char destroy_effect[][9] = {
     {32, 32, 32, 32, 32, 32, 32, 32, 32,},//splevel=8
 };
 
+/**
+ * Sight of Evil explored area which the last fill pass left unchanged, per player.
+ * Filling such area again would change nothing, so it is skipped.
+ */
+struct PowerSightSettled {
+    TbBool settled;
+    ThingIndex thing_idx;
+    MapSubtlCoord stl_x;
+    MapSubtlCoord stl_y;
+};
+static struct PowerSightSettled power_sight_settled[PLAYERS_COUNT];
+
 /******************************************************************************/
 static TbResult magic_use_power_hand         (PowerKind power_kind, PlayerNumber plyr_idx, struct Thing *thing, MapSubtlCoord stl_x, MapSubtlCoord stl_y, long splevel, unsigned long mod_flags);
 static TbResult magic_use_power_apply_spell  (PowerKind power_kind, PlayerNumber plyr_idx, struct Thing *thing, MapSubtlCoord stl_x, MapSubtlCoord stl_y, long splevel, unsigned long mod_flags);
@@ -424,6 +436,20 @@ TbBool can_cast_power_on_thing(PlayerNumber plyr_idx, const struct Thing *thing,
     return false;
 }
 
+/**
+ * Marks that Sight of Evil explored area of given player has new subtiles, which need filling.
+ */
+void power_sight_explored_changed(PlayerNumber plyr_idx)
+{
+    if ((plyr_idx >= 0) && (plyr_idx < PLAYERS_COUNT))
+        power_sight_settled[plyr_idx].settled = false;
+}
+
+void clear_power_sight_cache(void)
+{
+    memset(power_sight_settled, 0, sizeof(power_sight_settled));
+}
+
 void update_power_sight_explored(struct PlayerInfo *player)
 {
     SYNCDBG(16,"Starting");
@@ -434,6 +460,16 @@ void update_power_sight_explored(struct PlayerInfo *player)
     }
     struct Thing *thing;
     thing = thing_get(dungeon->sight_casted_thing_idx);
+    struct PowerSightSettled *pwsettl = NULL;
+    if (player->id_number < PLAYERS_COUNT)
+    {
+        pwsettl = &power_sight_settled[player->id_number];
+        if (pwsettl->settled && (pwsettl->thing_idx == thing->index) &&
+            (pwsettl->stl_x == thing->mappos.x.stl.num) && (pwsettl->stl_y == thing->mappos.y.stl.num)) {
+            return;
+        }
+    }
+    TbBool changed = false;
 
     int shift_x;
     int shift_y;
@@ -489,8 +525,10 @@ void update_power_sight_explored(struct PlayerInfo *player)
                 subshift_x = stl_x_beg - thing->mappos.x.stl.num + MAX_SOE_RADIUS;
                 for (;revealed > 0; revealed--)
                 {
-                    if (!dungeon->soe_explored_flags[shift_y][subshift_x])
+                    if (!dungeon->soe_explored_flags[shift_y][subshift_x]) {
                         dungeon->soe_explored_flags[shift_y][subshift_x] = 1;
+                        changed = true;
+                    }
                     subshift_x++;
                 }
             }
@@ -543,8 +581,10 @@ void update_power_sight_explored(struct PlayerInfo *player)
                 subshift_y = stl_y_beg - thing->mappos.y.stl.num + MAX_SOE_RADIUS;
                 for (; revealed > 0; revealed--)
                 {
-                    if (!dungeon->soe_explored_flags[subshift_y][shift_x])
+                    if (!dungeon->soe_explored_flags[subshift_y][shift_x]) {
                         dungeon->soe_explored_flags[subshift_y][shift_x] = 1;
+                        changed = true;
+                    }
                     subshift_y++;
                 }
             }
@@ -552,7 +592,14 @@ void update_power_sight_explored(struct PlayerInfo *player)
         stl_y++;
       }
     }
-
+    // If nothing was filled, next pass would fill nothing as well until new subtiles are explored
+    if (pwsettl != NULL)
+    {
+        pwsettl->settled = !changed;
+        pwsettl->thing_idx = thing->index;
+        pwsettl->stl_x = thing->mappos.x.stl.num;
+        pwsettl->stl_y = thing->mappos.y.stl.num;
+    }
 }
 
 TbBool power_sight_explored(MapSubtlCoord stl_x, MapSubtlCoord stl_y, PlayerNumber plyr_idx)
@@ -82,6 +82,8 @@ TbResult magic_use_power_on_level(PlayerNumber plyr_idx, PowerKind spl_idx, unsi
 
 void slap_creature(struct PlayerInfo *player, struct Thing *thing);
 void update_power_sight_explored(struct PlayerInfo *player);
+void power_sight_explored_changed(PlayerNumber plyr_idx);
+void clear_power_sight_cache(void);
 TbBool update_creature_influenced_by_call_to_arms_at_pos(struct Thing *creatng, const struct Coord3d *cta_pos);
 /******************************************************************************/
 #ifdef __cplusplus
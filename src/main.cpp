@@ -25,6 +25,7 @@
 #include "bflib_sprfnt.h"
 #include "bflib_fileio.h"
 #include "bflib_dernc.h"
+#include "bflib_archive.h"
 #include "bflib_sndlib.h"
 #include "bflib_cpu.h"
 #include "bflib_crash.h"
@@ -82,6 +83,7 @@
 #include "thing_creature.h"
 #include "thing_objects.h"
 #include "thing_effects.h"
+#include "thing_particles.h"
 #include "thing_doors.h"
 #include "thing_traps.h"
 #include "thing_navigate.h"
@@ -124,6 +126,9 @@
 #include "game_loop.h"
 #include "music_player.h"
 #include "frontmenu_ingame_map.h"
+#include "net_sync.h"
+#include "net_rollback.h"
+#include "map_arena.h"
 
 #ifdef FUNCTESTING
   #include "ftests/ftest.h"
@@ -1544,6 +1549,7 @@ void reinit_level_after_load(void)
     init_lookups();
     init_navigation();
     reinit_packets_after_load();
+    state_hash_rebuild();
     game.flags_font |= start_params.flags_font;
     parchment_loaded = 0;
     for (i=0; i < PLAYERS_COUNT; i++)
@@ -1614,6 +1620,7 @@ void clear_things_and_persons_data(void)
         thing->mappos.x.val = subtile_coord_center(gameadd.map_subtiles_x/2);
         thing->mappos.y.val = subtile_coord_center(gameadd.map_subtiles_y/2);
     }
+    things_hot_rebuild();
     for (i=0; i < CREATURES_COUNT; i++)
     {
       memset(&game.cctrl_data[i], 0, sizeof(struct CreatureControl));
@@ -1705,6 +1712,7 @@ void delete_all_structures(void)
     delete_all_control_structures();
     delete_all_room_structures();
     delete_all_action_point_structures();
+    clear_effect_particles();
     light_initialise();
     SYNCDBG(16,"Done");
 }
@@ -2729,6 +2737,48 @@ void update_global_lighting()
     }
 }
 
+/**
+ * Simulates one game turn, after packets of the turn were processed.
+ * Only the game state is updated here; effects local to the player in front
+ * of the screen belong to update(). Rollback simulates turns again with it.
+ */
+void update_game_world(void)
+{
+    SYNCDBG(6,"Starting for turn %ld",(long)game.play_gameturn);
+    if (!flag_is_set(game.operation_flags,GOF_Paused))
+    {
+        clear_active_dungeons_stats();
+        update_creature_pool_state();
+        update_things();
+        update_effect_particles();
+        process_rooms();
+        process_dungeons();
+        update_research();
+        update_manufacturing();
+        event_process_events();
+        update_all_events();
+        process_level_script();
+        if ((game.numfield_D & GNFldD_Unkn04) != 0)
+            process_computer_players2();
+        process_players();
+        state_hash_finish_turn();
+        process_action_points();
+        process_armageddon();
+        update_global_lighting();
+#if (BFDEBUG_LEVEL > 9)
+        lights_stats_debug_dump();
+        things_stats_debug_dump();
+        creature_stats_debug_dump();
+#endif
+    }
+    message_update();
+    update_all_players_cameras();
+    if (!flag_is_set(game.operation_flags,GOF_Paused))
+    {
+        game.play_gameturn++;
+    }
+}
+
 void update(void)
 {
     struct PlayerInfo *player;
@@ -2740,6 +2790,9 @@ void update(void)
     if (quit_game || exit_keeper) {
         return;
     }
+    if (network_rollback_stalled()) {
+        return;
+    }
     if (game.game_kind == GKind_Unknown1)
     {
         game.map_changed_for_nagivation = 0;
@@ -2748,29 +2801,20 @@ void update(void)
     player = get_my_player();
     set_previous_camera_values(player);
 
-    if (!flag_is_set(game.operation_flags,GOF_Paused))
+    TbBool paused = flag_is_set(game.operation_flags,GOF_Paused);
+    if (!paused)
     {
         if (flag_is_set(player->additional_flags,PlaAF_LightningPaletteIsActive))
         {
             PaletteSetPlayerPalette(player, engine_palette);
             clear_flag(player->additional_flags, PlaAF_LightningPaletteIsActive);
         }
-        clear_active_dungeons_stats();
-        update_creature_pool_state();
         if ((game.play_gameturn & 0x01) != 0)
             update_animating_texture_maps();
-        update_things();
-        process_rooms();
-        process_dungeons();
-        update_research();
-        update_manufacturing();
-        event_process_events();
-        update_all_events();
-        process_level_script();
-        if ((game.numfield_D & GNFldD_Unkn04) != 0)
-            process_computer_players2();
-        process_players();
-        process_action_points();
+    }
+    update_game_world();
+    if (!paused)
+    {
         player = get_my_player();
         if (player->view_mode == PVM_CreatureView)
         {
@@ -2779,17 +2823,7 @@ void update(void)
         }
         update_footsteps_nearest_camera(player->acamera);
         PaletteFadePlayer(player);
-        process_armageddon();
-        update_global_lighting();
-#if (BFDEBUG_LEVEL > 9)
-        lights_stats_debug_dump();
-        things_stats_debug_dump();
-        creature_stats_debug_dump();
-#endif
     }
-
-    message_update();
-    update_all_players_cameras();
     update_player_sounds();
     SYNCDBG(6,"Finished");
 }
@@ -3301,7 +3335,9 @@ TbBool keeper_screen_swap(void)
       memset(lbDisplay.WScreen, 0, scanline_len*scrmove_y);
       LbScreenUnlock();
     }*/
+  frametime_start_measurement(Frametime_Present);
   LbScreenSwap();
+  frametime_end_measurement(Frametime_Present);
   return true;
 }
 
@@ -3419,6 +3455,8 @@ void gameplay_loop_draw()
     // Floats are used a lot in the drawing related functions. But keep in mind integers are typically preferred for logic related functions.
     frametime_start_measurement(Frametime_Draw);
 
+    coroutine_tasks_process(&coroutine_frame_tasks);
+
     // Update lights
     if ((game.operation_flags & GOF_Paused) == 0) {
         update_light_render_area();
@@ -3489,6 +3527,8 @@ void keeper_gameplay_loop(void)
         gameplay_loop_timestep();
         frametime_end_measurement(Frametime_FullFrame);
     } // end while
+    coroutine_tasks_clear(&coroutine_frame_tasks);
+    network_rollback_stop();
     SYNCDBG(0,"Gameplay loop finished after %lu turns",(unsigned long)game.play_gameturn);
     api_event("GAME_ENDED");
 }
@@ -3883,6 +3923,8 @@ void game_loop(void)
       turn_off_all_menus();
       delete_all_structures();
       clear_mapwho();
+      // Map arrays are sized for the level; next one allocates its own
+      map_arena_free();
       endtime = LbTimerClock();
       quit_game = 0;
       if ((game.operation_flags & GOF_SingleLevel) != 0)
@@ -3917,6 +3959,7 @@ short reset_game(void)
     LbDataFreeAllV2(game_load_files);
     free_gui_strings_data();
     free_level_strings_data();
+    map_arena_free();
     FreeAudio();
     return 1;
 }
@@ -4080,6 +4123,33 @@ short process_command_line(unsigned short argc, char *argv[])
       {
           set_flag(start_params.debug_flags, DFlg_ShowGameTurns);
       } else
+      if (strcasecmp(parstr, "rollback") == 0)
+      {
+          // Network clients simulate ahead of the server; all players need this option
+          start_params.network_rollback = true;
+      } else
+      if (strcasecmp(parstr, "archive") == 0)
+      {
+          // Loads data files from a packed archive, where present
+          snprintf(start_params.archive_fname, sizeof(start_params.archive_fname), "%s", pr2str);
+          narg++;
+      } else
+      if (strcasecmp(parstr, "packarchive") == 0)
+      {
+          snprintf(start_params.archive_fname, sizeof(start_params.archive_fname), "%s", pr2str);
+          start_params.archive_build = true;
+          narg++;
+      } else
+      if (strcasecmp(parstr, "logratelimit") == 0)
+      {
+          // Limits the noisy log categories, so that verbose logging may stay enabled
+          unsigned long msgs_per_sec = atol(pr2str);
+          LbLogSetRateLimit(LbLogCat_Warning, msgs_per_sec);
+          LbLogSetRateLimit(LbLogCat_Sync, msgs_per_sec);
+          LbLogSetRateLimit(LbLogCat_Navi, msgs_per_sec);
+          LbLogSetRateLimit(LbLogCat_Ai, msgs_per_sec);
+          narg++;
+      } else
       if (strcasecmp(parstr, "compuchat") == 0)
       {
           if (strcasecmp(pr2str,"scarce") == 0) {
@@ -4175,6 +4245,24 @@ short process_command_line(unsigned short argc, char *argv[])
         set_flag(start_params.functest_flags, FTF_IncludeLongTests);
 #else
        WARNLOG("Flag '%s' disabled for release builds.", parstr);
+#endif // FUNCTESTING
+      }
+      else if (strcasecmp(parstr, "ftestsperf") == 0)
+      {
+#ifdef FUNCTESTING
+        if(ftest_parse_arg(pr2str)) // handle arg on ftest build
+#else
+        if(strlen(pr2str) > 0 && pr2str[0] != '-') // ignore arg on regular build
+#endif // FUNCTESTING
+        {
+            ++narg;
+        }
+
+#ifdef FUNCTESTING
+        set_flag(start_params.functest_flags, FTF_Enabled);
+        set_flag(start_params.functest_flags, FTF_PerformanceMode);
+#else
+        WARNLOG("Flag '%s' disabled for release builds.", parstr);
 #endif // FUNCTESTING
       }
       else
@@ -4233,6 +4321,17 @@ int LbBullfrogMain(unsigned short argc, char *argv[])
         LbErrorLogClose();
         return 0;
     }
+    if (start_params.archive_fname[0] != '\0')
+    {
+        if (start_params.archive_build)
+        {
+            static const char * const archive_dirs[] = {"data", "ldata", "fxdata", "creatrs", "sound", "levels", "campgns", NULL};
+            LbArchiveBuild(start_params.archive_fname, keeper_runtime_directory, archive_dirs);
+            LbErrorLogClose();
+            return 0;
+        }
+        LbArchiveOpen(start_params.archive_fname, keeper_runtime_directory);
+    }
 
     retval = true;
     retval &= (LbTimerInit() != Lb_FAIL);
@@ -4312,6 +4411,7 @@ int LbBullfrogMain(unsigned short argc, char *argv[])
         SYNCDBG(0,"finished properly");
     }
 
+    LbArchiveClose();
     LbErrorLogClose();
     steam_api_shutdown();
     unload_miles_sound_system();
@@ -49,6 +49,10 @@
 #include "gui_boxmenu.h"
 #include "sounds.h"
 #include "api.h"
+#include "net_rollback.h"
+#include "map_blocks.h"
+#include "sim_context.h"
+#include "map_columns.h"
 
 #ifdef FUNCTESTING
   #include "ftests/ftest.h"
@@ -128,6 +132,7 @@ void init_lookups(void)
         game.things.lookup[i] = &game.things_data[i];
     }
     game.things.end = &game.things_data[THINGS_COUNT];
+    things_hot_rebuild();
 
     memset(&game.persons, 0, sizeof(struct Persons));
     for (i=0; i < CREATURES_COUNT; i++)
@@ -136,11 +141,7 @@ void init_lookups(void)
     }
     game.persons.cctrl_end = &game.cctrl_data[CREATURES_COUNT];
 
-    for (i=0; i < COLUMNS_COUNT; i++)
-    {
-        game.columns.lookup[i] = &game.columns_data[i];
-    }
-    game.columns.end = &game.columns_data[COLUMNS_COUNT];
+    init_columns_lookup();
 }
 
 static void init_level(void)
@@ -263,7 +264,9 @@ static void post_init_level(void)
     update_dungeon_generation_speeds();
     init_traps();
     init_all_creature_states();
+    clear_world_caches();
     init_keepers_map_exploration();
+    state_hash_rebuild();
     SYNCDBG(9,"Finished");
 }
 
@@ -321,6 +324,9 @@ void startup_saved_packet_game(void)
     set_selected_level_number(0);
     struct PlayerInfo* player = get_my_player();
     set_engine_view(player, rotate_mode_to_view_mode(game.packet_save_head.video_rotate_mode));
+    // Skip to the requested turn using state snapshots from the packet file
+    if (flag_is_set(start_params.debug_flags, DFlg_PauseAtGameTurn))
+        packet_seek_to_gameturn(start_params.pause_at_gameturn);
 }
 
 static CoroutineLoopState startup_network_game_tail(CoroutineLoop *context);
@@ -383,6 +389,7 @@ static CoroutineLoopState startup_network_game_tail(CoroutineLoop *context)
     post_init_level();
     post_init_players();
     post_init_packets();
+    network_rollback_start();
     set_selected_level_number(0);
 
 #ifdef FUNCTESTING
@@ -0,0 +1,180 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file map_arena.c
+ *     Per-level world arrays, allocated for the size of the loaded map.
+ * @par Purpose:
+ *     Keeps map blocks, slabs, columns, navigation and lighting maps, and
+ *     caches derived from them, in one memory block sized for the current
+ *     level, instead of for the largest map.
+ * @par Comment:
+ *     None.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#include "pre_inc.h"
+#include "map_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "globals.h"
+#include "bflib_basics.h"
+#include "map_data.h"
+#include "map_columns.h"
+#include "slab_data.h"
+#include "player_data.h"
+#include "thing_shots.h"
+#include "post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+#define MAP_ARENA_ALIGN 16
+/******************************************************************************/
+struct MapArena map_arena;
+/******************************************************************************/
+static unsigned long map_arena_align(unsigned long size)
+{
+    return (size + MAP_ARENA_ALIGN - 1) & ~(unsigned long)(MAP_ARENA_ALIGN - 1);
+}
+
+/**
+ * Returns amount of elements in per-subtile arrays.
+ * There is a spare row and column, as get_subtile_number() clips coords to one beyond the map.
+ */
+static unsigned long map_arena_subtiles_count(MapSlabCoord tiles_x, MapSlabCoord tiles_y)
+{
+    return (unsigned long)(tiles_x * STL_PER_SLB + 2) * (unsigned long)(tiles_y * STL_PER_SLB + 2);
+}
+
+static unsigned long map_arena_shot_cells_x(MapSlabCoord tiles_x)
+{
+    return ((unsigned long)(tiles_x * STL_PER_SLB) >> SHOT_COLLIDE_CELL_SHIFT) + 1;
+}
+
+static unsigned long map_arena_shot_cells_count(MapSlabCoord tiles_x, MapSlabCoord tiles_y)
+{
+    return map_arena_shot_cells_x(tiles_x) * map_arena_shot_cells_x(tiles_y);
+}
+
+/**
+ * Returns size of the world arrays for map of given size.
+ */
+unsigned long map_arena_size(MapSlabCoord tiles_x, MapSlabCoord tiles_y)
+{
+    unsigned long stl_count = map_arena_subtiles_count(tiles_x, tiles_y);
+    unsigned long slb_count = (unsigned long)tiles_x * (unsigned long)tiles_y;
+    return map_arena_align(stl_count * sizeof(struct Map))
+        + map_arena_align(stl_count * sizeof(NavColour))
+        + map_arena_align(slb_count * sizeof(struct SlabMap))
+        + map_arena_align(stl_count * sizeof(unsigned short))
+        + map_arena_align(stl_count * sizeof(unsigned short))
+        + map_arena_align(COLUMNS_COUNT * sizeof(struct Column))
+        + map_arena_align(slb_count * sizeof(unsigned char))
+        + map_arena_align(slb_count * sizeof(unsigned char));
+}
+
+/**
+ * Returns size of the arrays derived from the world, for map of given size.
+ */
+static unsigned long map_arena_derived_size(MapSlabCoord tiles_x, MapSlabCoord tiles_y)
+{
+    unsigned long stl_count = map_arena_subtiles_count(tiles_x, tiles_y);
+    unsigned long slb_count = (unsigned long)tiles_x * (unsigned long)tiles_y;
+    return map_arena_align(PLAYERS_COUNT * slb_count * sizeof(unsigned char))
+        + map_arena_align(slb_count * sizeof(TbBigChecksum))
+        + map_arena_align(stl_count * sizeof(unsigned short))
+        + map_arena_align(stl_count * sizeof(char))
+        + map_arena_align((tiles_x * STL_PER_SLB + 2) * sizeof(long))
+        + map_arena_align((map_arena_shot_cells_count(tiles_x, tiles_y) + 1) * sizeof(long));
+}
+
+/**
+ * Allocates per-level arrays for map of given size, replacing the previous ones.
+ * If the size didn't change, the arrays are kept with their content; otherwise they're zeroed.
+ * @return True if the arrays are ready for the given size.
+ */
+TbBool map_arena_alloc(MapSlabCoord tiles_x, MapSlabCoord tiles_y)
+{
+    if (tiles_x < 0)
+        tiles_x = 0;
+    if (tiles_y < 0)
+        tiles_y = 0;
+    if ((map_arena.data != NULL) && (map_arena.tiles_x == tiles_x) && (map_arena.tiles_y == tiles_y))
+        return true;
+    unsigned long size = map_arena_size(tiles_x, tiles_y);
+    unsigned long derived_size = map_arena_derived_size(tiles_x, tiles_y);
+    unsigned char* data = (unsigned char *)calloc(1, size + derived_size);
+    if (data == NULL)
+    {
+        ERRORLOG("Cannot allocate %lu bytes for map of %dx%d slabs",size + derived_size,(int)tiles_x,(int)tiles_y);
+        return false;
+    }
+    free(map_arena.data);
+    map_arena.data = data;
+    map_arena.size = size;
+    map_arena.tiles_x = tiles_x;
+    map_arena.tiles_y = tiles_y;
+    unsigned long stl_count = map_arena_subtiles_count(tiles_x, tiles_y);
+    unsigned long slb_count = (unsigned long)tiles_x * (unsigned long)tiles_y;
+    map_arena.subtiles_count = stl_count;
+    map_arena.slabs_count = slb_count;
+    map_arena.map = (struct Map *)data;
+    data += map_arena_align(stl_count * sizeof(struct Map));
+    map_arena.navigation_map = (NavColour *)data;
+    data += map_arena_align(stl_count * sizeof(NavColour));
+    map_arena.slabmap = (struct SlabMap *)data;
+    data += map_arena_align(slb_count * sizeof(struct SlabMap));
+    map_arena.stat_light_map = (unsigned short *)data;
+    data += map_arena_align(stl_count * sizeof(unsigned short));
+    map_arena.subtile_lightness = (unsigned short *)data;
+    data += map_arena_align(stl_count * sizeof(unsigned short));
+    map_arena.columns = (struct Column *)data;
+    data += map_arena_align(COLUMNS_COUNT * sizeof(struct Column));
+    map_arena.slab_ext_data = data;
+    data += map_arena_align(slb_count * sizeof(unsigned char));
+    map_arena.slab_ext_data_initial = data;
+    data += map_arena_align(slb_count * sizeof(unsigned char));
+    map_arena.explore_swept_radius = data;
+    data += map_arena_align(PLAYERS_COUNT * slb_count * sizeof(unsigned char));
+    map_arena.slab_state_hash = (TbBigChecksum *)data;
+    data += map_arena_align(slb_count * sizeof(TbBigChecksum));
+    map_arena.panel_map = (unsigned short *)data;
+    data += map_arena_align(stl_count * sizeof(unsigned short));
+    map_arena.ceiling_cache = (char *)data;
+    data += map_arena_align(stl_count * sizeof(char));
+    map_arena.fringe_y = (long *)data;
+    data += map_arena_align((tiles_x * STL_PER_SLB + 2) * sizeof(long));
+    map_arena.shot_cells = (long *)data;
+    map_arena.shot_cells_x = map_arena_shot_cells_x(tiles_x);
+    map_arena.shot_cells_count = map_arena_shot_cells_count(tiles_x, tiles_y);
+    // Triangulation and columns lookup keep their own pointers to the arrays
+    if (IanMap != NULL)
+        IanMap = map_arena.navigation_map;
+    init_columns_lookup();
+    SYNCDBG(7,"Allocated %lu bytes for map of %dx%d slabs",size + derived_size,(int)tiles_x,(int)tiles_y);
+    return true;
+}
+
+/**
+ * Releases per-level arrays; to be called at level end, and on exit.
+ * Clearing the map is allowed without the arrays, and does nothing.
+ */
+void map_arena_free(void)
+{
+    free(map_arena.data);
+    memset(&map_arena, 0, sizeof(struct MapArena));
+    IanMap = NULL;
+    init_columns_lookup();
+}
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
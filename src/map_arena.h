@@ -0,0 +1,92 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file map_arena.h
+ *     Header file for map_arena.c.
+ * @par Purpose:
+ *     Per-level world arrays, allocated for the size of the loaded map.
+ * @par Comment:
+ *     Just a header file - #defines, typedefs, function prototypes etc.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#ifndef DK_MAPARENA_H
+#define DK_MAPARENA_H
+
+#include "globals.h"
+#include "bflib_basics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+#pragma pack(1)
+
+/** Stored in saves before the arena data, to verify it matches the map size. */
+struct MapArenaHeader {
+    unsigned long tiles_x;
+    unsigned long tiles_y;
+    unsigned long size;
+};
+
+#pragma pack()
+/******************************************************************************/
+struct Map;
+struct SlabMap;
+struct Column;
+
+/**
+ * Per-level arrays, all within one memory block which lives from level setup till level end.
+ * World arrays come first; being one block, they can be saved or sent over network at once.
+ * Arrays derived from the world follow them, and aren't a part of the stored size.
+ */
+struct MapArena {
+    unsigned char *data;
+    /** Size of the world arrays part of the block. */
+    unsigned long size;
+    MapSlabCoord tiles_x;
+    MapSlabCoord tiles_y;
+    /** Amount of elements in each per-subtile array. */
+    unsigned long subtiles_count;
+    /** Amount of elements in each per-slab array. */
+    unsigned long slabs_count;
+    // World arrays
+    struct Map *map;
+    NavColour *navigation_map;
+    struct SlabMap *slabmap;
+    unsigned short *stat_light_map;
+    unsigned short *subtile_lightness;
+    struct Column *columns;
+    unsigned char *slab_ext_data;
+    unsigned char *slab_ext_data_initial;
+    // Derived arrays
+    /** Sight distance of sweeps made from each slab, per player. */
+    unsigned char *explore_swept_radius;
+    TbBigChecksum *slab_state_hash;
+    unsigned short *panel_map;
+    char *ceiling_cache;
+    /** Per-subtile column scratch of the triangulation. */
+    long *fringe_y;
+    /** Things bucketing cells of shots collision, and the amount of cells in a row. */
+    long *shot_cells;
+    unsigned long shot_cells_x;
+    unsigned long shot_cells_count;
+};
+/******************************************************************************/
+extern struct MapArena map_arena;
+/******************************************************************************/
+unsigned long map_arena_size(MapSlabCoord tiles_x, MapSlabCoord tiles_y);
+TbBool map_arena_alloc(MapSlabCoord tiles_x, MapSlabCoord tiles_y);
+void map_arena_free(void);
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+#endif
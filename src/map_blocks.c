@@ -42,6 +42,8 @@
 #include "thing_navigate.h"
 #include "thing_physics.h"
 #include "config_spritecolors.h"
+#include "net_sync.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -224,6 +226,8 @@ TbBool tag_blocks_for_digging_in_area(MapSubtlCoord stl_x, MapSubtlCoord stl_y,
           }
       }
       panel_map_update(x, y, STL_PER_SLB, STL_PER_SLB);
+      // New dig tag may be cleared by sight sweeps made again
+      explore_cache_slab_changed(subtile_slab(x), subtile_slab(y));
     }
     return task_added;
 }
@@ -308,6 +312,91 @@ void all_players_untag_blocks_for_digging_in_area(MapSlabCoord slb_x, MapSlabCoo
     }
 }
 
+/**
+ * Remembers sight sweeps done by check_map_explored(), so that creatures of the
+ * same player entering a slab from which the map was already explored don't
+ * repeat the sweep. The sweep only depends on the slabs around, the player's
+ * dig tags and revealed area, so the entries are dropped when any of these change.
+ */
+struct ExploreCache {
+    /** Players whose whole cache must be cleared before use. */
+    TbBool player_invalid[PLAYERS_COUNT];
+    unsigned char max_radius;
+};
+
+static struct ExploreCache explore_cache;
+
+/**
+ * Returns sight distance in slabs of the sweeps done by given player from each slab, 0 if there was none.
+ */
+static unsigned char *explore_cache_swept_radius(PlayerNumber plyr_idx)
+{
+    return &map_arena.explore_swept_radius[plyr_idx * map_arena.slabs_count];
+}
+
+void clear_explore_cache(void)
+{
+    memset(&explore_cache, 0, sizeof(explore_cache));
+    if (map_arena.data != NULL)
+        memset(map_arena.explore_swept_radius, 0, PLAYERS_COUNT * map_arena.slabs_count);
+}
+
+/**
+ * Drops sweeps which could have seen given slab; to be called when the slab changes.
+ */
+void explore_cache_slab_changed(MapSlabCoord slb_x, MapSlabCoord slb_y)
+{
+    // Sweeps check the slabs next to the ones they reach, hence one more
+    int radius = explore_cache.max_radius + 1;
+    MapSlabCoord start_x = max(slb_x - radius, 0);
+    MapSlabCoord end_x = min(slb_x + radius, gameadd.map_tiles_x - 1);
+    MapSlabCoord start_y = max(slb_y - radius, 0);
+    MapSlabCoord end_y = min(slb_y + radius, gameadd.map_tiles_y - 1);
+    if ((start_x > end_x) || (start_y > end_y) || (map_arena.data == NULL))
+        return;
+    for (PlayerNumber plyr_idx = 0; plyr_idx < PLAYERS_COUNT; plyr_idx++)
+    {
+        unsigned char* swept_radius = explore_cache_swept_radius(plyr_idx);
+        for (MapSlabCoord y = start_y; y <= end_y; y++)
+        {
+            SlabCodedCoords slb_num = get_slab_number(start_x, y);
+            memset(&swept_radius[slb_num], 0, end_x - start_x + 1);
+        }
+    }
+}
+
+/**
+ * Drops all sweeps of given player; to be called when the player loses revealed area.
+ */
+void explore_cache_player_concealed(PlayerNumber plyr_idx)
+{
+    if ((plyr_idx >= 0) && (plyr_idx < PLAYERS_COUNT))
+        explore_cache.player_invalid[plyr_idx] = true;
+}
+
+/**
+ * Checks if a sweep with given sight distance was already made from the slab.
+ * If it wasn't, the slab is marked as swept, as the caller will make the sweep.
+ */
+static TbBool explore_cache_sweep_done(PlayerNumber plyr_idx, MapSlabCoord slb_x, MapSlabCoord slb_y, int can_see_slabs)
+{
+    if ((plyr_idx < 0) || (plyr_idx >= PLAYERS_COUNT) || (can_see_slabs > UCHAR_MAX) || (map_arena.data == NULL))
+        return false;
+    unsigned char* swept_radius = explore_cache_swept_radius(plyr_idx);
+    if (explore_cache.player_invalid[plyr_idx])
+    {
+        memset(swept_radius, 0, map_arena.slabs_count);
+        explore_cache.player_invalid[plyr_idx] = false;
+    }
+    SlabCodedCoords slb_num = get_slab_number(slb_x, slb_y);
+    if (swept_radius[slb_num] == can_see_slabs)
+        return true;
+    swept_radius[slb_num] = can_see_slabs;
+    if (can_see_slabs > explore_cache.max_radius)
+        explore_cache.max_radius = can_see_slabs;
+    return false;
+}
+
 TbBool set_slab_explored(PlayerNumber plyr_idx, MapSlabCoord slb_x, MapSlabCoord slb_y)
 {
     if ( (plyr_idx == game.neutral_player_num) || subtile_revealed_directly(slab_subtile_center(slb_x), slab_subtile_center(slb_y), plyr_idx) )
@@ -348,6 +437,7 @@ void set_slab_explored_flags(PlayerNumber plyr_idx, MapSlabCoord slb_x, MapSlabC
         get_map_block_at(stl_x + 2, stl_y + 2)->revealed = flag;
 
         panel_map_update(stl_x, stl_y, STL_PER_SLB, STL_PER_SLB);
+        explore_cache_slab_changed(slb_x, slb_y);
     }
 }
 
@@ -718,8 +808,8 @@ static TbBool get_against(PlayerNumber agnst_plyr_idx, SlabKind agnst_slbkind, M
 void delete_column(ColumnIndex col_idx)
 {
     struct Column *col;
-    col = &game.columns_data[col_idx];
-    memcpy(col, &game.columns_data[0], sizeof(struct Column));
+    col = &map_arena.columns[col_idx];
+    memcpy(col, &map_arena.columns[0], sizeof(struct Column));
     col->use = 0;
 }
 
@@ -768,7 +858,7 @@ void copy_block_with_cube_groups(short itm_idx, MapSubtlCoord stl_x, MapSubtlCoo
       return;
     }
     struct Column col;
-    memcpy(&col, &game.columns_data[-itm_idx], sizeof(struct Column));
+    memcpy(&col, &map_arena.columns[-itm_idx], sizeof(struct Column));
     col.use = 0;
     col.bitfields &= ~0x01;
     TbBool found;
@@ -1629,6 +1719,8 @@ void dump_slab_on_map(SlabKind slbkind, long slabset_id, MapSubtlCoord stl_x, Ma
 
     slb = get_slabmap_block(slb_x, slb_y);
     slb->kind = slbkind;
+    state_hash_slab_changed(slb_x, slb_y);
+    explore_cache_slab_changed(slb_x, slb_y);
     panel_map_update(stl_xa, stl_ya, STL_PER_SLB, STL_PER_SLB);
     if (slab_kind_is_animated(slbkind) && !slab_kind_is_door(slbkind))
     {
@@ -1791,6 +1883,8 @@ void place_slab_type_on_map_f(SlabKind nslab, MapSubtlCoord stl_x, MapSubtlCoord
                   slb->kind = SlbT_EARTH;
               else
                   slb->kind = SlbT_TORCHDIRT;
+              state_hash_slab_changed(spos_x, spos_y);
+              explore_cache_slab_changed(spos_x, spos_y);
           }
       }
     } else
@@ -1805,6 +1899,8 @@ void place_slab_type_on_map_f(SlabKind nslab, MapSubtlCoord stl_x, MapSubtlCoord
           if (!slab_kind_is_animated(slb->kind))
           {
               slb->kind = alter_rock_style(slb->kind, spos_x, spos_y, owner);
+              state_hash_slab_changed(spos_x, spos_y);
+              explore_cache_slab_changed(spos_x, spos_y);
           }
       }
     }
@@ -2500,8 +2596,11 @@ void check_map_explored(struct Thing *creatng, MapSubtlCoord stl_x, MapSubtlCoor
     can_see_slabs = get_explore_sight_distance_in_slabs(creatng);
     if (can_see_slabs > 0)
     {
-        clear_dig_and_set_explored_can_see_x(slb_x, slb_y, creatng->owner, can_see_slabs);
-        clear_dig_and_set_explored_can_see_y(slb_x, slb_y, creatng->owner, can_see_slabs);
+        if (!explore_cache_sweep_done(creatng->owner, slb_x, slb_y, can_see_slabs))
+        {
+            clear_dig_and_set_explored_can_see_x(slb_x, slb_y, creatng->owner, can_see_slabs);
+            clear_dig_and_set_explored_can_see_y(slb_x, slb_y, creatng->owner, can_see_slabs);
+        }
         if (!player_cannot_win(creatng->owner) && (!flag_is_set(get_creature_model_flags(creatng),CMF_IsSpectator)) && (!player_is_roaming(creatng->owner)))
         {
             claim_neutral_creatures_in_sight(creatng, &pos, can_see_slabs);
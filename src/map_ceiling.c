@@ -24,6 +24,7 @@
 #include "front_simple.h"
 #include "globals.h"
 #include "game_legacy.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -31,7 +32,6 @@ extern "C"
 {
 #endif
 
-static char ceiling_cache[MAX_SUBTILES_X*MAX_SUBTILES_Y];
 
 static int find_column_height_including_lintels(struct Column *col)
 {
@@ -181,7 +181,7 @@ void ceiling_partially_recompute_heights(MapSubtlCoord sx, MapSubtlCoord sy, Map
         while (cstl_x < solid_check_end_stl_x)
         {
             SubtlCodedCoords stl_num = get_subtile_number(cstl_x,cstl_y);
-            ceiling_cache[stl_num] = ceiling_block_is_solid_including_corners_return_height(stl_num,cstl_x,cstl_y);
+            map_arena.ceiling_cache[stl_num] = ceiling_block_is_solid_including_corners_return_height(stl_num,cstl_x,cstl_y);
             cstl_x++;
         }
         cstl_y++;
@@ -194,7 +194,7 @@ void ceiling_partially_recompute_heights(MapSubtlCoord sx, MapSubtlCoord sy, Map
         while (unk_end_stl_x > unk_stl_x)
         {
             SubtlCodedCoords stl_num2 = get_subtile_number(unk_stl_x,unk_stl_y);
-            ceiling_height = ceiling_cache[stl_num2];
+            ceiling_height = map_arena.ceiling_cache[stl_num2];
             v38 = ceiling_height;
             if (ceiling_height <= -1)
             {
@@ -209,7 +209,7 @@ void ceiling_partially_recompute_heights(MapSubtlCoord sx, MapSubtlCoord sy, Map
                         unk2_stl_y = unk_stl_y + spir->v;
                         if (unk2_stl_x >= 0 && unk2_stl_x < gameadd.map_subtiles_x && unk2_stl_y >= 0 && unk2_stl_y < gameadd.map_subtiles_y)
                         {
-                            v27 = ceiling_cache[get_subtile_number(unk2_stl_x ,unk2_stl_y)];
+                            v27 = map_arena.ceiling_cache[get_subtile_number(unk2_stl_x ,unk2_stl_y)];
                             if (v27 > -1)
                                 break;
                         }
@@ -23,6 +23,7 @@
 #include "config_terrain.h"
 #include "slab_data.h"
 #include "game_legacy.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -349,7 +350,7 @@ long create_column(struct Column *col)
 
     // Find an empty column
     result = 1;
-    dst = &game.columns_data[1];
+    dst = &map_arena.columns[1];
     while (dst->use || dst->bitfields & CLF_ACTIVE )
     {
         ++result;
@@ -411,13 +412,28 @@ long create_column(struct Column *col)
     return result;
 }
 
+/**
+ * Points the columns lookup at column data of the map arrays.
+ * Needs to be called when the arrays are allocated, and when game structure is replaced.
+ */
+void init_columns_lookup(void)
+{
+    for (long i = 0; i < COLUMNS_COUNT; i++)
+    {
+        game.columns.lookup[i] = (map_arena.columns != NULL) ? &map_arena.columns[i] : NULL;
+    }
+    game.columns.end = (map_arena.columns != NULL) ? &map_arena.columns[COLUMNS_COUNT] : NULL;
+}
+
 void clear_columns(void)
 {
   struct Column *colmn;
   int i;
+  if (map_arena.data == NULL)
+    return;
   for (i=0; i < COLUMNS_COUNT; i++)
   {
-    colmn = &game.columns_data[i];
+    colmn = &map_arena.columns[i];
     memset(colmn, 0, sizeof(struct Column));
     colmn->floor_texture = 1;
     make_solidmask(colmn);
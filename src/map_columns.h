@@ -64,6 +64,7 @@ struct Column *get_column(long idx);
 TbBool column_invalid(const struct Column *col);
 
 void make_solidmask(struct Column *col);
+void init_columns_lookup(void);
 void clear_columns(void);
 void init_columns(void);
 long find_column(struct Column *col);
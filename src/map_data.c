@@ -28,6 +28,7 @@
 #include "map_blocks.h"
 #include "map_utils.h"
 #include "room_util.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -72,14 +73,14 @@ struct Map *get_map_block_at(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
       return INVALID_MAP_BLOCK;
   if ((stl_y < 0) || (stl_y > gameadd.map_subtiles_y))
       return INVALID_MAP_BLOCK;
-  return &game.map[get_subtile_number(stl_x,stl_y)];
+  return &map_arena.map[get_subtile_number(stl_x,stl_y)];
 }
 
 struct Map *get_map_block_at_pos(SubtlCodedCoords stl_num)
 {
   if ((stl_num < 0) || (stl_num > get_subtile_number(gameadd.map_subtiles_x,gameadd.map_subtiles_y)))
       return INVALID_MAP_BLOCK;
-  return &game.map[stl_num];
+  return &map_arena.map[stl_num];
 }
 
 TbBool map_block_invalid(const struct Map *map)
@@ -88,7 +89,7 @@ TbBool map_block_invalid(const struct Map *map)
     return true;
   if (map == INVALID_MAP_BLOCK)
     return true;
-  return (map < &game.map[0]);
+  return (map < &map_arena.map[0]);
 }
 
 NavColour get_navigation_map(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
@@ -97,7 +98,7 @@ NavColour get_navigation_map(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
       return 0;
   if ((stl_y < 0) || (stl_y > gameadd.map_subtiles_y))
       return 0;
-  return game.navigation_map[navmap_tile_number(stl_x,stl_y)];
+  return map_arena.navigation_map[navmap_tile_number(stl_x,stl_y)];
 }
 
 void set_navigation_map(MapSubtlCoord stl_x, MapSubtlCoord stl_y, NavColour navcolour)
@@ -106,7 +107,7 @@ void set_navigation_map(MapSubtlCoord stl_x, MapSubtlCoord stl_y, NavColour navc
       return;
   if ((stl_y < 0) || (stl_y > gameadd.map_subtiles_y))
       return;
-  game.navigation_map[navmap_tile_number(stl_x,stl_y)] = navcolour;
+  map_arena.navigation_map[navmap_tile_number(stl_x,stl_y)] = navcolour;
 }
 
 unsigned long get_navigation_map_floor_height(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
@@ -117,7 +118,7 @@ unsigned long get_navigation_map_floor_height(MapSubtlCoord stl_x, MapSubtlCoord
 long get_ceiling_height(const struct Coord3d *pos)
 {
     long i = get_subtile_number(pos->x.stl.num, pos->y.stl.num);
-    return game.map[i].filled_subtiles * COORD_PER_STL;
+    return map_arena.map[i].filled_subtiles * COORD_PER_STL;
 }
 
 ThingIndex get_mapwho_thing_index(const struct Map *mapblk)
@@ -211,6 +212,7 @@ void reveal_map_block(struct Map *mapblk, PlayerNumber plyr_idx)
 void conceal_map_block(struct Map *mapblk, PlayerNumber plyr_idx)
 {
     clear_flag(mapblk->revealed, to_flag(plyr_idx));
+    explore_cache_player_concealed(plyr_idx);
 }
 
 TbBool slabs_reveal_slab_and_corners(MapSlabCoord slab_x, MapSlabCoord slab_y, MaxCoordFilterParam param)
@@ -311,8 +313,8 @@ TbBool slabs_change_texture(MapSlabCoord slb_x, MapSlabCoord slb_y, MaxCoordFilt
     if (slabs_iter_will_change(orig_slab_kind, current_kind, fill_type))
     {
         SlabCodedCoords slb_num = get_slab_number(slb_x, slb_y);
-        gameadd.slab_ext_data[slb_num] = target_slab_texture;
-        gameadd.slab_ext_data_initial[slb_num] = target_slab_texture;
+        map_arena.slab_ext_data[slb_num] = target_slab_texture;
+        map_arena.slab_ext_data_initial[slb_num] = target_slab_texture;
         return true;
     }
     return false;
@@ -557,11 +559,13 @@ MapSubtlCoord stl_slab_ending_subtile(MapSubtlCoord stl_v)
 
 void clear_mapwho(void)
 {
+    if (map_arena.data == NULL)
+        return;
     for (MapSubtlCoord y = 0; y < (gameadd.map_subtiles_y + 1); y++)
     {
         for (MapSubtlCoord x = 0; x < (gameadd.map_subtiles_x + 1); x++)
         {
-            struct Map* mapblk = &game.map[get_subtile_number(x, y)];
+            struct Map* mapblk = &map_arena.map[get_subtile_number(x, y)];
             mapblk->mapwho = 0;
         }
   }
@@ -569,12 +573,14 @@ void clear_mapwho(void)
 
 void clear_mapmap(void)
 {
+    if (map_arena.data == NULL)
+        return;
     for (unsigned long y = 0; y < (gameadd.map_subtiles_y + 1); y++)
     {
         for (unsigned long x = 0; x < (gameadd.map_subtiles_x + 1); x++)
         {
             struct Map* mapblk = get_map_block_at(x, y);
-            NavColour* flg = &game.navigation_map[get_subtile_number(x, y)];
+            NavColour* flg = &map_arena.navigation_map[get_subtile_number(x, y)];
             memset(mapblk, 0, sizeof(struct Map));
             *flg = 0;
         }
@@ -835,6 +841,21 @@ TbBool subtile_is_diggable_for_player(PlayerNumber plyr_idx, MapSubtlCoord stl_x
 
 void set_map_size(MapSlabCoord x,MapSlabCoord y)
 {
+    if ((x < 1) || (x > MAX_TILES_X) || (y < 1) || (y > MAX_TILES_Y))
+    {
+        ERRORLOG("Map size %dx%d out of range, using default",(int)x,(int)y);
+        x = DEFAULT_MAP_SIZE;
+        y = DEFAULT_MAP_SIZE;
+    }
+    // World arrays are sized for the map; new ones need to be cleared
+    if (!map_arena_alloc(x, y))
+    {
+        ERRORLOG("Cannot allocate map of %dx%d slabs, using default size",(int)x,(int)y);
+        x = DEFAULT_MAP_SIZE;
+        y = DEFAULT_MAP_SIZE;
+        if (!map_arena_alloc(x, y))
+            return;
+    }
     gameadd.map_subtiles_x = x * STL_PER_SLB;
     gameadd.map_subtiles_y = y * STL_PER_SLB;
     gameadd.map_tiles_x = x;
@@ -877,6 +898,8 @@ void set_map_size(MapSlabCoord x,MapSlabCoord y)
     gameadd.around_map[7] = gameadd.map_subtiles_x + 1;
     gameadd.around_map[8] = gameadd.map_subtiles_x + 2;
 
+    clear_mapmap();
+    clear_slabs();
 }
 
 void init_map_size(LevelNumber lvnum)
@@ -44,6 +44,132 @@
 extern "C" {
 #endif
 
+/******************************************************************************/
+/**
+ * Lists of existing events, derived from game.event so that lookups don't need to sweep
+ * the whole array. Both lists are kept sorted by event index, so they give the same results
+ * as sweeping the array. Rebuilt on first use after being invalidated.
+ */
+struct EventsIndex {
+    /** First existing event, and next existing event for every event. */
+    EventIndex first_live;
+    EventIndex next_live[EVENTS_COUNT];
+    /** First event of given kind owned by given player, and next event of the same owner and kind. */
+    EventIndex first_of_kind[DUNGEONS_COUNT][EVENT_KIND_COUNT];
+    EventIndex next_of_kind[EVENTS_COUNT];
+    /** Owner and kind the event is listed under, or zero kind if not listed. */
+    unsigned char owner[EVENTS_COUNT];
+    unsigned char kind[EVENTS_COUNT];
+    TbBool valid;
+};
+
+static struct EventsIndex events_index;
+/******************************************************************************/
+static TbBool event_index_kind_listable(PlayerNumber plyr_idx, EventKind evkind)
+{
+    return (plyr_idx >= 0) && (plyr_idx < DUNGEONS_COUNT) && (evkind > 0) && (evkind < EVENT_KIND_COUNT);
+}
+
+/** Inserts event into a list, keeping the list sorted by event index. */
+static void event_index_insert_sorted(EventIndex *first, EventIndex *next, EventIndex evidx)
+{
+    EventIndex* link = first;
+    while ((*link != 0) && (*link < evidx))
+        link = &next[*link];
+    next[evidx] = *link;
+    *link = evidx;
+}
+
+static void event_index_remove(EventIndex *first, EventIndex *next, EventIndex evidx)
+{
+    EventIndex* link = first;
+    while ((*link != 0) && (*link != evidx))
+        link = &next[*link];
+    if (*link == evidx)
+        *link = next[evidx];
+    next[evidx] = 0;
+}
+
+static void event_index_unlink(EventIndex evidx)
+{
+    struct EventsIndex* evidxs = &events_index;
+    if (evidxs->kind[evidx] == 0)
+        return;
+    if (event_index_kind_listable(evidxs->owner[evidx], evidxs->kind[evidx]))
+        event_index_remove(&evidxs->first_of_kind[evidxs->owner[evidx]][evidxs->kind[evidx]], evidxs->next_of_kind, evidx);
+    event_index_remove(&evidxs->first_live, evidxs->next_live, evidx);
+    evidxs->owner[evidx] = 0;
+    evidxs->kind[evidx] = 0;
+}
+
+static void event_index_link(EventIndex evidx)
+{
+    struct EventsIndex* evidxs = &events_index;
+    const struct Event* event = &game.event[evidx];
+    if ((evidxs->kind[evidx] != 0) && (evidxs->owner[evidx] == event->owner) && (evidxs->kind[evidx] == event->kind))
+        return;
+    event_index_unlink(evidx);
+    if (event->kind == 0)
+        return;
+    event_index_insert_sorted(&evidxs->first_live, evidxs->next_live, evidx);
+    if (event_index_kind_listable(event->owner, event->kind))
+        event_index_insert_sorted(&evidxs->first_of_kind[event->owner][event->kind], evidxs->next_of_kind, evidx);
+    evidxs->owner[evidx] = event->owner;
+    evidxs->kind[evidx] = event->kind;
+}
+
+/**
+ * Marks the events index as outdated; needs to be called when game.event is replaced.
+ */
+void clear_events_index(void)
+{
+    events_index.valid = false;
+}
+
+static void events_index_update(void)
+{
+    struct EventsIndex* evidxs = &events_index;
+    if (evidxs->valid)
+        return;
+    memset(evidxs, 0, sizeof(struct EventsIndex));
+    // Going backwards, so that inserting keeps lists sorted without sweeping them
+    for (EventIndex i = EVENTS_COUNT-1; i > 0; i--)
+    {
+        const struct Event* event = &game.event[i];
+        if (((event->flags & EvF_Exists) == 0) || (event->kind == 0))
+            continue;
+        evidxs->next_live[i] = evidxs->first_live;
+        evidxs->first_live = i;
+        if (event_index_kind_listable(event->owner, event->kind))
+        {
+            evidxs->next_of_kind[i] = evidxs->first_of_kind[event->owner][event->kind];
+            evidxs->first_of_kind[event->owner][event->kind] = i;
+        }
+        evidxs->owner[i] = event->owner;
+        evidxs->kind[i] = event->kind;
+    }
+    evidxs->valid = true;
+}
+
+/**
+ * Returns first event in the list of events of given kind owned by given player.
+ * For unusual owners, which have no list, a sweep of all existing events is needed.
+ */
+static EventIndex events_index_first_of_kind(EventKind evkind, PlayerNumber plyr_idx, TbBool *all_events)
+{
+    events_index_update();
+    *all_events = !event_index_kind_listable(plyr_idx, evkind);
+    if (*all_events)
+        return events_index.first_live;
+    return events_index.first_of_kind[plyr_idx][evkind];
+}
+
+static EventIndex events_index_next(EventIndex evidx, TbBool all_events)
+{
+    if (all_events)
+        return events_index.next_live[evidx];
+    return events_index.next_of_kind[evidx];
+}
 /******************************************************************************/
 TbBool event_is_invalid(const struct Event *event)
 {
@@ -52,7 +178,8 @@ TbBool event_is_invalid(const struct Event *event)
 
 struct Event *get_event_nearby_of_type_for_player(MapCoord map_x, MapCoord map_y, long max_dist, EventKind evkind, PlayerNumber plyr_idx)
 {
-    for (int i = 1; i < EVENTS_COUNT; i++)
+    TbBool all_events;
+    for (EventIndex i = events_index_first_of_kind(evkind, plyr_idx, &all_events); i != 0; i = events_index_next(i, all_events))
     {
         struct Event* event = &game.event[i];
         if (((event->flags & EvF_Exists) != 0) && (event->owner == plyr_idx) && (event->kind == evkind)
@@ -65,7 +192,8 @@ struct Event *get_event_nearby_of_type_for_player(MapCoord map_x, MapCoord map_y
 
 struct Event *get_event_of_target_and_type_for_player(long target, EventKind evkind, PlayerNumber plyr_idx)
 {
-    for (int i = 1; i < EVENTS_COUNT; i++)
+    TbBool all_events;
+    for (EventIndex i = events_index_first_of_kind(evkind, plyr_idx, &all_events); i != 0; i = events_index_next(i, all_events))
     {
         struct Event* event = &game.event[i];
         if (((event->flags & EvF_Exists) != 0) && (event->owner == plyr_idx) && (event->kind == evkind)
@@ -78,7 +206,8 @@ struct Event *get_event_of_target_and_type_for_player(long target, EventKind evk
 
 struct Event *get_event_of_type_for_player(EventKind evkind, PlayerNumber plyr_idx)
 {
-    for (int i = 1; i < EVENTS_COUNT; i++)
+    TbBool all_events;
+    for (EventIndex i = events_index_first_of_kind(evkind, plyr_idx, &all_events); i != 0; i = events_index_next(i, all_events))
     {
         struct Event* event = &game.event[i];
         if (((event->flags & EvF_Exists) != 0) && (event->owner == plyr_idx) && (event->kind == evkind)) {
@@ -245,10 +374,14 @@ void event_initialise_event(struct Event *event, MapCoord map_x, MapCoord map_y,
     event->lifespan_turns = event_button_info[evkind].lifespan_turns;
     event->target = target;
     event->flags |= EvF_BtnFirstFall;
+    if (events_index.valid)
+        event_index_link(event - &game.event[0]);
 }
 
 void event_delete_event_structure(long ev_idx)
 {
+    if (events_index.valid)
+        event_index_unlink(ev_idx);
     memset(&game.event[ev_idx], 0, sizeof(struct Event));
 }
 
@@ -286,7 +419,8 @@ void event_delete_event(long plyr_idx, EventIndex evidx)
 
 void event_update_on_battle_removal(void)
 {
-    for (long i = 0; i < EVENTS_COUNT; i++)
+    events_index_update();
+    for (EventIndex i = events_index.first_live; i != 0; i = events_index.next_live[i])
     {
         struct Event* event = &game.event[i];
         if ((event->kind == EvKind_FriendlyFight) || (event->kind == EvKind_EnemyFight))
@@ -739,8 +873,12 @@ struct Thing *event_is_attached_to_thing(EventIndex evidx)
 
 void event_process_events(void)
 {
-    for (long i = 0; i < EVENTS_COUNT; i++)
+    events_index_update();
+    EventIndex next_idx;
+    for (EventIndex i = events_index.first_live; i != 0; i = next_idx)
     {
+        // The event may be deleted below
+        next_idx = events_index.next_live[i];
         struct Event* event = &game.event[i];
         if ((event->flags & EvF_Exists) == 0) {
             continue;
@@ -801,8 +939,11 @@ void event_kill_all_players_events(long plyr_idx)
 {
     SYNCDBG(8,"Starting");
     TbBool keep_objective = gameadd.heart_lost_display_message;
-    for (int i = 1; i < EVENTS_COUNT; i++)
+    events_index_update();
+    EventIndex next_idx;
+    for (EventIndex i = events_index.first_live; i != 0; i = next_idx)
     {
+        next_idx = events_index.next_live[i];
         struct Event* event = &game.event[i];
         if (((event->flags & EvF_Exists) != 0) && (event->owner == plyr_idx)) {
             if (keep_objective)
@@ -823,8 +964,11 @@ void event_kill_all_players_events(long plyr_idx)
 void remove_events_thing_is_attached_to(struct Thing *thing)
 {
     SYNCDBG(8,"Starting");
-    for (int i = 1; i < EVENTS_COUNT; i++)
+    events_index_update();
+    EventIndex next_idx;
+    for (EventIndex i = events_index.first_live; i != 0; i = next_idx)
     {
+        next_idx = events_index.next_live[i];
         struct Event* event = &game.event[i];
         if (((event->flags & EvF_Exists) != 0) && (event->kind != EvKind_Objective))
         {
@@ -846,6 +990,7 @@ void clear_events(void)
     {
       memset(&game.event[i], 0, sizeof(struct Event));
     }
+    clear_events_index();
     memset(&game.evntbox_scroll_window, 0, sizeof(struct TextScrollWindow));
     memset(&game.evntbox_text_buffer, 0, MESSAGE_TEXT_LEN);
     memset(&game.evntbox_text_objective, 0, MESSAGE_TEXT_LEN);
@@ -0,0 +1,339 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file net_rollback.c
+ *     Input prediction and rollback for network games.
+ * @par Purpose:
+ *     Lets network clients simulate turns before the server frame arrives.
+ *     Packets of other players are predicted by repeating their last input;
+ *     when the server frame differs from prediction, the game state is
+ *     restored and the turns are simulated again, without sounds.
+ * @par Comment:
+ *     Packet checksums are delayed by ROLLBACK_MAX_TURNS turns in this mode,
+ *     so that they always describe a confirmed state. All players have to
+ *     use the same mode.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#include "pre_inc.h"
+#include "net_rollback.h"
+
+#include "globals.h"
+#include "bflib_basics.h"
+#include "bflib_network.h"
+#include "bflib_rollback.h"
+#include "bflib_sound.h"
+
+#include "api.h"
+#include "game_legacy.h"
+#include "sim_context.h"
+#include "net_game.h"
+#include "net_sync.h"
+#include "packets.h"
+#include "player_data.h"
+#include "keeperfx.hpp"
+#include "post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+/** Time to wait for the server when no more turns may be predicted, before the turn is stalled. */
+#define ROLLBACK_SERVER_TIMEOUT_IN_MS 50
+/** Mouse button flags which are set only for a single turn. */
+#define ROLLBACK_ONE_TURN_CONTROLS (PCtr_LBtnClick|PCtr_RBtnClick|PCtr_LBtnRelease|PCtr_RBtnRelease)
+/** Mouse button flags with which the cursor position is used by the simulation. */
+#define ROLLBACK_CURSOR_CONTROLS (PCtr_LBtnAnyAction|PCtr_RBtnAnyAction)
+/******************************************************************************/
+static struct TbRollback net_rollback;
+static TbBool net_rollback_started = false;
+static TbBool net_rollback_predicted = false;
+/** Set while the turn waits for the server, as no more turns may be predicted. */
+static TbBool net_rollback_stalled = false;
+/** Local packet of the stalled turn; it was already sent, so it's used when the turn is finally simulated. */
+static struct Packet stalled_packet;
+/** Set when resync gave a state which already has packets of the next simulated turn applied. */
+static TbBool net_rollback_packets_applied = false;
+static struct Packet confirmed_packets[PACKETS_COUNT];
+/** Game turn at the start of recent rollback turns, indexed by rollback turn modulo the array size. */
+static GameTurn rollback_gameturns[ROLLBACK_HISTORY_TURNS];
+/******************************************************************************/
+/**
+ * Simulates a turn again. Only the game world is updated; sounds and
+ * speech were played when the turn was predicted.
+ */
+static void rollback_simulate_turn(const void *inputs)
+{
+    memcpy(game.packets, inputs, sizeof(game.packets));
+    rollback_gameturns[net_rollback.resimulated_turn % ROLLBACK_HISTORY_TURNS] = game.play_gameturn;
+    TbBool sound_disabled = SoundDisabled;
+    SoundDisabled = true;
+    if (net_rollback_packets_applied)
+    {
+        net_rollback_packets_applied = false;
+        clear_packets();
+    } else
+    {
+        process_packets();
+    }
+    if (!quit_game && !exit_keeper)
+    {
+        update_game_world();
+    }
+    SoundDisabled = sound_disabled;
+}
+
+/**
+ * Predicts the packet by repeating last input of the player. Only the state
+ * of controls is repeated; actions and clicks are unlikely to happen again.
+ * Cursor position is repeated too, but it's not a part of the prediction
+ * which has to be right - see rollback_packets_equal().
+ */
+static void rollback_predict_packet(void *input, const void *last_input)
+{
+    struct Packet* pckt = (struct Packet *)input;
+    const struct Packet* last_pckt = (const struct Packet *)last_input;
+    memset(pckt, 0, sizeof(struct Packet));
+    pckt->pos_x = last_pckt->pos_x;
+    pckt->pos_y = last_pckt->pos_y;
+    pckt->control_flags = last_pckt->control_flags & ~ROLLBACK_ONE_TURN_CONTROLS;
+    pckt->additional_packet_values = last_pckt->additional_packet_values;
+}
+
+/**
+ * Returns whether the simulation acts at the packet cursor position.
+ * Just moving the cursor over the map doesn't change the game.
+ */
+static TbBool rollback_packet_cursor_used(const struct Packet *pckt)
+{
+    if ((pckt->control_flags & ROLLBACK_CURSOR_CONTROLS) != 0)
+        return true;
+    // Without map coordinates, the position is turning of a possessed creature
+    return ((pckt->control_flags & PCtr_MapCoordsValid) == 0) && ((pckt->pos_x != 0) || (pckt->pos_y != 0));
+}
+
+static TbBool rollback_packets_equal(const void *input1, const void *input2)
+{
+    const struct Packet* pckt1 = (const struct Packet *)input1;
+    const struct Packet* pckt2 = (const struct Packet *)input2;
+    // Checksum is not an input, it doesn't affect the simulation
+    if ((pckt1->action != pckt2->action) || (pckt1->actn_par1 != pckt2->actn_par1)
+        || (pckt1->actn_par2 != pckt2->actn_par2) || (pckt1->actn_par3 != pckt2->actn_par3)
+        || (pckt1->actn_par4 != pckt2->actn_par4) || (pckt1->control_flags != pckt2->control_flags)
+        || (pckt1->additional_packet_values != pckt2->additional_packet_values))
+        return false;
+    if (rollback_packet_cursor_used(pckt1) || rollback_packet_cursor_used(pckt2))
+        return (pckt1->pos_x == pckt2->pos_x) && (pckt1->pos_y == pckt2->pos_y);
+    return true;
+}
+
+static unsigned long rollback_turn_checksum(void)
+{
+    struct PlayerInfo* player = get_my_player();
+    return get_packet_direct(player->packet_num)->chksum;
+}
+
+static void rollback_before_save(void)
+{
+    sim_world_export_state();
+}
+
+/**
+ * Rebuilds what's derived from the restored world.
+ */
+static void rollback_after_restore(void)
+{
+    sim_world_rebuild_derived();
+    // Events of the turns being undone are raised again when simulating them
+    api_discard_events(game.play_gameturn);
+}
+
+/**
+ * Starts rollback for a new network level, if enabled by command line.
+ */
+void network_rollback_start(void)
+{
+    network_rollback_stop();
+    if (!start_params.network_rollback || (game.game_kind == GKind_LocalGame) || game.packet_load_enable)
+        return;
+    struct TbRollbackRegion regions[SIM_WORLD_REGIONS_COUNT];
+    int regions_count = sim_world_regions(regions, SIM_WORLD_REGIONS_COUNT);
+    struct TbRollbackCallbacks callbacks = {
+        rollback_simulate_turn,
+        rollback_predict_packet,
+        rollback_packets_equal,
+        rollback_turn_checksum,
+        rollback_before_save,
+        rollback_after_restore,
+    };
+    struct PlayerInfo* player = get_my_player();
+    if (!LbRollbackInit(&net_rollback, regions, regions_count,
+        sizeof(struct Packet), PACKETS_COUNT, player->packet_num, &callbacks))
+    {
+        WARNLOG("Rollback disabled, playing in lockstep");
+        return;
+    }
+    if (game.packet_save_enable && !LbNetwork_IsServer())
+    {
+        WARNLOG("Packets are not recorded on clients which simulate ahead; record on the host");
+    }
+    net_rollback_started = true;
+    NETLOG("Rollback started, up to %d turns ahead", ROLLBACK_MAX_TURNS);
+}
+
+void network_rollback_stop(void)
+{
+    if (!net_rollback_started)
+        return;
+    NETLOG("Rollback finished, %lu turns simulated again", net_rollback.resimulated_turns);
+    LbRollbackFree(&net_rollback);
+    net_rollback_started = false;
+    net_rollback_predicted = false;
+    net_rollback_stalled = false;
+    net_rollback_packets_applied = false;
+    // Events of turns which were never confirmed
+    api_discard_events(0);
+}
+
+TbBool network_rollback_active(void)
+{
+    return net_rollback_started;
+}
+
+TbBool network_rollback_resimulating(void)
+{
+    return net_rollback_started && net_rollback.resimulating;
+}
+
+/**
+ * Returns whether the current turn has to wait for the server, and can't be simulated yet.
+ */
+TbBool network_rollback_stalled(void)
+{
+    return net_rollback_started && net_rollback_stalled;
+}
+
+/**
+ * Returns whether packets of the current turn contain predicted input.
+ */
+TbBool network_rollback_turn_predicted(void)
+{
+    return net_rollback_started && net_rollback_predicted;
+}
+
+/**
+ * Returns the first game turn which may still be simulated again.
+ * Results of all earlier turns, including the one being simulated
+ * if it is not predicted, are final.
+ */
+GameTurn network_rollback_unconfirmed_gameturn(void)
+{
+    if (!net_rollback_started || (net_rollback.pending_count <= 0))
+        return game.play_gameturn + 1;
+    unsigned long turn = net_rollback.next_turn - net_rollback.pending_count;
+    return rollback_gameturns[turn % ROLLBACK_HISTORY_TURNS];
+}
+
+static void rollback_confirm_packets(void)
+{
+    if (packets_checksums_different(confirmed_packets))
+    {
+        SYNCDBG(0,"Resyncing");
+        resync_game();
+        // Server resyncs after processing packets of the confirmed turn; the turn is continued from there
+        if (net_rollback.pending_count > 0)
+        {
+            LbRollbackRebase(&net_rollback);
+            net_rollback_packets_applied = true;
+        }
+    }
+    store_localised_game_structure();
+    int resimulated = LbRollbackConfirmTurn(&net_rollback, confirmed_packets);
+    if (resimulated > 0)
+    {
+        recall_localised_game_structure();
+        SYNCDBG(7,"Misprediction, simulated %d turns again",resimulated);
+    } else
+    if (resimulated < 0)
+    {
+        WARNLOG("Server frame received with no turn waiting for it");
+    }
+}
+
+/**
+ * Exchanges packets in rollback mode. The server works in lockstep, as it
+ * is the source of confirmed input; clients send their packet, apply
+ * any server frames which arrived, and then continue with predicted packets.
+ * When no more turns may be predicted, the turn is stalled until a server
+ * frame arrives - see network_rollback_stalled(); a turn which rollback
+ * doesn't track is never simulated.
+ */
+void network_rollback_exchange(struct Packet *pckt)
+{
+    if (!net_rollback_stalled)
+    {
+        LbRollbackTurnDone(&net_rollback);
+        pckt->chksum = LbRollbackDelayedChecksum(&net_rollback);
+    }
+    if (LbNetwork_IsServer())
+    {
+        if (LbNetwork_Exchange(pckt, game.packets, sizeof(struct Packet)) != 0)
+        {
+            ERRORLOG("LbNetwork_Exchange failed");
+        }
+        LbRollbackConfirmedTurn(&net_rollback, game.packets);
+        net_rollback_predicted = false;
+        return;
+    }
+    struct Packet local_pckt;
+    if (net_rollback_stalled)
+    {
+        // The packet of this turn was sent when it stalled
+        memcpy(&local_pckt, &stalled_packet, sizeof(struct Packet));
+    } else
+    {
+        memcpy(&local_pckt, pckt, sizeof(struct Packet));
+        if (LbNetwork_SendFrame(pckt, sizeof(struct Packet)) != Lb_OK)
+        {
+            ERRORLOG("LbNetwork_SendFrame failed");
+        }
+    }
+    while (1)
+    {
+        // When the prediction window is full, we have to wait for the server
+        unsigned timeout = (net_rollback.pending_count >= ROLLBACK_MAX_TURNS) ? ROLLBACK_SERVER_TIMEOUT_IN_MS : 1;
+        memset(confirmed_packets, 0, sizeof(confirmed_packets));
+        if (!LbNetwork_ReceiveFrame(confirmed_packets, sizeof(struct Packet), timeout))
+            break;
+        rollback_confirm_packets();
+    }
+    // Restoring state has overwritten the packets
+    memcpy(pckt, &local_pckt, sizeof(struct Packet));
+    rollback_gameturns[net_rollback.next_turn % ROLLBACK_HISTORY_TURNS] = game.play_gameturn;
+    net_rollback_predicted = LbRollbackPredictTurn(&net_rollback, game.packets);
+    if (!net_rollback_predicted)
+    {
+        if (!net_rollback_stalled)
+        {
+            WARNLOG("No frame from server for %d turns, waiting",ROLLBACK_MAX_TURNS);
+            memcpy(&stalled_packet, &local_pckt, sizeof(struct Packet));
+        }
+        net_rollback_stalled = true;
+        return;
+    }
+    if (net_rollback_stalled)
+    {
+        NETLOG("Server frame arrived, continuing");
+        net_rollback_stalled = false;
+    }
+}
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file net_rollback.h
+ *     Header file for net_rollback.c.
+ * @par Purpose:
+ *     Input prediction and rollback for network games.
+ * @par Comment:
+ *     Just a header file - #defines, typedefs, function prototypes etc.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#ifndef DK_NETROLLBACK_H
+#define DK_NETROLLBACK_H
+
+#include "globals.h"
+#include "bflib_basics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+struct Packet;
+
+void network_rollback_start(void);
+void network_rollback_stop(void);
+TbBool network_rollback_active(void);
+TbBool network_rollback_resimulating(void);
+TbBool network_rollback_stalled(void);
+TbBool network_rollback_turn_predicted(void);
+GameTurn network_rollback_unconfirmed_gameturn(void);
+void network_rollback_exchange(struct Packet *pckt);
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -35,6 +35,17 @@
 #include "keeperfx.hpp"
 #include "frontend.h"
 #include "thing_effects.h"
+#include "thing_data.h"
+#include "thing_list.h"
+#include "slab_data.h"
+#include "room_data.h"
+#include "room_list.h"
+#include "dungeon_data.h"
+#include "player_computer.h"
+#include "packets.h"
+#include "map_arena.h"
+#include "sim_context.h"
+#include "net_rollback.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -65,6 +76,43 @@ struct Boing {
 /** Structure used for storing 'localised parameters' when resyncing net game. */
 struct Boing boing;
 /******************************************************************************/
+// Game state hash.
+// The hash is a sum of per-subsystem hashes. Things and slabs keep the last
+// hash of every entity, so that a change only needs the difference to be
+// applied; small subsystems (rooms, dungeons, players) are summed every turn.
+// Hashes of slabs are kept within the map arrays, as their amount depends on the map.
+#define STATE_HASH_BUCKETS 64
+
+struct StateHash {
+    TbBigChecksum sub_hash[SHK_ListEnd];
+    TbBigChecksum thing_hash[THINGS_COUNT];
+    unsigned char thing_kind[THINGS_COUNT];
+};
+
+/** Values exchanged in one network frame; no larger than a packet, so a server frame with all players fits the message buffer. */
+#define STATE_HASH_CHUNK_VALUES (sizeof(struct Packet) / sizeof(TbBigChecksum))
+
+/** Data exchanged between players when looking for the source of desync. */
+struct StateHashReport {
+    TbBigChecksum values[STATE_HASH_BUCKETS];
+};
+
+/** Part of the report which is sent in a single exchange. */
+struct StateHashReportChunk {
+    TbBigChecksum values[STATE_HASH_CHUNK_VALUES];
+};
+
+static struct StateHash state_hash;
+static struct StateHashReport state_hash_reports[NET_PLAYERS_COUNT];
+static struct StateHashReportChunk state_hash_chunks[NET_PLAYERS_COUNT];
+
+static const char *state_hash_kind_names[SHK_ListEnd] = {
+    "creatures", "things", "slabs", "rooms", "dungeons", "computer players", "players",
+};
+
+static void state_hash_report_desync(void);
+static void update_players_state_hash(void);
+/******************************************************************************/
 long get_resync_sender(void)
 {
     for (int i = 0; i < NET_PLAYERS_COUNT; i++)
@@ -88,16 +136,22 @@ TbBool send_resync_game(void)
   }
 
   LbFileWrite(fh, &game, sizeof(game));
+  LbFileWrite(fh, map_arena.data, map_arena.size);
   LbFileClose(fh);
 
   NETLOG("Initiating re-synchronization of network game");
-  return LbNetwork_Resync(&game, sizeof(game));
+  // Map arrays are outside of game structure; all players have them sized for the same map
+  if (!LbNetwork_Resync(&game, sizeof(game)))
+      return false;
+  return LbNetwork_Resync(map_arena.data, map_arena.size);
 }
 
 TbBool receive_resync_game(void)
 {
     NETLOG("Initiating re-synchronization of network game");
-    return LbNetwork_Resync(&game, sizeof(game));
+    if (!LbNetwork_Resync(&game, sizeof(game)))
+        return false;
+    return LbNetwork_Resync(map_arena.data, map_arena.size);
 }
 
 void store_localised_game_structure(void)
@@ -149,6 +203,9 @@ void resync_game(void)
     SYNCDBG(2,"Starting");
     struct PlayerInfo* player = get_my_player();
     draw_out_of_sync_box(0, 32*units_per_pixel/16, player->engine_window_x);
+    // Clients simulating ahead have game frames queued, so no other exchange is possible
+    if (!network_rollback_active())
+        state_hash_report_desync();
     reset_eye_lenses();
     store_localised_game_structure();
     int i = get_resync_sender();
@@ -161,6 +218,7 @@ void resync_game(void)
     }
     recall_localised_game_structure();
     reinit_level_after_load();
+    clear_world_caches();
     clear_flag(game.system_flags, GSF_NetGameNoSync);
     clear_flag(game.system_flags, GSF_NetSeedNoSync);
 }
@@ -172,14 +230,10 @@ void resync_game(void)
 CoroutineLoopState perform_checksum_verification(CoroutineLoop *con)
 {
     short result = true;
-    unsigned long checksum_mem = 0;
-    for (int i = 1; i < THINGS_COUNT; i++)
-    {
-        struct Thing* thing = thing_get(i);
-        if (thing_exists(thing)) {
-            checksum_mem += thing->mappos.z.val + thing->mappos.y.val + thing->mappos.x.val;
-        }
-    }
+    // Level data only; players state may legitimately differ before the game starts
+    state_hash_rebuild();
+    TbBigChecksum checksum_mem = state_hash.sub_hash[SHK_Creatures] + state_hash.sub_hash[SHK_Things]
+        + state_hash.sub_hash[SHK_Slabs] + state_hash.sub_hash[SHK_Rooms];
     clear_packets();
     struct Packet* pckt = get_packet(my_player_number);
     set_packet_action(pckt, PckA_LevelExactCheck, 0, 0, 0, 0);
@@ -215,9 +269,13 @@ TbBigChecksum compute_player_checksum(struct PlayerInfo *player)
     TbBigChecksum sum = 0;
     if (((player->allocflags & PlaF_CompCtrl) == 0) && (player->acamera != NULL))
     {
-        struct Coord3d* mappos = &(player->acamera->mappos);
         sum += (TbBigChecksum)player->instance_remain_rurns + (TbBigChecksum)player->instance_num;
-        sum += (TbBigChecksum)mappos->x.val + (TbBigChecksum)mappos->z.val + (TbBigChecksum)mappos->y.val;
+        // Parchment camera just follows the cursor, which isn't compared by rollback
+        if (player->acamera != &player->cameras[CamIV_Parchment])
+        {
+            struct Coord3d* mappos = &(player->acamera->mappos);
+            sum += (TbBigChecksum)mappos->x.val + (TbBigChecksum)mappos->z.val + (TbBigChecksum)mappos->y.val;
+        }
     }
     return sum;
 }
@@ -258,7 +316,16 @@ void player_packet_checksum_add(PlayerNumber plyr_idx, TbBigChecksum sum, const
  * Checks if all active players packets have same checksums.
  * @return Returns false if all checksums are same; true if there's mismatch.
  */
-short checksums_different()
+short checksums_different(void)
+{
+    return packets_checksums_different(game.packets);
+}
+
+/**
+ * Checks if all active players have same checksums in given set of packets.
+ * @return Returns false if all checksums are same; true if there's mismatch.
+ */
+short packets_checksums_different(const struct Packet *pckts)
 {
     TbChecksum checksum = 0;
     unsigned short is_set = false;
@@ -268,7 +335,7 @@ short checksums_different()
         struct PlayerInfo* player = get_player(i);
         if (player_exists(player) && ((player->allocflags & PlaF_CompCtrl) == 0))
         {
-            struct Packet* pckt = get_packet_direct(player->packet_num);
+            const struct Packet* pckt = &pckts[player->packet_num];
             if (!is_set)
             {
                 checksum = pckt->chksum;
@@ -324,6 +391,296 @@ TbBigChecksum get_thing_checksum(const struct Thing* thing)
     return csum * thing->index;
 }
 /******************************************************************************/
+static TbBigChecksum get_slab_checksum(SlabCodedCoords slb_num)
+{
+    struct SlabMap* slb = get_slabmap_direct(slb_num);
+    if (slabmap_block_invalid(slb))
+        return 0;
+    return ((TbBigChecksum)slb->kind + ((TbBigChecksum)slb->owner << 8)) * (slb_num + 1);
+}
+
+TbBigChecksum get_room_checksum(const struct Room *room)
+{
+    if (!room_exists(room))
+        return 0;
+    return room->slabs_count + room->central_stl_x + room->central_stl_y + room->efficiency + room->used_capacity;
+}
+
+static TbBigChecksum get_dungeon_checksum(PlayerNumber plyr_idx)
+{
+    struct Dungeon* dungeon = get_dungeon(plyr_idx);
+    if (dungeon_invalid(dungeon))
+        return 0;
+    TbBigChecksum sum = (TbBigChecksum)dungeon->total_money_owned + (TbBigChecksum)dungeon->num_active_creatrs
+        + (TbBigChecksum)dungeon->num_active_diggers + (TbBigChecksum)dungeon->total_rooms
+        + (TbBigChecksum)dungeon->research_num + (TbBigChecksum)dungeon->research_progress
+        + (TbBigChecksum)dungeon->manufacture_progress + (TbBigChecksum)dungeon->digger_stack_length;
+    return sum * (plyr_idx + 1);
+}
+
+static TbBigChecksum get_computer_checksum(PlayerNumber plyr_idx)
+{
+    struct PlayerInfo* player = get_player(plyr_idx);
+    if (!player_exists(player) || ((player->allocflags & PlaF_CompCtrl) == 0))
+        return 0;
+    struct Computer2* comp = get_computer_player(plyr_idx);
+    TbBigChecksum sum = (TbBigChecksum)comp->task_state + (TbBigChecksum)comp->tasks_did
+        + (TbBigChecksum)comp->dig_stack_size + (TbBigChecksum)comp->ongoing_process
+        + (TbBigChecksum)comp->task_idx + (TbBigChecksum)comp->held_thing_idx;
+    return sum * (plyr_idx + 1);
+}
+
+static enum StateHashKind get_thing_state_hash_kind(const struct Thing *thing)
+{
+    if (thing->class_id == TCls_Creature)
+        return SHK_Creatures;
+    return SHK_Things;
+}
+
+/**
+ * Stores new hash of given thing, updating the sub-hash incrementally.
+ * To be called whenever the thing was processed.
+ * @return The thing hash.
+ */
+TbBigChecksum state_hash_update_thing(const struct Thing *thing)
+{
+    ThingIndex tng_idx = thing->index;
+    if ((tng_idx <= 0) || (tng_idx >= THINGS_COUNT))
+        return 0;
+    TbBigChecksum csum = get_thing_checksum(thing);
+    enum StateHashKind kind = get_thing_state_hash_kind(thing);
+    state_hash.sub_hash[state_hash.thing_kind[tng_idx]] -= state_hash.thing_hash[tng_idx];
+    state_hash.sub_hash[kind] += csum;
+    state_hash.thing_hash[tng_idx] = csum;
+    state_hash.thing_kind[tng_idx] = kind;
+    return csum;
+}
+
+void state_hash_remove_thing(const struct Thing *thing)
+{
+    ThingIndex tng_idx = thing->index;
+    if ((tng_idx <= 0) || (tng_idx >= THINGS_COUNT))
+        return;
+    state_hash.sub_hash[state_hash.thing_kind[tng_idx]] -= state_hash.thing_hash[tng_idx];
+    state_hash.thing_hash[tng_idx] = 0;
+}
+
+void state_hash_slab_changed(MapSlabCoord slb_x, MapSlabCoord slb_y)
+{
+    SlabCodedCoords slb_num = get_slab_number(slb_x, slb_y);
+    if (slb_num >= map_arena.slabs_count)
+        return;
+    TbBigChecksum csum = get_slab_checksum(slb_num);
+    state_hash.sub_hash[SHK_Slabs] += csum - map_arena.slab_state_hash[slb_num];
+    map_arena.slab_state_hash[slb_num] = csum;
+}
+
+void state_hash_set(enum StateHashKind kind, TbBigChecksum value)
+{
+    state_hash.sub_hash[kind] = value;
+}
+
+/**
+ * Recomputes the whole state hash. Needed when the state was replaced,
+ * ie. on level start, load and resync.
+ */
+void state_hash_rebuild(void)
+{
+    SYNCDBG(8,"Starting");
+    memset(&state_hash, 0, sizeof(state_hash));
+    if (map_arena.data != NULL)
+        memset(map_arena.slab_state_hash, 0, map_arena.slabs_count * sizeof(TbBigChecksum));
+    for (long tng_idx = 1; tng_idx < THINGS_COUNT; tng_idx++)
+    {
+        struct Thing* thing = thing_get(tng_idx);
+        if (thing_exists(thing))
+            state_hash_update_thing(thing);
+    }
+    for (MapSlabCoord slb_y = 0; slb_y < gameadd.map_tiles_y; slb_y++)
+    {
+        for (MapSlabCoord slb_x = 0; slb_x < gameadd.map_tiles_x; slb_x++)
+        {
+            state_hash_slab_changed(slb_x, slb_y);
+        }
+    }
+    TbBigChecksum sum = 0;
+    for (struct Room* room = start_rooms; room < end_rooms; room++)
+    {
+        sum += get_room_checksum(room);
+    }
+    state_hash.sub_hash[SHK_Rooms] = sum;
+    state_hash.sub_hash[SHK_Players] = compute_players_checksum() + game.action_rand_seed;
+    update_players_state_hash();
+}
+
+static void update_players_state_hash(void)
+{
+    TbBigChecksum dungeons_sum = 0;
+    TbBigChecksum computers_sum = 0;
+    for (PlayerNumber plyr_idx = 0; plyr_idx < PLAYERS_COUNT; plyr_idx++)
+    {
+        dungeons_sum += get_dungeon_checksum(plyr_idx);
+        computers_sum += get_computer_checksum(plyr_idx);
+    }
+    state_hash.sub_hash[SHK_Dungeons] = dungeons_sum;
+    state_hash.sub_hash[SHK_Computers] = computers_sum;
+}
+
+/**
+ * Updates hashes of small subsystems at end of a turn, and adds the ones
+ * which are not a part of per-turn packet checksum yet.
+ */
+void state_hash_finish_turn(void)
+{
+    update_players_state_hash();
+    player_packet_checksum_add(my_player_number, state_hash.sub_hash[SHK_Slabs]
+        + state_hash.sub_hash[SHK_Dungeons] + state_hash.sub_hash[SHK_Computers], "state");
+}
+
+TbBigChecksum state_hash_total(void)
+{
+    TbBigChecksum sum = 0;
+    for (int kind = 0; kind < SHK_ListEnd; kind++)
+    {
+        // Rotate so that a change moved between subsystems isn't lost
+        sum = ((sum << 5) | (sum >> 27)) + state_hash.sub_hash[kind];
+    }
+    return sum;
+}
+
+static long state_hash_entities_count(enum StateHashKind kind)
+{
+    switch (kind)
+    {
+    case SHK_Creatures:
+    case SHK_Things:
+        return THINGS_COUNT;
+    case SHK_Slabs:
+        return gameadd.map_tiles_x * gameadd.map_tiles_y;
+    case SHK_Rooms:
+        return ROOMS_COUNT;
+    default:
+        return PLAYERS_COUNT;
+    }
+}
+
+static TbBigChecksum state_hash_entity(enum StateHashKind kind, long idx)
+{
+    switch (kind)
+    {
+    case SHK_Creatures:
+    case SHK_Things:
+        if (state_hash.thing_kind[idx] != kind)
+            return 0;
+        return state_hash.thing_hash[idx];
+    case SHK_Slabs:
+        return map_arena.slab_state_hash[idx];
+    case SHK_Rooms:
+        return get_room_checksum(room_get(idx));
+    case SHK_Dungeons:
+        return get_dungeon_checksum(idx);
+    case SHK_Computers:
+        return get_computer_checksum(idx);
+    case SHK_Players:
+        if (!player_exists(get_player(idx)))
+            return 0;
+        return compute_player_checksum(get_player(idx));
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Exchanges the report values with other players, in chunks which fit into network frames.
+ * @return Index of the first value which differs between human players, or -1.
+ */
+static long state_hash_exchange_report(long values_count)
+{
+    struct StateHashReport* report = &state_hash_reports[my_player_number];
+    struct StateHashReportChunk* chunk = &state_hash_chunks[my_player_number];
+    if (sizeof(struct StateHashReportChunk) > LbNetwork_MaxFrameSize())
+    {
+        ERRORLOG("State hash report chunk of %d bytes is too large for network frame", (int)sizeof(struct StateHashReportChunk));
+        return -1;
+    }
+    for (long first = 0; first < values_count; first += STATE_HASH_CHUNK_VALUES)
+    {
+        long n = min(values_count - first, (long)STATE_HASH_CHUNK_VALUES);
+        memset(chunk, 0, sizeof(struct StateHashReportChunk));
+        memcpy(chunk->values, &report->values[first], n * sizeof(TbBigChecksum));
+        if (LbNetwork_Exchange(chunk, state_hash_chunks, sizeof(struct StateHashReportChunk)))
+        {
+            ERRORLOG("Network exchange failed on state hash report");
+            return -1;
+        }
+        for (int plyr_idx = 0; plyr_idx < NET_PLAYERS_COUNT; plyr_idx++)
+            memcpy(&state_hash_reports[plyr_idx].values[first], state_hash_chunks[plyr_idx].values, n * sizeof(TbBigChecksum));
+    }
+    for (long i = 0; i < values_count; i++)
+    {
+        for (int plyr_idx = 0; plyr_idx < NET_PLAYERS_COUNT; plyr_idx++)
+        {
+            struct PlayerInfo* player = get_player(plyr_idx);
+            if (!player_exists(player) || ((player->allocflags & PlaF_CompCtrl) != 0))
+                continue;
+            if (state_hash_reports[plyr_idx].values[i] != report->values[i])
+                return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Finds which subsystem, and which entity in it, differs between players.
+ * Narrows down the search with exchanges of sub-hashes, then bucket hashes,
+ * repeated until a bucket is small enough, and finally hashes of entities within the bucket.
+ */
+static void state_hash_report_desync(void)
+{
+    struct StateHashReport* report = &state_hash_reports[my_player_number];
+    memset(report, 0, sizeof(struct StateHashReport));
+    for (int kind = 0; kind < SHK_ListEnd; kind++)
+        report->values[kind] = state_hash.sub_hash[kind];
+    long kind = state_hash_exchange_report(SHK_ListEnd);
+    if (kind < 0)
+    {
+        NETLOG("State hashes are identical, desync is outside of tracked state");
+        return;
+    }
+    long count = state_hash_entities_count(kind);
+    long first = 0;
+    long range = count;
+    // The amount of slabs depends on map size, so a single level of buckets may not be enough
+    while (range > STATE_HASH_BUCKETS)
+    {
+        long bucket_size = (range + STATE_HASH_BUCKETS - 1) / STATE_HASH_BUCKETS;
+        memset(report, 0, sizeof(struct StateHashReport));
+        for (long i = 0; i < range; i++)
+            report->values[i / bucket_size] += state_hash_entity(kind, first + i);
+        long bucket = state_hash_exchange_report(STATE_HASH_BUCKETS);
+        if (bucket < 0)
+        {
+            ERRORLOG("Turn %lu desync in %s, but no entity differs within %ld-%ld", (unsigned long)game.play_gameturn,
+                state_hash_kind_names[kind], first, first + range - 1);
+            return;
+        }
+        first += bucket * bucket_size;
+        range = min(bucket_size, range - bucket * bucket_size);
+    }
+    memset(report, 0, sizeof(struct StateHashReport));
+    for (long i = 0; i < range; i++)
+        report->values[i] = state_hash_entity(kind, first + i);
+    long entity = state_hash_exchange_report(range);
+    if (entity < 0)
+    {
+        ERRORLOG("Turn %lu desync in %s, entities %ld-%ld", (unsigned long)game.play_gameturn,
+            state_hash_kind_names[kind], first, first + range - 1);
+        return;
+    }
+    ERRORLOG("Turn %lu desync in %s, first different entity index %ld", (unsigned long)game.play_gameturn,
+        state_hash_kind_names[kind], first + entity);
+}
+/******************************************************************************/
 #ifdef __cplusplus
 }
 #endif
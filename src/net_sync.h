@@ -28,14 +28,40 @@ extern "C" {
 #endif
 
 /******************************************************************************/
+/** Subsystems which have their own part of the game state hash. */
+enum StateHashKind {
+    SHK_Creatures = 0,
+    SHK_Things,
+    SHK_Slabs,
+    SHK_Rooms,
+    SHK_Dungeons,
+    SHK_Computers,
+    SHK_Players,
+    SHK_ListEnd,
+};
+
 #pragma pack(1)
 
 
 #pragma pack()
 /******************************************************************************/
+struct Thing;
+struct Room;
+
 void resync_game(void);
+void store_localised_game_structure(void);
+void recall_localised_game_structure(void);
 CoroutineLoopState perform_checksum_verification(CoroutineLoop *con);
 
+void state_hash_rebuild(void);
+TbBigChecksum state_hash_update_thing(const struct Thing *thing);
+void state_hash_remove_thing(const struct Thing *thing);
+void state_hash_slab_changed(MapSlabCoord slb_x, MapSlabCoord slb_y);
+void state_hash_set(enum StateHashKind kind, TbBigChecksum value);
+void state_hash_finish_turn(void);
+TbBigChecksum state_hash_total(void);
+TbBigChecksum get_room_checksum(const struct Room *room);
+
 /******************************************************************************/
 #ifdef __cplusplus
 }
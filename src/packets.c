@@ -84,6 +84,7 @@
 #include "gui_msgs.h"
 #include "net_game.h"
 #include "net_sync.h"
+#include "net_rollback.h"
 #include "game_legacy.h"
 #include "engine_redraw.h"
 #include "frontmenu_ingame_tabs.h"
@@ -944,7 +945,7 @@ TbBool process_players_global_packet_action(PlayerNumber plyr_idx)
          toggle_ally_with_player(plyr_idx, pckt->actn_par1);
          if (game.conf.rules.game.allies_share_vision)
          {
-            panel_map_update(0, 0, gameadd.map_subtiles_x+1, gameadd.map_subtiles_y+1);
+            panel_map_update_all_sliced();
          }
       }
       return false;
@@ -1453,8 +1454,8 @@ void process_packets(void)
     SYNCDBG(5, "Starting");
     // Do the network data exchange
     lbDisplay.DrawColour = colours[15][15][15];
-    // Exchange packets with the network
-    if (game.game_kind != GKind_LocalGame)
+    // Exchange packets with the network; turns simulated again by rollback already have their packets
+    if ((game.game_kind != GKind_LocalGame) && !network_rollback_resimulating())
     {
         player = get_my_player();
         int old_active_players = 0;
@@ -1466,6 +1467,13 @@ void process_packets(void)
         if (!game.packet_load_enable || game.numfield_149F47)
         {
             struct Packet* pckt = get_packet_direct(player->packet_num);
+            if (network_rollback_active())
+            {
+                network_rollback_exchange(pckt);
+                // The turn waits for the server; it will be processed once a frame arrives
+                if (network_rollback_stalled())
+                    return;
+            } else
             if (LbNetwork_Exchange(pckt, game.packets, sizeof(struct Packet)) != 0)
             {
                 ERRORLOG("LbNetwork_Exchange failed");
@@ -1473,8 +1481,9 @@ void process_packets(void)
         }
         replace_with_ai(old_active_players);
     }
-  // Setting checksum problem flags
-  switch (checksums_different())
+  // Setting checksum problem flags; predicted packets are verified when confirmed
+  TbBool verify_checksums = !network_rollback_turn_predicted() && !network_rollback_resimulating();
+  switch (verify_checksums ? checksums_different() : 0)
   {
   case 1:
       set_flag(game.system_flags, GSF_NetGameNoSync);
@@ -1494,7 +1503,7 @@ void process_packets(void)
     break;
   }
   // Write packets into file, if requested
-  if ((game.packet_save_enable) && (game.packet_fopened))
+  if ((game.packet_save_enable) && (game.packet_fopened) && verify_checksums)
     save_packets();
 //Debug code, to find packet errors
 #if DEBUG_NETWORK_PACKETS
@@ -288,6 +288,36 @@ struct PacketEx
     TbBigChecksum sums[CKS_MAX];
 };
 
+enum PacketBlockKinds {
+    PBlk_Turns    = 0x4E525554, //"TURN"
+    PBlk_Snapshot = 0x50414E53, //"SNAP"
+    PBlk_Index    = 0x58444950, //"PIDX"
+};
+
+/** Header of a block within packet file data; followed by packed_len bytes of compressed data. */
+struct PacketBlockHeader {
+    unsigned long id;
+    unsigned long first_turn; //! Index of the first packet turn, counted from start of the file
+    unsigned long turns_count; //! Amount of turns stored in the block; 0 for snapshots
+    GameTurn gameturn; //! Game turn at which the first turn was stored
+    unsigned long packed_len;
+    unsigned long unpacked_len;
+};
+
+struct PacketBlockIndexEntry {
+    unsigned long id;
+    unsigned long first_turn;
+    unsigned long turns_count;
+    GameTurn gameturn;
+    unsigned long file_pos; //! Position of the block header in the file
+};
+
+/** Written at the very end of packet file, allows finding the index without scanning blocks. */
+struct PacketIndexTrailer {
+    unsigned long index_pos;
+    unsigned long id;
+};
+
 #pragma pack()
 /******************************************************************************/
 /******************************************************************************/
@@ -316,6 +346,7 @@ void clear_packets(void);
 TbBigChecksum compute_players_checksum(void);
 void player_packet_checksum_add(PlayerNumber plyr_idx, TbBigChecksum sum, const char *area_name);
 short checksums_different(void);
+short packets_checksums_different(const struct Packet *pckts);
 void post_init_packets(void);
 
 TbBool open_new_packet_file_for_save(void);
@@ -323,6 +354,7 @@ void load_packets_for_turn(GameTurn nturn);
 TbBool open_packet_file_for_load(char *fname, struct CatalogueEntry *centry);
 short save_packets(void);
 void close_packet_file(void);
+TbBool packet_seek_to_gameturn(GameTurn gameturn);
 TbBool reinit_packets_after_load(void);
 struct Room *keeper_build_room(long stl_x,long stl_y,long plyr_idx,long rkind);
 TbBool player_sell_room_at_subtile(long plyr_idx, long stl_x, long stl_y);
@@ -20,11 +20,20 @@
 #include "packets.h"
 
 #include "bflib_fileio.h"
+#include "bflib_crash.h"
+#include "bflib_datetm.h"
 #include "front_landview.h"
 #include "game_legacy.h"
 #include "game_saves.h"
 #include "gui_topmsg.h"
 #include "config_settings.h"
+#include "light_data.h"
+#include "keeperfx.hpp"
+#include <stddef.h>
+#include <zlib.h>
+#include "net_sync.h"
+#include "map_arena.h"
+#include "sim_context.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -32,8 +41,35 @@ extern "C" {
 #endif
 /******************************************************************************/
 #define PACKET_TURN_SIZE (NET_PLAYERS_COUNT*sizeof(struct PacketEx) + sizeof(TbBigChecksum))
+/** Amount of turns buffered in memory and compressed together. */
+#define PACKET_BLOCK_TURNS 256
+/** Longest time a partial block of turns waits in memory, so a crash loses at most that much of the replay. */
+#define PACKET_FLUSH_INTERVAL_MS 2000
+/** Minimal amount of turns between game state snapshots stored in packet file. */
+#define PACKET_SNAPSHOT_INTERVAL 2000
+/** Snapshot includes map arrays, so its size depends on the size of the map. */
+#define PACKET_SNAPSHOT_SIZE (sizeof(struct Game) + sizeof(struct GameAdd) + sizeof(struct IntralevelData) + map_arena.size)
 struct Packet bad_packet;
 unsigned long start_seed;
+
+struct PacketFileState {
+    TbBool blocks_format; //! File stores turns in compressed blocks, rather than one after another
+    TbBool writing;
+    unsigned char *block_buf; //! Turns of one block, not compressed
+    unsigned long block_turns; //! Turns currently in block_buf, when writing
+    unsigned long block_first_turn;
+    GameTurn block_gameturn;
+    TbClockMSec block_flush_clock; //! When the last block was written, when writing
+    long block_cached; //! Index of turns block stored in block_buf, when reading
+    unsigned long turns_written;
+    unsigned long last_snapshot_turn;
+    struct PacketBlockIndexEntry *turn_blocks;
+    unsigned long turn_blocks_count;
+    struct PacketBlockIndexEntry *snapshots;
+    unsigned long snapshots_count;
+};
+
+static struct PacketFileState packet_file;
 /******************************************************************************/
 #ifdef __cplusplus
 }
@@ -121,10 +157,105 @@ void clear_packets(void)
     }
 }
 
+static void packet_file_state_reset(void)
+{
+    free(packet_file.block_buf);
+    free(packet_file.turn_blocks);
+    free(packet_file.snapshots);
+    memset(&packet_file, 0, sizeof(packet_file));
+    packet_file.block_cached = -1;
+}
+
+static TbBool packet_index_add(const struct PacketBlockIndexEntry *entry)
+{
+    struct PacketBlockIndexEntry **list;
+    unsigned long *count;
+    if (entry->id == PBlk_Snapshot) {
+        list = &packet_file.snapshots;
+        count = &packet_file.snapshots_count;
+    } else {
+        list = &packet_file.turn_blocks;
+        count = &packet_file.turn_blocks_count;
+    }
+    // Grow in steps of power of 2
+    if ((*count & (*count - 1)) == 0)
+    {
+        unsigned long new_size = (*count == 0) ? 16 : 2 * (*count);
+        struct PacketBlockIndexEntry *new_list = realloc(*list, new_size * sizeof(struct PacketBlockIndexEntry));
+        if (new_list == NULL)
+            return false;
+        *list = new_list;
+    }
+    (*list)[*count] = *entry;
+    (*count)++;
+    return true;
+}
+
+/**
+ * Reads the block index stored at end of the file.
+ * @return False if the file has no index, ie. the recording wasn't finished properly.
+ */
+static TbBool load_packet_index(TbFileHandle fhandle, long data_pos, long file_len)
+{
+    struct PacketIndexTrailer trailer;
+    if (file_len < data_pos + (long)sizeof(struct PacketIndexTrailer))
+        return false;
+    LbFileSeek(fhandle, file_len - sizeof(struct PacketIndexTrailer), Lb_FILE_SEEK_BEGINNING);
+    if (LbFileRead(fhandle, &trailer, sizeof(trailer)) != sizeof(trailer))
+        return false;
+    if ((trailer.id != PBlk_Index) || (trailer.index_pos < data_pos) || (trailer.index_pos >= file_len))
+        return false;
+    struct PacketBlockHeader bhead;
+    LbFileSeek(fhandle, trailer.index_pos, Lb_FILE_SEEK_BEGINNING);
+    if (LbFileRead(fhandle, &bhead, sizeof(bhead)) != sizeof(bhead))
+        return false;
+    if ((bhead.id != PBlk_Index) || (bhead.packed_len % sizeof(struct PacketBlockIndexEntry) != 0))
+        return false;
+    for (unsigned long i = 0; i < bhead.packed_len / sizeof(struct PacketBlockIndexEntry); i++)
+    {
+        struct PacketBlockIndexEntry entry;
+        if (LbFileRead(fhandle, &entry, sizeof(entry)) != sizeof(entry))
+            return false;
+        if (!packet_index_add(&entry))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Rebuilds the block index by walking through block headers.
+ */
+static void scan_packet_blocks(TbFileHandle fhandle, long data_pos, long file_len)
+{
+    long pos = data_pos;
+    while (pos + (long)sizeof(struct PacketBlockHeader) <= file_len)
+    {
+        struct PacketBlockHeader bhead;
+        LbFileSeek(fhandle, pos, Lb_FILE_SEEK_BEGINNING);
+        if (LbFileRead(fhandle, &bhead, sizeof(bhead)) != sizeof(bhead))
+            break;
+        if ((bhead.id != PBlk_Turns) && (bhead.id != PBlk_Snapshot))
+            break;
+        // Block cut by end of file, ie. recording ended by a crash
+        if (pos + (long)sizeof(bhead) + (long)bhead.packed_len > file_len)
+            break;
+        struct PacketBlockIndexEntry entry;
+        entry.id = bhead.id;
+        entry.first_turn = bhead.first_turn;
+        entry.turns_count = bhead.turns_count;
+        entry.gameturn = bhead.gameturn;
+        entry.file_pos = pos;
+        if (!packet_index_add(&entry))
+            break;
+        pos += sizeof(bhead) + bhead.packed_len;
+    }
+}
+
 TbBool open_packet_file_for_load(char *fname, struct CatalogueEntry *centry)
 {
     memset(centry, 0, sizeof(struct CatalogueEntry));
     strcpy(game.packet_fname, fname);
+    packet_file_state_reset();
     game.packet_save_fp = LbFileOpen(game.packet_fname, Lb_FILE_MODE_READ_ONLY);
     if (!game.packet_save_fp)
     {
@@ -142,7 +273,44 @@ TbBool open_packet_file_for_load(char *fname, struct CatalogueEntry *centry)
         return false;
     }
     game.packet_file_pos = LbFilePosition(game.packet_save_fp);
-    game.turns_stored = (LbFileLengthHandle(game.packet_save_fp) - game.packet_file_pos) / PACKET_TURN_SIZE;
+    long file_len = LbFileLengthHandle(game.packet_save_fp);
+    // Check which kind of data start indicator was there
+    struct FileChunkHeader hdr;
+    LbFileSeek(game.packet_save_fp, game.packet_file_pos - sizeof(struct FileChunkHeader), Lb_FILE_SEEK_BEGINNING);
+    if (LbFileRead(game.packet_save_fp, &hdr, sizeof(struct FileChunkHeader)) != sizeof(struct FileChunkHeader))
+        hdr.id = SGC_PacketData;
+    packet_file.blocks_format = (hdr.id == SGC_PacketBlocks);
+    if (packet_file.blocks_format)
+    {
+        if (!load_packet_index(game.packet_save_fp, game.packet_file_pos, file_len))
+        {
+            WARNMSG("Packet file \"%s\" has no index, probably it wasn't closed properly; scanning.",fname);
+            packet_file_state_reset();
+            packet_file.blocks_format = true;
+            scan_packet_blocks(game.packet_save_fp, game.packet_file_pos, file_len);
+        }
+        packet_file.block_buf = malloc(PACKET_BLOCK_TURNS * PACKET_TURN_SIZE);
+        if (packet_file.block_buf == NULL)
+        {
+            ERRORLOG("Cannot allocate packet block buffer");
+            LbFileClose(game.packet_save_fp);
+            game.packet_save_fp = NULL;
+            game.packet_fopened = 0;
+            return false;
+        }
+        game.turns_stored = 0;
+        if (packet_file.turn_blocks_count > 0)
+        {
+            struct PacketBlockIndexEntry *entry = &packet_file.turn_blocks[packet_file.turn_blocks_count-1];
+            game.turns_stored = entry->first_turn + entry->turns_count;
+        }
+        SYNCMSG("Packet file has %lu blocks of turns and %lu snapshots",
+            packet_file.turn_blocks_count, packet_file.snapshots_count);
+    } else
+    {
+        LbFileSeek(game.packet_save_fp, game.packet_file_pos, Lb_FILE_SEEK_BEGINNING);
+        game.turns_stored = (file_len - game.packet_file_pos) / PACKET_TURN_SIZE;
+    }
     if ((game.packet_checksum_verify) && (!game.packet_save_head.chksum_available))
     {
         WARNMSG("PacketSave checksum not available, checking disabled.");
@@ -169,67 +337,178 @@ void post_init_packets(void)
     clear_packets();
 }
 
-static TbBigChecksum get_thing_simple_checksum(const struct Thing *tng)
+static TbBigChecksum get_packet_save_checksum(void)
 {
-    return (ulong)tng->mappos.x.val + (ulong)tng->mappos.y.val + (ulong)tng->mappos.z.val
-         + (ulong)tng->move_angle_xy + (ulong)tng->owner;
+    // The hash is maintained incrementally while things and slabs are updated
+    return state_hash_total();
 }
 
-static TbBigChecksum get_packet_save_checksum(void)
+static TbBool write_packet_block(unsigned long id, const unsigned char *data, unsigned long data_len,
+    unsigned long first_turn, unsigned long turns_count, GameTurn gameturn)
 {
-    TbBigChecksum sum = 0;
-    for (long tng_idx = 0; tng_idx < THINGS_COUNT; tng_idx++)
+    uLongf packed_len = compressBound(data_len);
+    unsigned char *packed = malloc(packed_len);
+    if (packed == NULL)
     {
-        struct Thing* tng = thing_get(tng_idx);
-        if ((tng->alloc_flags & TAlF_Exists) != 0)
-        {
-            // It would be nice to completely ignore effects, but since
-            // thing indices are used in packets, lack of effect may cause desync too.
-            if ((tng->class_id != TCls_AmbientSnd) && (tng->class_id != TCls_EffectElem))
-            {
-                sum += get_thing_simple_checksum(tng);
-            }
-        }
+        ERRORLOG("Cannot allocate packet compression buffer");
+        return false;
+    }
+    if (compress2(packed, &packed_len, data, data_len, Z_BEST_SPEED) != Z_OK)
+    {
+        ERRORLOG("Packet block compression failed");
+        free(packed);
+        return false;
+    }
+    struct PacketBlockHeader bhead;
+    bhead.id = id;
+    bhead.first_turn = first_turn;
+    bhead.turns_count = turns_count;
+    bhead.gameturn = gameturn;
+    bhead.packed_len = packed_len;
+    bhead.unpacked_len = data_len;
+    LbFileSeek(game.packet_save_fp, 0, Lb_FILE_SEEK_END);
+    struct PacketBlockIndexEntry entry;
+    entry.id = id;
+    entry.first_turn = first_turn;
+    entry.turns_count = turns_count;
+    entry.gameturn = gameturn;
+    entry.file_pos = LbFilePosition(game.packet_save_fp);
+    TbBool result = true;
+    if ((LbFileWrite(game.packet_save_fp, &bhead, sizeof(bhead)) != sizeof(bhead))
+     || (LbFileWrite(game.packet_save_fp, packed, packed_len) != packed_len))
+    {
+        ERRORLOG("Packet file write error");
+        result = false;
+    }
+    free(packed);
+    if (result)
+        packet_index_add(&entry);
+    return result;
+}
+
+static TbBool flush_packet_block(void)
+{
+    if (packet_file.block_turns == 0)
+        return true;
+    TbBool result = write_packet_block(PBlk_Turns, packet_file.block_buf, packet_file.block_turns * PACKET_TURN_SIZE,
+        packet_file.block_first_turn, packet_file.block_turns, packet_file.block_gameturn);
+    packet_file.block_turns = 0;
+    packet_file.block_flush_clock = LbTimerClock();
+    if ( !LbFileFlush(game.packet_save_fp) )
+    {
+        ERRORLOG("Unable to flush PacketSave File");
+        return false;
+    }
+    return result;
+}
+
+/**
+ * Stores the whole game state, the same way as saved game does, to allow starting replay from it.
+ */
+static TbBool save_packet_snapshot(void)
+{
+    unsigned char *state_buf = malloc(PACKET_SNAPSHOT_SIZE);
+    if (state_buf == NULL)
+    {
+        ERRORLOG("Cannot allocate packet snapshot buffer");
+        return false;
     }
-    return sum;
+    // Replay rebuilds the hash after loading a snapshot; do the same here so both sides match
+    state_hash_rebuild();
+    light_export_system_state(&gameadd.lightst);
+    unsigned char *ptr = state_buf;
+    memcpy(ptr, &game, sizeof(struct Game));
+    ptr += sizeof(struct Game);
+    memcpy(ptr, &gameadd, sizeof(struct GameAdd));
+    ptr += sizeof(struct GameAdd);
+    memcpy(ptr, &intralvl, sizeof(struct IntralevelData));
+    ptr += sizeof(struct IntralevelData);
+    memcpy(ptr, map_arena.data, map_arena.size);
+    TbBool result = write_packet_block(PBlk_Snapshot, state_buf, PACKET_SNAPSHOT_SIZE,
+        packet_file.turns_written, 0, game.play_gameturn);
+    free(state_buf);
+    packet_file.last_snapshot_turn = packet_file.turns_written;
+    SYNCDBG(7,"Stored snapshot at turn %lu",(unsigned long)game.play_gameturn);
+    return result;
 }
 
 short save_packets(void)
 {
-    const int turn_data_size = PACKET_TURN_SIZE;
-    unsigned char pckt_buf[PACKET_TURN_SIZE+4];
     TbBigChecksum chksum;
     SYNCDBG(6,"Starting");
     if (game.packet_checksum_verify)
         chksum = get_packet_save_checksum();
     else
         chksum = 0;
-    LbFileSeek(game.packet_save_fp, 0, Lb_FILE_SEEK_END);
-    // Prepare data in the buffer
+    if (packet_file.block_turns == 0)
+    {
+        // Snapshots are only made at block boundary, so that replay can start from a whole block
+        if (packet_file.turns_written >= packet_file.last_snapshot_turn + PACKET_SNAPSHOT_INTERVAL)
+            save_packet_snapshot();
+        packet_file.block_first_turn = packet_file.turns_written;
+        packet_file.block_gameturn = game.play_gameturn;
+    }
+    // Prepare data in the block buffer
+    unsigned char *pckt_buf = &packet_file.block_buf[packet_file.block_turns * PACKET_TURN_SIZE];
+    memset(pckt_buf, 0, PACKET_TURN_SIZE);
     for (int i = 0; i < NET_PLAYERS_COUNT; i++)
         memcpy(&pckt_buf[i*sizeof(struct Packet)], &game.packets[i], sizeof(struct Packet));
     memcpy(&pckt_buf[NET_PLAYERS_COUNT*sizeof(struct Packet)], &chksum, sizeof(TbBigChecksum));
-    // Write buffer into file
-    if (LbFileWrite(game.packet_save_fp, &pckt_buf, turn_data_size) != turn_data_size)
-    {
-        ERRORLOG("Packet file write error");
-    }
-    if ( !LbFileFlush(game.packet_save_fp) )
-    {
-        ERRORLOG("Unable to flush PacketSave File");
-        return false;
-    }
+    packet_file.block_turns++;
+    packet_file.turns_written++;
+    // Write the block into file when it's filled, or when it was kept in memory for too long
+    if ((packet_file.block_turns >= PACKET_BLOCK_TURNS)
+      || (LbTimerClock() - packet_file.block_flush_clock >= PACKET_FLUSH_INTERVAL_MS))
+        return flush_packet_block();
     return true;
 }
 
+/**
+ * Writes turns which are still in memory when the game goes down, so they're not lost from the replay.
+ * The file has no index then; it is rebuilt from block headers when the file is loaded.
+ */
+static void packet_file_parachute(void)
+{
+    if (game.packet_fopened && packet_file.writing)
+        flush_packet_block();
+}
+
+static void save_packet_index(void)
+{
+    unsigned long count = packet_file.turn_blocks_count + packet_file.snapshots_count;
+    struct PacketBlockHeader bhead;
+    bhead.id = PBlk_Index;
+    bhead.first_turn = 0;
+    bhead.turns_count = packet_file.turns_written;
+    bhead.gameturn = 0;
+    bhead.packed_len = count * sizeof(struct PacketBlockIndexEntry);
+    bhead.unpacked_len = bhead.packed_len;
+    LbFileSeek(game.packet_save_fp, 0, Lb_FILE_SEEK_END);
+    struct PacketIndexTrailer trailer;
+    trailer.index_pos = LbFilePosition(game.packet_save_fp);
+    trailer.id = PBlk_Index;
+    LbFileWrite(game.packet_save_fp, &bhead, sizeof(bhead));
+    // Snapshots go first; order within the index doesn't matter
+    LbFileWrite(game.packet_save_fp, packet_file.snapshots, packet_file.snapshots_count * sizeof(struct PacketBlockIndexEntry));
+    LbFileWrite(game.packet_save_fp, packet_file.turn_blocks, packet_file.turn_blocks_count * sizeof(struct PacketBlockIndexEntry));
+    LbFileWrite(game.packet_save_fp, &trailer, sizeof(trailer));
+}
+
 void close_packet_file(void)
 {
     if ( game.packet_fopened )
     {
+        if (packet_file.writing)
+        {
+            LbErrorParachuteSetCallback(NULL);
+            flush_packet_block();
+            save_packet_index();
+        }
         LbFileClose(game.packet_save_fp);
         game.packet_fopened = 0;
         game.packet_save_fp = NULL;
     }
+    packet_file_state_reset();
 }
 
 void dump_memory_to_file(const char * fname, const char * buf, size_t len)
@@ -310,15 +589,87 @@ TbBool open_new_packet_file_for_save(void)
         game.packet_save_fp = NULL;
         return false;
     }
+    packet_file_state_reset();
+    packet_file.blocks_format = true;
+    packet_file.writing = true;
+    packet_file.block_buf = malloc(PACKET_BLOCK_TURNS * PACKET_TURN_SIZE);
+    if (packet_file.block_buf == NULL)
+    {
+        ERRORLOG("Cannot allocate packet block buffer");
+        LbFileClose(game.packet_save_fp);
+        game.packet_fopened = 0;
+        game.packet_save_fp = NULL;
+        return false;
+    }
+    packet_file.block_flush_clock = LbTimerClock();
+    LbErrorParachuteSetCallback(packet_file_parachute);
     game.packet_fopened = 1;
     return true;
 }
 
+/**
+ * Makes sure the block of turns which contains given turn is unpacked in the block buffer.
+ * @return Pointer to the turn data, or NULL on error.
+ */
+static unsigned char *get_packet_block_turn(GameTurn nturn)
+{
+    // Find the block with binary search; blocks are sorted by turn
+    long lo = 0;
+    long hi = (long)packet_file.turn_blocks_count - 1;
+    long found = -1;
+    while (lo <= hi)
+    {
+        long mid = (lo + hi) / 2;
+        struct PacketBlockIndexEntry *entry = &packet_file.turn_blocks[mid];
+        if (nturn < entry->first_turn) {
+            hi = mid - 1;
+        } else
+        if (nturn >= entry->first_turn + entry->turns_count) {
+            lo = mid + 1;
+        } else {
+            found = mid;
+            break;
+        }
+    }
+    if (found < 0)
+        return NULL;
+    struct PacketBlockIndexEntry *entry = &packet_file.turn_blocks[found];
+    if (packet_file.block_cached != found)
+    {
+        struct PacketBlockHeader bhead;
+        LbFileSeek(game.packet_save_fp, entry->file_pos, Lb_FILE_SEEK_BEGINNING);
+        if (LbFileRead(game.packet_save_fp, &bhead, sizeof(bhead)) != sizeof(bhead))
+            return NULL;
+        if ((bhead.id != PBlk_Turns) || (bhead.unpacked_len != bhead.turns_count * PACKET_TURN_SIZE)
+          || (bhead.turns_count > PACKET_BLOCK_TURNS))
+        {
+            WARNLOG("Invalid block of turns at file position %lu",entry->file_pos);
+            return NULL;
+        }
+        unsigned char *packed = malloc(bhead.packed_len);
+        if (packed == NULL)
+            return NULL;
+        uLongf unpacked_len = bhead.unpacked_len;
+        if ((LbFileRead(game.packet_save_fp, packed, bhead.packed_len) != bhead.packed_len)
+         || (uncompress(packet_file.block_buf, &unpacked_len, packed, bhead.packed_len) != Z_OK)
+         || (unpacked_len != bhead.unpacked_len))
+        {
+            free(packed);
+            packet_file.block_cached = -1;
+            return NULL;
+        }
+        free(packed);
+        packet_file.block_cached = found;
+    }
+    return &packet_file.block_buf[(nturn - entry->first_turn) * PACKET_TURN_SIZE];
+}
+
 void load_packets_for_turn(GameTurn nturn)
 {
     SYNCDBG(19,"Starting");
     const int turn_data_size = PACKET_TURN_SIZE;
-    unsigned char pckt_buf[PACKET_TURN_SIZE+4];
+    unsigned char pckt_data[PACKET_TURN_SIZE+4];
+    unsigned char *pckt_buf = pckt_data;
     struct Packet* pckt = get_packet(my_player_number);
     TbChecksum pckt_chksum = pckt->chksum;
     if (nturn >= game.turns_stored)
@@ -328,7 +679,17 @@ void load_packets_for_turn(GameTurn nturn)
         return;
     }
 
-    if (LbFileRead(game.packet_save_fp, &pckt_buf, turn_data_size) == -1)
+    if (packet_file.blocks_format)
+    {
+        pckt_buf = get_packet_block_turn(nturn);
+        if (pckt_buf == NULL)
+        {
+            ERRORDBG(18,"Cannot unpack turn data from Packet File");
+            erstat_inc(ESE_CantReadPackets);
+            return;
+        }
+    } else
+    if (LbFileRead(game.packet_save_fp, pckt_buf, turn_data_size) == -1)
     {
         ERRORDBG(18,"Cannot read turn data from Packet File");
         erstat_inc(ESE_CantReadPackets);
@@ -358,6 +719,79 @@ void load_packets_for_turn(GameTurn nturn)
     }
 }
 
+static TbBool load_packet_snapshot(const struct PacketBlockIndexEntry *entry)
+{
+    struct PacketBlockHeader bhead;
+    LbFileSeek(game.packet_save_fp, entry->file_pos, Lb_FILE_SEEK_BEGINNING);
+    if (LbFileRead(game.packet_save_fp, &bhead, sizeof(bhead)) != sizeof(bhead))
+        return false;
+    if ((bhead.id != PBlk_Snapshot) || (bhead.unpacked_len != PACKET_SNAPSHOT_SIZE))
+    {
+        WARNLOG("Incompatible snapshot at game turn %lu",(unsigned long)entry->gameturn);
+        return false;
+    }
+    unsigned char *packed = malloc(bhead.packed_len);
+    unsigned char *state_buf = malloc(PACKET_SNAPSHOT_SIZE);
+    uLongf unpacked_len = PACKET_SNAPSHOT_SIZE;
+    if ((packed == NULL) || (state_buf == NULL)
+     || (LbFileRead(game.packet_save_fp, packed, bhead.packed_len) != bhead.packed_len)
+     || (uncompress(state_buf, &unpacked_len, packed, bhead.packed_len) != Z_OK)
+     || (unpacked_len != PACKET_SNAPSHOT_SIZE))
+    {
+        WARNLOG("Couldn't read snapshot at game turn %lu",(unsigned long)entry->gameturn);
+        free(packed);
+        free(state_buf);
+        return false;
+    }
+    free(packed);
+    // Replay related fields belong to this session, not to the recorded game
+    unsigned char packet_fields[offsetof(struct Game, campaign_fname) - offsetof(struct Game, packet_save_enable)];
+    memcpy(packet_fields, &game.packet_save_enable, sizeof(packet_fields));
+    unsigned char *ptr = state_buf;
+    memcpy(&game, ptr, sizeof(struct Game));
+    ptr += sizeof(struct Game);
+    memcpy(&gameadd, ptr, sizeof(struct GameAdd));
+    ptr += sizeof(struct GameAdd);
+    memcpy(&intralvl, ptr, sizeof(struct IntralevelData));
+    ptr += sizeof(struct IntralevelData);
+    // Replay stays within one level, so the arrays are already sized for its map
+    memcpy(map_arena.data, ptr, map_arena.size);
+    free(state_buf);
+    reinit_level_after_load();
+    clear_world_caches();
+    memcpy(&game.packet_save_enable, packet_fields, sizeof(packet_fields));
+    light_import_system_state(&gameadd.lightst);
+    game.pckt_gameturn = entry->first_turn;
+    return true;
+}
+
+/**
+ * Moves the replay to given game turn. Loads the last snapshot before that turn,
+ * and sets fast forward for the remaining turns.
+ * @return True if a snapshot was loaded.
+ */
+TbBool packet_seek_to_gameturn(GameTurn gameturn)
+{
+    if (!game.packet_fopened || !packet_file.blocks_format || packet_file.writing)
+        return false;
+    const struct PacketBlockIndexEntry *best = NULL;
+    for (unsigned long i = 0; i < packet_file.snapshots_count; i++)
+    {
+        const struct PacketBlockIndexEntry *entry = &packet_file.snapshots[i];
+        if ((entry->gameturn <= gameturn) && (entry->gameturn > game.play_gameturn)
+          && ((best == NULL) || (entry->gameturn > best->gameturn)))
+            best = entry;
+    }
+    if (best == NULL)
+        return false;
+    if (!load_packet_snapshot(best))
+        return false;
+    game.turns_fastforward = gameturn - game.play_gameturn;
+    SYNCMSG("Replay moved to snapshot at game turn %lu, fast forward through %lu turns",
+        (unsigned long)game.play_gameturn, game.turns_fastforward);
+    return true;
+}
+
 void set_packet_pause_toggle()
 {
     struct PlayerInfo* player = get_my_player();
@@ -55,6 +55,7 @@
 #include "keeperfx.hpp"
 #include "kjm_input.h"
 #include "music_player.h"
+#include "net_sync.h"
 #include "post_inc.h"
 
 /******************************************************************************/
@@ -1119,6 +1120,7 @@ void process_players(void)
     sum += compute_players_checksum();
     sum += game.action_rand_seed;
     player_packet_checksum_add(my_player_number,sum,"players");
+    state_hash_set(SHK_Players, sum);
     SYNCDBG(17,"Finished");
 }
 
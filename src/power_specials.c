@@ -416,7 +416,7 @@ void make_safe(struct PlayerInfo *player)
         slb_y = slb_num_decode_y(slblist[list_cur]);
         list_cur++;
     }
-    panel_map_update(0, 0, gameadd.map_subtiles_x+1, gameadd.map_subtiles_y+1);
+    panel_map_update_all_sliced();
 }
 
 void make_unsafe(PlayerNumber plyr_idx)
@@ -454,7 +454,7 @@ void make_unsafe(PlayerNumber plyr_idx)
             }
         }
     }
-    panel_map_update(0, 0, gameadd.map_subtiles_x + 1, gameadd.map_subtiles_y + 1);
+    panel_map_update_all_sliced();
 }
 
 void activate_dungeon_special(struct Thing *cratetng, struct PlayerInfo *player)
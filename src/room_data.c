@@ -54,6 +54,7 @@
 #include "frontmenu_ingame_map.h"
 #include "keeperfx.hpp"
 #include "config_spritecolors.h"
+#include "api.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -272,10 +273,80 @@ long count_slabs_of_room_type(PlayerNumber plyr_idx, RoomKind rkind)
     return nslabs;
 }
 
-void get_room_kind_total_and_used_capacity(struct Dungeon *dungeon, RoomKind rkind, long *total_cap, long *used_cap)
+/**
+ * Capacity totals of each dungeon's rooms of one kind, kept outside of the game structure.
+ * Rooms mark them as outdated when their capacity changes; they're recomputed on the next query.
+ */
+struct RoomKindCapacity {
+    long total_capacity;
+    long used_capacity;
+    /** Sum of spare capacity of the rooms which have any. */
+    long spare_capacity;
+    /** Largest spare capacity of a room, and the first room in the list which has it. */
+    long max_spare;
+    RoomIndex max_spare_room;
+    /** List head and rooms count at the time of computing, to notice list changes. */
+    RoomIndex first_room;
+    long rooms_count;
+    TbBool valid;
+};
+
+static struct RoomKindCapacity room_kind_capacity[DUNGEONS_COUNT][TERRAIN_ITEMS_MAX];
+/** Increased on every change of the player's rooms capacity, for caches which depend on it. */
+static unsigned long room_capacity_generation[DUNGEONS_COUNT];
+
+/**
+ * Marks capacity totals of all rooms as outdated; to be used when rooms are loaded or restored.
+ */
+void clear_room_capacity_cache(void)
 {
-    unsigned int total_capacity = 0;
-    unsigned int used_capacity = 0;
+    for (long plyr_idx = 0; plyr_idx < DUNGEONS_COUNT; plyr_idx++)
+    {
+        for (long rkind = 0; rkind < TERRAIN_ITEMS_MAX; rkind++)
+            room_kind_capacity[plyr_idx][rkind].valid = false;
+        room_capacity_generation[plyr_idx]++;
+    }
+}
+
+static void invalidate_room_kind_capacity(PlayerNumber plyr_idx, RoomKind rkind)
+{
+    if ((plyr_idx >= 0) && (plyr_idx < DUNGEONS_COUNT))
+    {
+        room_kind_capacity[plyr_idx][rkind].valid = false;
+        room_capacity_generation[plyr_idx]++;
+    }
+}
+
+/**
+ * Returns a value which changes whenever rooms of the player are added, removed or change capacity.
+ */
+unsigned long get_room_capacity_generation(PlayerNumber plyr_idx)
+{
+    if ((plyr_idx < 0) || (plyr_idx >= DUNGEONS_COUNT))
+        return 0;
+    return room_capacity_generation[plyr_idx];
+}
+
+/**
+ * Informs the capacity totals that used or total capacity of the room has changed.
+ */
+void room_capacity_changed(const struct Room *room)
+{
+    invalidate_room_kind_capacity(room->owner, room->kind);
+}
+
+static const struct RoomKindCapacity *get_room_kind_capacity(const struct Dungeon *dungeon, RoomKind rkind)
+{
+    if (dungeon_invalid(dungeon))
+        return NULL;
+    long plyr_idx = dungeon - &game.dungeon[0];
+    if (plyr_idx >= DUNGEONS_COUNT)
+        return NULL;
+    struct RoomKindCapacity* rkcap = &room_kind_capacity[plyr_idx][rkind];
+    if (rkcap->valid && (rkcap->first_room == dungeon->room_kind[rkind]) && (rkcap->rooms_count == dungeon->room_slabs_count[rkind]))
+        return rkcap;
+    memset(rkcap, 0, sizeof(struct RoomKindCapacity));
+    rkcap->first_room = dungeon->room_kind[rkind];
     long i = dungeon->room_kind[rkind];
     unsigned long k = 0;
     while (i != 0)
@@ -288,8 +359,16 @@ void get_room_kind_total_and_used_capacity(struct Dungeon *dungeon, RoomKind rki
         }
         i = room->next_of_owner;
         // Per-room code
-        used_capacity += room->used_capacity;
-        total_capacity += room->total_capacity;
+        long spare = (long)room->total_capacity - (long)room->used_capacity;
+        rkcap->total_capacity += room->total_capacity;
+        rkcap->used_capacity += room->used_capacity;
+        if (spare > 0)
+            rkcap->spare_capacity += spare;
+        if ((rkcap->max_spare_room == 0) || (spare > rkcap->max_spare))
+        {
+            rkcap->max_spare = spare;
+            rkcap->max_spare_room = room->index;
+        }
         // Per-room code ends
         k++;
         if (k > ROOMS_COUNT)
@@ -298,8 +377,23 @@ void get_room_kind_total_and_used_capacity(struct Dungeon *dungeon, RoomKind rki
           break;
         }
     }
-    *total_cap = total_capacity;
-    *used_cap = used_capacity;
+    rkcap->rooms_count = k;
+    // Mismatch means the list is being modified; don't keep the result then
+    rkcap->valid = (k == dungeon->room_slabs_count[rkind]);
+    return rkcap;
+}
+
+void get_room_kind_total_and_used_capacity(struct Dungeon *dungeon, RoomKind rkind, long *total_cap, long *used_cap)
+{
+    const struct RoomKindCapacity* rkcap = get_room_kind_capacity(dungeon, rkind);
+    if (rkcap == NULL)
+    {
+        *total_cap = 0;
+        *used_cap = 0;
+        return;
+    }
+    *total_cap = rkcap->total_capacity;
+    *used_cap = rkcap->used_capacity;
 }
 
 void get_room_kind_total_used_and_storage_capacity(struct Dungeon *dungeon, RoomKind rkind, long *total_cap, long *used_cap, long *storaged_cap)
@@ -456,6 +550,7 @@ void count_workers_in_room(struct Room *room)
         }
     }
     room->used_capacity += count;
+    room_capacity_changed(room);
 }
 
 void count_slabs_all_only(struct Room *room)
@@ -517,6 +612,91 @@ void count_slabs_pow2_wth_effcncy(struct Room *room)
     room->total_capacity = count;
 }
 
+/**
+ * Slabs of each room in the order of the room slabs list, for access by position in the list.
+ * Rebuilt from the list when needed, so the list stays the only state stored in the game.
+ */
+struct RoomSlabsIndex {
+    SlabCodedCoords *slabs;
+    long capacity;
+    long count;
+    SlabCodedCoords first_slab;
+    TbBool valid;
+};
+
+static struct RoomSlabsIndex room_slabs_index[ROOMS_COUNT];
+
+static void invalidate_room_slabs_index(const struct Room *room)
+{
+    if ((room->index > 0) && (room->index < ROOMS_COUNT))
+        room_slabs_index[room->index].valid = false;
+}
+
+/**
+ * Marks slab indexes of all rooms as outdated; to be used when rooms are loaded or restored.
+ */
+void clear_room_slabs_index(void)
+{
+    for (long i = 0; i < ROOMS_COUNT; i++)
+        room_slabs_index[i].valid = false;
+}
+
+static struct RoomSlabsIndex *get_room_slabs_index(const struct Room *room)
+{
+    if ((room->index <= 0) || (room->index >= ROOMS_COUNT))
+        return NULL;
+    struct RoomSlabsIndex* rsidx = &room_slabs_index[room->index];
+    if (rsidx->valid && (rsidx->count == room->slabs_count) && (rsidx->first_slab == room->slabs_list))
+        return rsidx;
+    if (rsidx->capacity < room->slabs_count)
+    {
+        long capacity = max(room->slabs_count, 2 * rsidx->capacity);
+        SlabCodedCoords* slabs = (SlabCodedCoords *)realloc(rsidx->slabs, capacity * sizeof(SlabCodedCoords));
+        if (slabs == NULL) {
+            ERRORLOG("Cannot allocate slabs index of %d slabs for room %d",(int)room->slabs_count,(int)room->index);
+            return NULL;
+        }
+        rsidx->slabs = slabs;
+        rsidx->capacity = capacity;
+    }
+    long n = 0;
+    SlabCodedCoords slb_num = room->slabs_list;
+    while ((slb_num != 0) && (n < room->slabs_count))
+    {
+        rsidx->slabs[n++] = slb_num;
+        slb_num = get_next_slab_number_in_room(slb_num);
+    }
+    if ((n != room->slabs_count) || (slb_num != 0)) {
+        ERRORLOG("Room %d slabs list has %d slabs, but the room has %d",(int)room->index,(int)n,(int)room->slabs_count);
+        return NULL;
+    }
+    rsidx->count = n;
+    rsidx->first_slab = room->slabs_list;
+    rsidx->valid = true;
+    return rsidx;
+}
+
+/**
+ * Returns slab number at given position in the room slabs list, or 0 if there's no such slab.
+ */
+SlabCodedCoords get_nth_slab_number_in_room(const struct Room *room, long n)
+{
+    if ((n < 0) || (n >= room->slabs_count))
+        return 0;
+    struct RoomSlabsIndex* rsidx = get_room_slabs_index(room);
+    if (rsidx != NULL)
+        return rsidx->slabs[n];
+    // Fall back to sweeping the list
+    SlabCodedCoords slb_num = room->slabs_list;
+    for (; n > 0; n--)
+    {
+        if (slb_num == 0)
+            break;
+        slb_num = get_next_slab_number_in_room(slb_num);
+    }
+    return slb_num;
+}
+
 void delete_room_structure(struct Room *room)
 {
     if (room_is_invalid(room))
@@ -524,6 +704,8 @@ void delete_room_structure(struct Room *room)
         WARNLOG("Attempt to delete invalid room");
         return;
     }
+    invalidate_room_slabs_index(room);
+    room_capacity_changed(room);
     if ((room->alloc_flags & 0x01) != 0)
     {
       // This is almost remove_room_from_players_list(room, room->owner);
@@ -641,6 +823,7 @@ void update_room_total_capacity(struct Room *room)
     if (cb != NULL) {
         cb(room);
     }
+    room_capacity_changed(room);
     SYNCDBG(7, "Finished");
 }
 
@@ -676,6 +859,7 @@ void recount_and_reassociate_room_slabs(struct Room *room)
         }
     }
     room->slabs_count = n;
+    invalidate_room_slabs_index(room);
 }
 
 /** Returns coordinates of slab at mass centre of given room.
@@ -797,6 +981,7 @@ TbBool add_room_to_players_list(struct Room *room, PlayerNumber plyr_idx)
     }
     dungeon->room_kind[room->kind] = room->index; 
     dungeon->room_slabs_count[room->kind]++;
+    invalidate_room_kind_capacity(plyr_idx, room->kind);
     return true;
 }
 
@@ -829,12 +1014,14 @@ TbBool remove_room_from_players_list(struct Room *room, PlayerNumber plyr_idx)
     room->next_of_owner = 0;
     room->prev_of_owner = 0;
     dungeon->room_slabs_count[room->kind]--;
+    invalidate_room_kind_capacity(plyr_idx, room->kind);
     return true;
 }
 
 void add_slab_to_room_tiles_list(struct Room *room, MapSlabCoord slb_x, MapSlabCoord slb_y)
 {
     SlabCodedCoords slb_num = get_slab_number(slb_x, slb_y);
+    invalidate_room_slabs_index(room);
     if (room->slabs_list == 0) {
         room->slabs_list = slb_num;
     } else {
@@ -858,6 +1045,7 @@ void add_slab_to_room_tiles_list(struct Room *room, MapSlabCoord slb_x, MapSlabC
  */
 void add_slab_list_to_room_tiles_list(struct Room *room, SlabCodedCoords slb_num)
 {
+    invalidate_room_slabs_index(room);
     if (room->slabs_list == 0) {
         room->slabs_list = slb_num;
     } else {
@@ -881,6 +1069,7 @@ void add_slab_list_to_room_tiles_list(struct Room *room, SlabCodedCoords slb_num
 void remove_slab_from_room_tiles_list(struct Room *room, MapSlabCoord slb_x, MapSlabCoord slb_y)
 {
     SlabCodedCoords slb_num = get_slab_number(slb_x, slb_y);
+    invalidate_room_slabs_index(room);
 
     struct SlabMap* rmslb = get_slabmap_direct(slb_num);
     if (slabmap_block_invalid(rmslb))
@@ -1305,6 +1494,7 @@ TbBool update_room_contents(struct Room *room)
     if (cb != NULL) {
         cb(room);
     }
+    room_capacity_changed(room);
     return true;
 }
 
@@ -1339,6 +1529,7 @@ struct Room* link_adjacent_rooms_of_type(PlayerNumber owner, MapSubtlCoord x, Ma
             {
                 // Add the central slab to room which was found
                 room->total_capacity = 0;
+                room_capacity_changed(room);
                 add_slab_to_room_tiles_list(room, central_slb_x, central_slb_y);
                 linkroom = room;
                 break;
@@ -1516,13 +1707,7 @@ TbBool find_random_valid_position_for_thing_in_room(struct Thing *thing, struct
     int navi_radius = abs(thing_nav_block_sizexy(thing) << 8) >> 1;
     unsigned long k;
     long n = CREATURE_RANDOM(thing, room->slabs_count);
-    SlabCodedCoords slbnum = room->slabs_list;
-    for (k = n; k > 0; k--)
-    {
-        if (slbnum == 0)
-            break;
-        slbnum = get_next_slab_number_in_room(slbnum);
-    }
+    SlabCodedCoords slbnum = get_nth_slab_number_in_room(room, n);
     if (slbnum == 0) {
         ERRORLOG("Taking random slab (%d/%d) in %s index %d failed - internal inconsistency.",(int)n,(int)room->slabs_count,room_code_name(room->kind),(int)room->index);
         slbnum = room->slabs_list;
@@ -1615,12 +1800,7 @@ TbBool find_random_position_at_area_of_room(struct Coord3d *pos, const struct Ro
 {
     // Find a random slab in the room to be used as our starting point
     long i = CREATURE_RANDOM(thing, room->slabs_count);
-    unsigned long n = room->slabs_list;
-    while (i > 0)
-    {
-        n = get_next_slab_number_in_room(n);
-        i--;
-    }
+    unsigned long n = get_nth_slab_number_in_room(room, i);
     // Now loop starting from that point
     i = room->slabs_count;
     while (i > 0)
@@ -1747,6 +1927,10 @@ struct Room *find_room_of_role_with_spare_capacity(PlayerNumber owner, RoomRole
     {
         if(room_role_matches(rkind,rrole))
         {
+            // Skip the kind if no room has enough spare capacity
+            const struct RoomKindCapacity* rkcap = get_room_kind_capacity(dungeon, rkind);
+            if ((rkcap != NULL) && ((rkcap->max_spare_room == 0) || (rkcap->max_spare < spare)))
+                continue;
             room = find_nth_room_of_owner_with_spare_capacity_starting_with(dungeon->room_kind[rkind], 0, spare);
             if(room != INVALID_ROOM)
                 return room;
@@ -1829,45 +2013,23 @@ struct Room *find_room_of_role_with_most_spare_capacity(const struct Dungeon *du
     long loc_total_spare_cap = 0;
     struct Room* max_spare_room = INVALID_ROOM;
     long max_spare_cap = 0;
-    unsigned long k = 0;
 
     for (RoomKind rkind = 0; rkind < game.conf.slab_conf.room_types_count; rkind++)
     {
         if(room_role_matches(rkind,rrole))
         {
-            int i = dungeon->room_kind[rkind];
-            while (i != 0)
+            const struct RoomKindCapacity* rkcap = get_room_kind_capacity(dungeon, rkind);
+            if (rkcap == NULL)
+                continue;
+            loc_total_spare_cap += rkcap->spare_capacity;
+            if (max_spare_cap < rkcap->max_spare)
             {
-                struct Room* room = room_get(i);
-                if (room_is_invalid(room))
-                {
-                    ERRORLOG("Jump to invalid room detected");
-                    break;
-                }
-                i = room->next_of_owner;
-                // Per-room code
-                if (room->total_capacity > room->used_capacity)
-                {
-                    long delta = room->total_capacity - room->used_capacity;
-                    loc_total_spare_cap += delta;
-                    if (max_spare_cap < delta)
-                    {
-                        max_spare_cap = delta;
-                        max_spare_room = room;
-                    }
-                }
-                // Per-room code ends
-                k++;
-                if (k > ROOMS_COUNT)
-                {
-                ERRORLOG("Infinite loop detected when sweeping rooms list");
-                break;
-                }
+                max_spare_cap = rkcap->max_spare;
+                max_spare_room = room_get(rkcap->max_spare_room);
             }
         }
     }
 
-
     if (total_spare_cap != NULL)
     (*total_spare_cap) = loc_total_spare_cap;
     return max_spare_room;
@@ -2714,6 +2876,7 @@ void delete_room_slab_when_no_free_room_structures(MapCoord slb_x, MapCoord slb_
 
     decrease_room_area(room->owner, 1);
     kill_room_slab_and_contents(room->owner, slb_x, slb_y);
+    invalidate_room_slabs_index(room);
     if ( room->slabs_count == 1 )
     {
         delete_room_flag(room);
@@ -3401,6 +3564,11 @@ struct Room *place_room(PlayerNumber owner, RoomKind rkind, MapSubtlCoord stl_x,
         dungeon->lvstats.rooms_constructed++;
     }
     panel_map_update(stl_x, stl_y, STL_PER_SLB, STL_PER_SLB);
+    // Rooms are placed slab by slab; only the first slab of a room is its construction, others extend it
+    if (room->slabs_count == 1)
+    {
+        api_event_with_data("ROOM_BUILT", owner, room_code_name(rkind), stl_x, stl_y);
+    }
     return room;
 }
 
@@ -3496,6 +3664,7 @@ TbBool remove_item_from_room_capacity(struct Room *room)
     }
     room->used_capacity--;
     room->capacity_used_for_storage--;
+    room_capacity_changed(room);
     return true;
 }
 
@@ -3517,6 +3686,7 @@ TbBool add_item_to_room_capacity(struct Room *room, TbBool force)
     }
     room->used_capacity++;
     room->capacity_used_for_storage++;
+    room_capacity_changed(room);
     return true;
 }
 
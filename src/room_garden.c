@@ -59,6 +59,7 @@ TbBool remove_food_from_food_room_if_possible(struct Thing *thing)
     if ( room->used_capacity > 0 )
     {
         room->used_capacity--;
+        room_capacity_changed(room);
     }
     thing->food.life_remaining = game.conf.rules.game.food_life_out_of_hatchery;
     thing->parent_idx = -1;
@@ -319,6 +320,7 @@ void count_food_in_room(struct Room *room)
           room_code_name(room->kind),(int)room->index,(int)room->total_capacity,(int)rrepos.used,(int)room->owner);
     }
     room->capacity_used_for_storage = room->used_capacity;
+    room_capacity_changed(room);
 }
 
 TbBool room_create_new_food_at(struct Room *room, MapSubtlCoord stl_x, MapSubtlCoord stl_y)
@@ -339,6 +341,7 @@ TbBool room_create_new_food_at(struct Room *room, MapSubtlCoord stl_x, MapSubtlC
     }
     int required_cap = get_required_room_capacity_for_object(RoRoF_FoodStorage, foodtng->model, 0);
     room->used_capacity += required_cap;
+    room_capacity_changed(room);
     foodtng->food.life_remaining = (foodtng->max_frames << 8) / foodtng->anim_speed - 1;
     return true;
 }
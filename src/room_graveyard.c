@@ -59,6 +59,7 @@ TbBool add_body_to_graveyard(struct Thing *deadtng, struct Room *room)
         return false;
     }
     room->used_capacity++;
+    room_capacity_changed(room);
     deadtng->corpse.laid_to_rest = 1;
     deadtng->health = game.conf.rules.rooms.graveyard_convert_time;
     return true;
@@ -252,6 +253,7 @@ void count_bodies_in_room(struct Room *room)
         ERRORLOG("The %s index %d capacity %d wasn't enough; %d items belonging to player %d dropped",
           room_code_name(room->kind),(int)room->index,(int)room->total_capacity,(int)rrepos.used,(int)room->owner);
     }
+    room_capacity_changed(room);
 }
 
 /******************************************************************************/
@@ -172,6 +172,7 @@ TbBool add_creature_to_work_room(struct Thing *creatng, struct Room *room, Creat
     if (room->used_capacity + required_cap > room->total_capacity)
         return false;
     room->used_capacity += required_cap;
+    room_capacity_changed(room);
     cctrl->work_room_id = room->index;
     cctrl->prev_in_room = 0;
     if (room->creatures_list != 0)
@@ -208,6 +209,7 @@ TbBool remove_creature_from_specific_room(struct Thing *creatng, struct Room *ro
     int required_cap = get_required_room_capacity_for_job(jobpref, creatng->model);
     if (room->used_capacity >= required_cap) {
         room->used_capacity -= required_cap;
+        room_capacity_changed(room);
     } else {
         WARNLOG("Attempt to remove a creature from room %s with too little used space", room_code_name(room->kind));
     }
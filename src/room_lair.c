@@ -313,6 +313,7 @@ void count_lair_occupants(struct Room *room)
             break;
         }
     }
+    room_capacity_changed(room);
 }
 
 struct Thing *find_lair_totem_at(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
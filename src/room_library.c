@@ -780,5 +780,6 @@ void count_books_in_room(struct Room *room)
         }      
     }
     room->capacity_used_for_storage = room->used_capacity;
+    room_capacity_changed(room);
 }
 /******************************************************************************/
@@ -200,5 +200,6 @@ void count_gold_hoardes_in_room(struct Room *room)
     }
     room->capacity_used_for_storage = all_gold_amount;
     room->used_capacity = all_wealth_size;
+    room_capacity_changed(room);
 }
 /******************************************************************************/
@@ -43,6 +43,7 @@
 #include "keeperfx.hpp"
 #include "frontend.h"
 #include "math.h"
+#include "net_sync.h"
 #include "post_inc.h"
 
 /******************************************************************************/
@@ -145,12 +146,13 @@ void process_rooms(void)
       if (room_role_matches(room->kind, RoRoF_FoodSpawn)) {
           room_grow_food(room);
       }
-      sum += room->slabs_count + room->central_stl_x + room->central_stl_y + room->efficiency + room->used_capacity;
+      sum += get_room_checksum(room);
       if (room_has_surrounding_flames(room->kind) && ((game.numfield_D & GNFldD_Unkn40) != 0)) {
           process_room_surrounding_flames(room);
       }
   }
   player_packet_checksum_add(my_player_number, sum, "rooms");
+  state_hash_set(SHK_Rooms, sum);
   recompute_rooms_count_in_dungeons();
   SYNCDBG(9,"Finished");
 }
@@ -926,5 +926,6 @@ void count_crates_in_room(struct Room *room)
           room_code_name(room->kind),(int)room->index,(int)room->total_capacity,(int)rrepos.used,(int)room->owner);
     }
     room->capacity_used_for_storage = room->used_capacity;
+    room_capacity_changed(room);
 }
 /******************************************************************************/
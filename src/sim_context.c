@@ -0,0 +1,251 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file sim_context.c
+ *     Storing and switching complete world state of a simulated match.
+ * @par Purpose:
+ *     Defines which memory makes the world state, so that it can be stored,
+ *     restored and rolled back in one consistent way, and allows keeping
+ *     several matches in one process by switching between their states.
+ * @par Comment:
+ *     Game logic reads the world from global structures, so only one match
+ *     may be simulated at a time, and only from one thread. There is no
+ *     separate simulation-only library; contexts are used within the game.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#include "pre_inc.h"
+#include "sim_context.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "globals.h"
+#include "bflib_basics.h"
+#include "bflib_sound.h"
+#include "ariadne.h"
+#include "game_legacy.h"
+#include "light_data.h"
+#include "magic.h"
+#include "map_arena.h"
+#include "map_blocks.h"
+#include "map_columns.h"
+#include "map_events.h"
+#include "net_sync.h"
+#include "packets.h"
+#include "room_data.h"
+#include "thing_list.h"
+#include "keeperfx.hpp"
+#include "post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+/**
+ * Fills given array with memory regions which hold the world state.
+ * Map arrays are reallocated on level start, so the regions are valid until then.
+ * @return Amount of regions filled, or 0 if the array is too small.
+ */
+int sim_world_regions(struct TbRollbackRegion *regions, int max_count)
+{
+    if (max_count < SIM_WORLD_REGIONS_COUNT)
+        return 0;
+    regions[0].ptr = &game;
+    regions[0].size = sizeof(struct Game);
+    regions[1].ptr = &gameadd;
+    regions[1].size = sizeof(struct GameAdd);
+    regions[2].ptr = &intralvl;
+    regions[2].size = sizeof(struct IntralevelData);
+    regions[3].ptr = map_arena.data;
+    regions[3].size = map_arena.size;
+    if (navigation_state_regions(&regions[4], max_count - 4) <= 0)
+        return 0;
+    return SIM_WORLD_REGIONS_COUNT;
+}
+
+/**
+ * Size of the triangulation regions, which don't depend on the map size.
+ */
+static size_t sim_navigation_size(void)
+{
+    struct TbRollbackRegion regions[NAVIGATION_STATE_REGIONS_COUNT];
+    int count = navigation_state_regions(regions, NAVIGATION_STATE_REGIONS_COUNT);
+    size_t size = 0;
+    for (int i = 0; i < count; i++)
+        size += regions[i].size;
+    return size;
+}
+
+/**
+ * Clears caches derived from the world state.
+ * Needs to be called whenever the world state is replaced, not simulated.
+ */
+void clear_world_caches(void)
+{
+    clear_explore_cache();
+    clear_room_slabs_index();
+    clear_room_capacity_cache();
+    clear_events_index();
+    clear_power_sight_cache();
+}
+
+/**
+ * Puts the game data which is kept outside of the world regions into them.
+ * Needs to be called before the world regions are copied.
+ */
+void sim_world_export_state(void)
+{
+    light_export_system_state(&gameadd.lightst);
+    navigation_export_state();
+}
+
+/**
+ * Rebuilds state derived from the world, after the world regions were copied
+ * back from a stored state of this game. Unlike reinit_level_after_load(),
+ * doesn't touch anything which is local to the player or loaded from files.
+ * Triangulation is restored with the world rather than made again, as the
+ * new one wouldn't be the same.
+ */
+void sim_world_rebuild_derived(void)
+{
+    init_columns_lookup();
+    things_hot_rebuild();
+    navigation_import_state();
+    state_hash_rebuild();
+    light_import_system_state(&gameadd.lightst);
+    clear_world_caches();
+}
+
+/**
+ * Copies the triangulation regions into given buffer, or back from it.
+ */
+static void sim_navigation_copy(unsigned char *buf, TbBool store)
+{
+    struct TbRollbackRegion regions[NAVIGATION_STATE_REGIONS_COUNT];
+    int count = navigation_state_regions(regions, NAVIGATION_STATE_REGIONS_COUNT);
+    for (int i = 0; i < count; i++)
+    {
+        if (store)
+            memcpy(buf, regions[i].ptr, regions[i].size);
+        else
+            memcpy(regions[i].ptr, buf, regions[i].size);
+        buf += regions[i].size;
+    }
+}
+
+TbBool sim_context_alloc(struct SimContext *ctx)
+{
+    memset(ctx, 0, sizeof(struct SimContext));
+    ctx->game = (struct Game *)malloc(sizeof(struct Game));
+    ctx->gameadd = (struct GameAdd *)malloc(sizeof(struct GameAdd));
+    ctx->intralvl = (struct IntralevelData *)malloc(sizeof(struct IntralevelData));
+    ctx->navigation_data = (unsigned char *)malloc(sim_navigation_size());
+    if ((ctx->game == NULL) || (ctx->gameadd == NULL) || (ctx->intralvl == NULL) || (ctx->navigation_data == NULL))
+    {
+        ERRORLOG("Cannot allocate simulation context");
+        sim_context_free(ctx);
+        return false;
+    }
+    return true;
+}
+
+void sim_context_free(struct SimContext *ctx)
+{
+    free(ctx->game);
+    free(ctx->gameadd);
+    free(ctx->intralvl);
+    free(ctx->navigation_data);
+    free(ctx->map_data);
+    memset(ctx, 0, sizeof(struct SimContext));
+}
+
+/**
+ * Stores the world state of currently simulated match in given context.
+ */
+TbBool sim_context_store(struct SimContext *ctx)
+{
+    if (ctx->game == NULL)
+    {
+        ERRORLOG("Simulation context not allocated");
+        return false;
+    }
+    if (ctx->map_size != map_arena.size)
+    {
+        unsigned char* map_data = (unsigned char *)realloc(ctx->map_data, map_arena.size);
+        if ((map_data == NULL) && (map_arena.size > 0))
+        {
+            ERRORLOG("Cannot allocate %lu bytes for map of simulation context",map_arena.size);
+            return false;
+        }
+        ctx->map_data = map_data;
+        ctx->map_size = map_arena.size;
+    }
+    // Some game data is outside of structs - make sure it is updated
+    sim_world_export_state();
+    memcpy(ctx->game, &game, sizeof(struct Game));
+    memcpy(ctx->gameadd, &gameadd, sizeof(struct GameAdd));
+    memcpy(ctx->intralvl, &intralvl, sizeof(struct IntralevelData));
+    memcpy(ctx->map_data, map_arena.data, map_arena.size);
+    sim_navigation_copy(ctx->navigation_data, true);
+    ctx->map_tiles_x = map_arena.tiles_x;
+    ctx->map_tiles_y = map_arena.tiles_y;
+    ctx->stored = true;
+    SYNCDBG(8,"Stored match at turn %lu",(unsigned long)game.play_gameturn);
+    return true;
+}
+
+/**
+ * Makes the match stored in given context the currently simulated one.
+ * The context has to be stored by this process; only state derived from
+ * the world is rebuilt, nothing is loaded and the local view is kept.
+ */
+TbBool sim_context_restore(const struct SimContext *ctx)
+{
+    if (!ctx->stored)
+    {
+        ERRORLOG("Simulation context holds no match");
+        return false;
+    }
+    if (!map_arena_alloc(ctx->map_tiles_x, ctx->map_tiles_y))
+        return false;
+    memcpy(&game, ctx->game, sizeof(struct Game));
+    memcpy(&gameadd, ctx->gameadd, sizeof(struct GameAdd));
+    memcpy(&intralvl, ctx->intralvl, sizeof(struct IntralevelData));
+    memcpy(map_arena.data, ctx->map_data, map_arena.size);
+    sim_navigation_copy(ctx->navigation_data, false);
+    sim_world_rebuild_derived();
+    SYNCDBG(8,"Restored match at turn %lu",(unsigned long)game.play_gameturn);
+    return true;
+}
+
+/**
+ * Simulates given amount of turns of the match stored in given context,
+ * and stores it back. Only the world is simulated, without input from
+ * human players and without sounds; runs within the game executable, on
+ * the thread which owns the globals.
+ * The match which was current before is replaced; store it first if needed.
+ */
+TbBool sim_context_step(struct SimContext *ctx, GameTurn turns)
+{
+    if (!sim_context_restore(ctx))
+        return false;
+    TbBool sound_disabled = SoundDisabled;
+    SoundDisabled = true;
+    for (GameTurn i = 0; i < turns; i++)
+    {
+        clear_packets();
+        update_game_world();
+    }
+    SoundDisabled = sound_disabled;
+    return sim_context_store(ctx);
+}
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,71 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file sim_context.h
+ *     Header file for sim_context.c.
+ * @par Purpose:
+ *     Storing and switching complete world state of a simulated match.
+ * @par Comment:
+ *     Just a header file - #defines, typedefs, function prototypes etc.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#ifndef DK_SIMCONTEXT_H
+#define DK_SIMCONTEXT_H
+
+#include "globals.h"
+#include "bflib_basics.h"
+#include "bflib_rollback.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+/** Amount of memory regions which make the world state; game structures, map arrays and the triangulation. */
+#define SIM_WORLD_REGIONS_COUNT 8
+/******************************************************************************/
+struct Game;
+struct GameAdd;
+struct IntralevelData;
+
+/**
+ * World state of one match, stored outside of the global structures.
+ * Matches are simulated one at a time, on one thread; the context of a match
+ * is restored into the globals before stepping it, and stored back afterwards.
+ */
+struct SimContext {
+    struct Game *game;
+    struct GameAdd *gameadd;
+    struct IntralevelData *intralvl;
+    /** Copy of the triangulation regions, one after another. */
+    unsigned char *navigation_data;
+    /** Copy of map arrays; sized for the map of the stored match. */
+    unsigned char *map_data;
+    unsigned long map_size;
+    MapSlabCoord map_tiles_x;
+    MapSlabCoord map_tiles_y;
+    /** Set once the context holds a stored state. */
+    TbBool stored;
+};
+/******************************************************************************/
+int sim_world_regions(struct TbRollbackRegion *regions, int max_count);
+void clear_world_caches(void);
+void sim_world_export_state(void);
+void sim_world_rebuild_derived(void);
+
+TbBool sim_context_alloc(struct SimContext *ctx);
+void sim_context_free(struct SimContext *ctx);
+TbBool sim_context_store(struct SimContext *ctx);
+TbBool sim_context_restore(const struct SimContext *ctx);
+TbBool sim_context_step(struct SimContext *ctx, GameTurn turns);
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+#endif
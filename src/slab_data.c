@@ -31,6 +31,8 @@
 #include "game_legacy.h"
 #include "creature_states.h"
 #include "map_data.h"
+#include "net_sync.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -74,7 +76,7 @@ struct SlabMap *get_slabmap_direct(SlabCodedCoords slab_num)
 {
   if (slab_num >= gameadd.map_tiles_x*gameadd.map_tiles_y)
       return INVALID_SLABMAP_BLOCK;
-  return &game.slabmap[slab_num];
+  return &map_arena.slabmap[slab_num];
 }
 
 /**
@@ -86,7 +88,7 @@ struct SlabMap *get_slabmap_block(MapSlabCoord slab_x, MapSlabCoord slab_y)
       return INVALID_SLABMAP_BLOCK;
   if ((slab_y < 0) || (slab_y >= gameadd.map_tiles_y))
       return INVALID_SLABMAP_BLOCK;
-  return &game.slabmap[slab_y*(gameadd.map_tiles_x) + slab_x];
+  return &map_arena.slabmap[slab_y*(gameadd.map_tiles_x) + slab_x];
 }
 
 /**
@@ -100,7 +102,7 @@ struct SlabMap *get_slabmap_for_subtile(MapSubtlCoord stl_x, MapSubtlCoord stl_y
         return INVALID_SLABMAP_BLOCK;
     if ((stl_y < 0) || (stl_y >= gameadd.map_subtiles_y))
         return INVALID_SLABMAP_BLOCK;
-    return &game.slabmap[subtile_slab(stl_y)*(gameadd.map_tiles_x) + subtile_slab(stl_x)];
+    return &map_arena.slabmap[subtile_slab(stl_y)*(gameadd.map_tiles_x) + subtile_slab(stl_x)];
 }
 
 /**
@@ -131,7 +133,7 @@ TbBool slabmap_block_invalid(const struct SlabMap *slb)
         return true;
     if (slb == INVALID_SLABMAP_BLOCK)
         return true;
-    return (slb < &game.slabmap[0]);
+    return (slb < &map_arena.slabmap[0]);
 }
 
 /**
@@ -169,13 +171,15 @@ void set_slab_owner(MapSlabCoord slb_x, MapSlabCoord slb_y, PlayerNumber owner)
     struct Dungeon *dungeon = get_dungeon(owner);
     if (dungeon->texture_pack == 0)
     {
-        gameadd.slab_ext_data[get_slab_number(slb_x,slb_y)] = gameadd.slab_ext_data_initial[get_slab_number(slb_x,slb_y)];
+        map_arena.slab_ext_data[get_slab_number(slb_x,slb_y)] = map_arena.slab_ext_data_initial[get_slab_number(slb_x,slb_y)];
     }
     else
     {
-        gameadd.slab_ext_data[get_slab_number(slb_x,slb_y)] = dungeon->texture_pack;
+        map_arena.slab_ext_data[get_slab_number(slb_x,slb_y)] = dungeon->texture_pack;
     }
     slb->owner = owner;
+    state_hash_slab_changed(slb_x, slb_y);
+    explore_cache_slab_changed(slb_x, slb_y);
 }
 
 /**
@@ -208,7 +212,7 @@ SlabCodedCoords get_next_slab_number_in_room(SlabCodedCoords slab_num)
         ERRORLOG("Slabnumber %lu exceeds map dimensions %d*%d", slab_num, gameadd.map_tiles_x, gameadd.map_tiles_y);
         return 0;
     }
-    return game.slabmap[slab_num].next_in_room;
+    return map_arena.slabmap[slab_num].next_in_room;
 }
 
 TbBool slab_is_safe_land(PlayerNumber plyr_idx, MapSlabCoord slb_x, MapSlabCoord slb_y)
@@ -423,11 +427,13 @@ int check_room_at_slab_loose(PlayerNumber plyr_idx, RoomKind rkind, MapSlabCoord
  */
 void clear_slabs(void)
 {
+    if (map_arena.data == NULL)
+        return;
     for (unsigned long y = 0; y < gameadd.map_tiles_y; y++)
     {
         for (unsigned long x = 0; x < gameadd.map_tiles_x; x++)
         {
-            struct SlabMap* slb = &game.slabmap[y * gameadd.map_tiles_x + x];
+            struct SlabMap* slb = &map_arena.slabmap[y * gameadd.map_tiles_x + x];
             memset(slb, 0, sizeof(struct SlabMap));
             slb->kind = SlbT_ROCK;
         }
@@ -164,6 +164,7 @@ void remove_body_from_graveyard(struct Thing *thing)
         return;
     }
     room->used_capacity--;
+    room_capacity_changed(room);
     thing->corpse.laid_to_rest = 0;
     struct Dungeon* dungeon = get_dungeon(room->owner);
     dungeon->bodies_rotten_for_vampire++;
@@ -94,6 +94,8 @@
 #include "thing_traps.h"
 
 #include "keeperfx.hpp"
+#include "api.h"
+#include "map_arena.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -3265,6 +3267,8 @@ struct Thing* kill_creature(struct Thing *creatng, struct Thing *killertng, Play
         ERRORLOG("Tried to kill non-existing thing!");
         return INVALID_THING;
     }
+    api_event_with_data("CREATURE_DIED", creatng->owner, creature_code_name(creatng->model),
+        creatng->mappos.x.stl.num, creatng->mappos.y.stl.num);
     // Remember if the creature is frozen.
     TbBool frozen = creature_under_spell_effect(creatng, CSAfF_Freeze);
     // Terminate all the actives spell effects on dying creatures.
@@ -6002,7 +6006,7 @@ ThingModel get_footstep_effect_element(struct Thing* thing)
     };
 
     short texture;
-        unsigned char ext_txtr = gameadd.slab_ext_data[get_slab_number(subtile_slab(thing->mappos.x.stl.num), subtile_slab(thing->mappos.y.stl.num))];
+        unsigned char ext_txtr = map_arena.slab_ext_data[get_slab_number(subtile_slab(thing->mappos.x.stl.num), subtile_slab(thing->mappos.y.stl.num))];
     if (ext_txtr == 0)
     {
         // Default map texture
@@ -35,6 +35,7 @@
 #include "engine_arrays.h"
 #include "kjm_input.h"
 #include "gui_topmsg.h" 
+#include "net_sync.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -176,6 +177,7 @@ void delete_thing_structure_f(struct Thing *thing, long a2, const char *func_nam
     }
     remove_thing_from_its_class_list(thing);
     remove_thing_from_mapwho(thing);
+    state_hash_remove_thing(thing);
     if (thing->index > 0)
     {
         game.free_things_start_index--;
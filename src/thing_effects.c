@@ -43,6 +43,7 @@
 #include "thing_list.h"
 #include "thing_navigate.h"
 #include "thing_objects.h"
+#include "thing_particles.h"
 #include "thing_physics.h"
 #include "thing_shots.h"
 #include "thing_stats.h"
@@ -180,6 +181,27 @@ struct Thing *create_effect_element(const struct Coord3d *pos, ThingModel eelmod
     return thing;
 }
 
+/**
+ * Creates effect element which is only displayed, and never used afterwards.
+ * Elements which don't affect the game are created as particles rather than things.
+ * @return True if the element was created.
+ */
+TbBool create_cosmetic_effect_element(const struct Coord3d *pos, ThingModel eelmodel, PlayerNumber owner)
+{
+    if (effect_element_is_cosmetic(eelmodel)) {
+        return (create_effect_particle(pos, eelmodel) >= 0);
+    }
+    return !thing_is_invalid(create_effect_element(pos, eelmodel, owner));
+}
+
+static long effect_element_random(const struct Thing *thing, TbBool is_particle, long range)
+{
+    if (is_particle) {
+        return effect_particle_random(range);
+    }
+    return EFFECT_RANDOM(thing, range);
+}
+
 void process_spells_affected_by_effect_elements(struct Thing *thing)
 {
     struct CreatureStats* crstat;
@@ -211,10 +233,18 @@ void process_spells_affected_by_effect_elements(struct Thing *thing)
             shift_y = -(radius * LbCosL(angle) >> 8) >> 8;
             pos.x.val = thing->mappos.x.val + shift_x;
             pos.y.val = thing->mappos.y.val + shift_y;
-            effeltng = create_thing(&pos, TCls_EffectElem, TngEffElm_FlashBall1, thing->owner, -1);
-            if (thing_is_invalid(effeltng))
-                break;
-            set_thing_draw(effeltng, eestat->sprite_idx, 256, eestat->sprite_size_min, 0, cframe, ODC_Default);
+            if (effect_element_is_cosmetic(TngEffElm_FlashBall1))
+            {
+                long pidx = create_effect_particle(&pos, TngEffElm_FlashBall1);
+                if (pidx >= 0)
+                    effect_particle_set_frame(pidx, cframe, 256);
+            } else
+            {
+                effeltng = create_thing(&pos, TCls_EffectElem, TngEffElm_FlashBall1, thing->owner, -1);
+                if (thing_is_invalid(effeltng))
+                    break;
+                set_thing_draw(effeltng, eestat->sprite_idx, 256, eestat->sprite_size_min, 0, cframe, ODC_Default);
+            }
             dtadd++;
             pos.z.val += 64;
             cframe = (cframe + 1) % nframes;
@@ -242,52 +272,27 @@ void process_spells_affected_by_effect_elements(struct Thing *thing)
             shift_y = -(radius * LbCosL(angle) >> 8) >> 8;
             pos.x.val = thing->mappos.x.val + shift_x;
             pos.y.val = thing->mappos.y.val + shift_y;
-            effeltng = create_thing(&pos, TCls_EffectElem, TngEffElm_RedFlash, thing->owner, -1);
+            create_cosmetic_effect_element(&pos, TngEffElm_RedFlash, thing->owner);
         }
     }
     // Effect elements related to Flight.
     if (creature_under_spell_effect(thing, CSAfF_Flying))
     {
-        effeltng = create_thing(&thing->mappos, TCls_EffectElem, TngEffElm_CloudDisperse, thing->owner, -1);
+        create_cosmetic_effect_element(&thing->mappos, TngEffElm_CloudDisperse, thing->owner);
     }
     // Effect elements related to Speed.
     if (creature_under_spell_effect(thing, CSAfF_Speed))
     {
-        effeltng = create_effect_element(&thing->mappos, TngEffElm_FlashBall2, thing->owner);
-        if (!thing_is_invalid(effeltng))
+        if (effect_element_is_cosmetic(TngEffElm_FlashBall2))
         {
             //make an afterimage of the speeding unit
-            effeltng->anim_time = thing->anim_time;
-            effeltng->anim_sprite = thing->anim_sprite;
-            effeltng->sprite_size = thing->sprite_size;
-            effeltng->current_frame = thing->current_frame;
-            effeltng->max_frames = thing->max_frames;
-            effeltng->transformation_speed = thing->transformation_speed;
-            effeltng->sprite_size_min = thing->sprite_size_min;
-            effeltng->sprite_size_max = thing->sprite_size_max;
-            effeltng->rendering_flags = thing->rendering_flags;
-            effeltng->rendering_flags &= ~TRF_Transpar_8;
-            effeltng->rendering_flags |= TRF_Transpar_4;
-            effeltng->size_change = thing->size_change;
-            effeltng->draw_class = thing->draw_class;
-            effeltng->tint_colour = thing->tint_colour;
-            effeltng->anim_speed = 0;
-            effeltng->move_angle_xy = thing->move_angle_xy;
-        }
-    }
-    // Effect elements related to Teleport.
-    if (flag_is_set(cctrl->stateblock_flags, CCSpl_Teleport))
-    {
-        // Get the duration of the active teleport spell and its duration left.
-        spconf = get_spell_config(cctrl->active_teleport_spell);
-        dturn = get_spell_duration_left_on_thing(thing, cctrl->active_teleport_spell);
-        if (spconf->duration / 2 < dturn)
+            effect_particle_copy_sprite(create_effect_particle(&thing->mappos, TngEffElm_FlashBall2), thing);
+        } else
         {
             effeltng = create_effect_element(&thing->mappos, TngEffElm_FlashBall2, thing->owner);
             if (!thing_is_invalid(effeltng))
             {
-                //make an afterimage of the teleporting unit
-                effeltng->anim_speed = 0;
+                //make an afterimage of the speeding unit
                 effeltng->anim_time = thing->anim_time;
                 effeltng->anim_sprite = thing->anim_sprite;
                 effeltng->sprite_size = thing->sprite_size;
@@ -302,16 +307,55 @@ void process_spells_affected_by_effect_elements(struct Thing *thing)
                 effeltng->size_change = thing->size_change;
                 effeltng->draw_class = thing->draw_class;
                 effeltng->tint_colour = thing->tint_colour;
-                effeltng->rendering_flags &= ~TRF_Transpar_8;
-                effeltng->rendering_flags |= TRF_Transpar_4;
+                effeltng->anim_speed = 0;
                 effeltng->move_angle_xy = thing->move_angle_xy;
             }
+        }
+    }
+    // Effect elements related to Teleport.
+    if (flag_is_set(cctrl->stateblock_flags, CCSpl_Teleport))
+    {
+        // Get the duration of the active teleport spell and its duration left.
+        spconf = get_spell_config(cctrl->active_teleport_spell);
+        dturn = get_spell_duration_left_on_thing(thing, cctrl->active_teleport_spell);
+        if (spconf->duration / 2 < dturn)
+        {
+            if (effect_element_is_cosmetic(TngEffElm_FlashBall2))
+            {
+                //make an afterimage of the teleporting unit
+                effect_particle_copy_sprite(create_effect_particle(&thing->mappos, TngEffElm_FlashBall2), thing);
+            } else
+            {
+                effeltng = create_effect_element(&thing->mappos, TngEffElm_FlashBall2, thing->owner);
+                if (!thing_is_invalid(effeltng))
+                {
+                    //make an afterimage of the teleporting unit
+                    effeltng->anim_speed = 0;
+                    effeltng->anim_time = thing->anim_time;
+                    effeltng->anim_sprite = thing->anim_sprite;
+                    effeltng->sprite_size = thing->sprite_size;
+                    effeltng->current_frame = thing->current_frame;
+                    effeltng->max_frames = thing->max_frames;
+                    effeltng->transformation_speed = thing->transformation_speed;
+                    effeltng->sprite_size_min = thing->sprite_size_min;
+                    effeltng->sprite_size_max = thing->sprite_size_max;
+                    effeltng->rendering_flags = thing->rendering_flags;
+                    effeltng->rendering_flags &= ~TRF_Transpar_8;
+                    effeltng->rendering_flags |= TRF_Transpar_4;
+                    effeltng->size_change = thing->size_change;
+                    effeltng->draw_class = thing->draw_class;
+                    effeltng->tint_colour = thing->tint_colour;
+                    effeltng->rendering_flags &= ~TRF_Transpar_8;
+                    effeltng->rendering_flags |= TRF_Transpar_4;
+                    effeltng->move_angle_xy = thing->move_angle_xy;
+                }
+            }
         } else
         if (spconf->duration / 2 > dturn)
         {
             crstat = creature_stats_get_from_thing(thing);
             if ((dturn % 2) == 0) {
-                effeltng = create_effect_element(&thing->mappos, birth_effect_element[get_player_color_idx(thing->owner)], thing->owner);
+                create_cosmetic_effect_element(&thing->mappos, birth_effect_element[get_player_color_idx(thing->owner)], thing->owner);
             }
             creature_turn_to_face_angle(thing, thing->move_angle_xy + crstat->max_turning_speed);
         }
@@ -463,7 +507,7 @@ TngUpdateRet update_effect_element(struct Thing *elemtng)
     if (i > 0)
     {
       if (((elemtng->creation_turn - game.play_gameturn) % i) == 0) {
-          create_effect_element(&elemtng->mappos, eestats->subeffect_model, elemtng->owner);
+          create_cosmetic_effect_element(&elemtng->mappos, eestats->subeffect_model, elemtng->owner);
       }
     }
     switch (eestats->move_type)
@@ -685,23 +729,40 @@ void effect_generate_effect_elements(const struct Thing *thing)
             if (effcst->kind_min <= 0)
                 continue;
             long n = effcst->kind_min + EFFECT_RANDOM(thing, effcst->kind_max - effcst->kind_min + 1);
-            elemtng = create_effect_element(&thing->mappos, n, thing->owner);
-            TRACE_THING(elemtng);
-            if (thing_is_invalid(elemtng))
-                break;
-            arg = EFFECT_RANDOM(thing, 0x800);
-            argZ = EFFECT_RANDOM(thing, 0x400);
+            TbBool is_particle = effect_element_is_cosmetic(n);
+            long pidx = -1;
+            if (is_particle)
+            {
+                pidx = create_effect_particle(&thing->mappos, n);
+                // Particles are not synced; failing to create one must not skip the synced draws of next elements
+                if (pidx < 0)
+                    continue;
+            } else
+            {
+                elemtng = create_effect_element(&thing->mappos, n, thing->owner);
+                TRACE_THING(elemtng);
+                if (thing_is_invalid(elemtng))
+                    break;
+            }
+            arg = effect_element_random(thing, is_particle, 0x800);
+            argZ = effect_element_random(thing, is_particle, 0x400);
             // Setting XY acceleration
             long k = abs(effcst->accel_xy_max - effcst->accel_xy_min);
             if (k <= 1) k = 1;
-            long mag = effcst->accel_xy_min + EFFECT_RANDOM(thing, k);
-            elemtng->veloc_push_add.x.val += distance_with_angle_to_coord_x(mag,arg);
-            elemtng->veloc_push_add.y.val += distance_with_angle_to_coord_y(mag,arg);
+            long mag_xy = effcst->accel_xy_min + effect_element_random(thing, is_particle, k);
             // Setting Z acceleration
             k = abs(effcst->accel_z_max - effcst->accel_z_min);
             if (k <= 1) k = 1;
-            mag = effcst->accel_z_min + EFFECT_RANDOM(thing, k);
-            elemtng->veloc_push_add.z.val += distance_with_angle_to_coord_z(mag,argZ);
+            long mag_z = effcst->accel_z_min + effect_element_random(thing, is_particle, k);
+            if (is_particle)
+            {
+                effect_particle_push(pidx, distance_with_angle_to_coord_x(mag_xy,arg),
+                    distance_with_angle_to_coord_y(mag_xy,arg), distance_with_angle_to_coord_z(mag_z,argZ));
+                continue;
+            }
+            elemtng->veloc_push_add.x.val += distance_with_angle_to_coord_x(mag_xy,arg);
+            elemtng->veloc_push_add.y.val += distance_with_angle_to_coord_y(mag_xy,arg);
+            elemtng->veloc_push_add.z.val += distance_with_angle_to_coord_z(mag_z,argZ);
             elemtng->state_flags |= TF1_PushAdd;
         }
         break;
@@ -716,9 +777,7 @@ void effect_generate_effect_elements(const struct Thing *thing)
             HitPoints mag = effcst->start_health - thing->health;
             arg = (mag << 7) + k/effcst->elements_count;
             set_coords_to_cylindric_shift(&pos, &thing->mappos, mag, arg, 0);
-            elemtng = create_effect_element(&pos, n, thing->owner);
-            TRACE_THING(elemtng);
-            SYNCDBG(18,"Created %s",thing_model_name(elemtng));
+            create_cosmetic_effect_element(&pos, n, thing->owner);
             k += 2048;
         }
         break;
@@ -733,8 +792,7 @@ void effect_generate_effect_elements(const struct Thing *thing)
             HitPoints mag = thing->health;
             arg = (mag << 7) + k/effcst->elements_count;
             set_coords_to_cylindric_shift(&pos, &thing->mappos, 16*mag, arg, 0);
-            elemtng = create_effect_element(&pos, n, thing->owner);
-            TRACE_THING(elemtng);
+            create_cosmetic_effect_element(&pos, n, thing->owner);
             k += 2048;
         }
         break;
@@ -36,6 +36,7 @@
 #include "thing_navigate.h"
 #include "creature_senses.h"
 #include "spdigger_stack.h"
+#include "dungeon_stats.h"
 #include "power_hand.h"
 #include "magic.h"
 #include "map_utils.h"
@@ -48,6 +49,7 @@
 #include "game_legacy.h"
 #include "keeperfx.hpp"
 #include "bflib_planar.h"
+#include "net_sync.h"
 #include "post_inc.h"
 
 #ifdef __cplusplus
@@ -76,7 +78,40 @@ Thing_Class_Func class_functions[] = {
 };
 
 unsigned long thing_create_errors = 0;
+struct ThingsHotData things_hot;
 /******************************************************************************/
+static inline void things_hot_update_next_on_mapblk(const struct Thing *thing)
+{
+    if (thing->index < THINGS_COUNT)
+        things_hot.next_on_mapblk[thing->index] = thing->next_on_mapblk;
+}
+
+static inline void things_hot_update_next_of_class(const struct Thing *thing)
+{
+    if (thing->index < THINGS_COUNT)
+        things_hot.next_of_class[thing->index] = thing->next_of_class;
+}
+
+static inline void things_hot_update_class(const struct Thing *thing)
+{
+    if (thing->index < THINGS_COUNT)
+        things_hot.class_id[thing->index] = thing->class_id;
+}
+
+/**
+ * Fills the hot fields copy from things array.
+ * Needs to be called whenever things are modified in bulk, ie. after load or clearing.
+ */
+void things_hot_rebuild(void)
+{
+    for (long i = 0; i < THINGS_COUNT; i++)
+    {
+        const struct Thing* thing = &game.things_data[i];
+        things_hot.next_on_mapblk[i] = thing->next_on_mapblk;
+        things_hot.next_of_class[i] = thing->next_of_class;
+        things_hot.class_id[i] = thing->class_id;
+    }
+}
 
 void set_previous_thing_position(struct Thing *thing) {
     thing->previous_mappos = thing->mappos;
@@ -103,6 +138,8 @@ void add_thing_to_list(struct Thing *thing, struct StructureList *list)
     thing->alloc_flags |= TAlF_IsInStrucList;
     thing->prev_of_class = 0;
     thing->next_of_class = list->index;
+    things_hot_update_next_of_class(thing);
+    things_hot_update_class(thing);
     if (!thing_is_invalid(prevtng)) {
         prevtng->prev_of_class = thing->index;
     }
@@ -135,6 +172,7 @@ void remove_thing_from_list(struct Thing *thing, struct StructureList *slist)
             if (!thing_is_invalid(sibtng))
             {
                 sibtng->next_of_class = thing->next_of_class;
+                things_hot_update_next_of_class(sibtng);
             }
         }
         if (thing->next_of_class > 0)
@@ -148,6 +186,7 @@ void remove_thing_from_list(struct Thing *thing, struct StructureList *slist)
         thing->prev_of_class = 0;
         thing->next_of_class = 0;
     }
+    things_hot_update_next_of_class(thing);
     thing->alloc_flags &= ~TAlF_IsInStrucList;
     if (slist->count <= 0) {
         ERRORLOG("List has < 0 structures");
@@ -1040,7 +1079,7 @@ TbBigChecksum update_things_in_list(struct StructureList *list)
           }
       }
       set_previous_thing_position(thing);
-      sum += get_thing_checksum(thing);
+      sum += state_hash_update_thing(thing);
       // Per-thing code ends
       k++;
       if (k > THINGS_COUNT)
@@ -1168,7 +1207,11 @@ void update_things(void)
     player_packet_checksum_add(my_player_number,sum,"creatures");
     sum = 0;
     sum += update_things_in_list(&game.thing_lists[TngList_Traps]);
+    if (game.thing_lists[TngList_Shots].count > 0) {
+        shot_broadphase_build();
+    }
     sum += update_things_in_list(&game.thing_lists[TngList_Shots]);
+    shot_broadphase_clear();
     sum += update_things_in_list(&game.thing_lists[TngList_Objects]);
     sum += update_things_in_list(&game.thing_lists[TngList_Effects]);
     sum += update_things_in_list(&game.thing_lists[TngList_EffectElems]);
@@ -1405,6 +1448,7 @@ void remove_thing_from_mapwho(struct Thing *thing)
         mwtng = thing_get(thing->prev_on_mapblk);
         if (thing_exists(mwtng)) {
             mwtng->next_on_mapblk = thing->next_on_mapblk;
+            things_hot_update_next_on_mapblk(mwtng);
         } else {
             ERRORLOG("Non-existing thing index %d in mapwho before index %d!",(int)thing->prev_on_mapblk,(int)thing->index);
             thing->prev_on_mapblk = 0;
@@ -1431,6 +1475,7 @@ void remove_thing_from_mapwho(struct Thing *thing)
     }
     thing->next_on_mapblk = 0;
     thing->prev_on_mapblk = 0;
+    things_hot_update_next_on_mapblk(thing);
     thing->alloc_flags &= ~TAlF_IsInMapWho;
 }
 
@@ -1453,7 +1498,10 @@ void place_thing_in_mapwho(struct Thing *thing)
     }
     set_mapwho_thing_index(mapblk, thing->index);
     thing->prev_on_mapblk = 0;
+    things_hot_update_next_on_mapblk(thing);
+    things_hot_update_class(thing);
     thing->alloc_flags |= TAlF_IsInMapWho;
+    shot_broadphase_thing_placed(thing);
 }
 
 struct Thing *find_base_thing_on_mapwho(ThingClass oclass, ThingModel model, MapSubtlCoord stl_x, MapSubtlCoord stl_y)
@@ -1463,17 +1511,18 @@ struct Thing *find_base_thing_on_mapwho(ThingClass oclass, ThingModel model, Map
     long i = get_mapwho_thing_index(mapblk);
     while (i != 0)
     {
-        struct Thing* thing = thing_get(i);
-        TRACE_THING(thing);
-        if (thing_is_invalid(thing))
+        if ((i < 0) || (i >= THINGS_COUNT))
         {
             ERRORLOG("Jump to invalid thing detected");
             break;
         }
-        i = thing->next_on_mapblk;
+        long n = i;
+        i = things_hot.next_on_mapblk[n];
         // Per thing code start
-        if (thing->class_id == oclass)
+        if (things_hot.class_id[n] == oclass)
         {
+            struct Thing* thing = thing_get(n);
+            TRACE_THING(thing);
             if ((thing->model == model) || (model == 0)) {
                 return thing;
             }
@@ -1502,17 +1551,18 @@ struct Thing* find_object_of_genre_on_mapwho(long genre, MapSubtlCoord stl_x, Ma
     long i = get_mapwho_thing_index(mapblk);
     while (i != 0)
     {
-        struct Thing* thing = thing_get(i);
-        TRACE_THING(thing);
-        if (thing_is_invalid(thing))
+        if ((i < 0) || (i >= THINGS_COUNT))
         {
             ERRORLOG("Jump to invalid thing detected");
             break;
         }
-        i = thing->next_on_mapblk;
+        long n = i;
+        i = things_hot.next_on_mapblk[n];
         // Per thing code start
-        if (thing->class_id == TCls_Object)
+        if (things_hot.class_id[n] == TCls_Object)
         {
+            struct Thing* thing = thing_get(n);
+            TRACE_THING(thing);
             objst = get_object_model_stats(thing->model);
             if ((objst->genre == genre) || (genre == 0)) {
                 return thing;
@@ -2945,6 +2995,53 @@ struct Thing *get_thing_on_map_block_with_filter(long thing_idx, Thing_Maximizer
     return retng;
 }
 
+/**
+ * Returns thing of given class on given map block which maximizes the filter function.
+ * Works like get_thing_on_map_block_with_filter(), but the filter is only called for things
+ * of given class; others are skipped using hot fields copy, without accessing the things.
+ * @return Gives the thing, or invalid thing pointer if not found.
+ */
+struct Thing *get_thing_of_class_on_map_block_with_filter(long thing_idx, ThingClass class_id, Thing_Maximizer_Filter filter, MaxTngFilterParam param, long *maximizer)
+{
+    SYNCDBG(19,"Starting");
+    struct Thing* retng = INVALID_THING;
+    unsigned long k = 0;
+    long i = thing_idx;
+    while (i != 0)
+    {
+        if ((i < 0) || (i >= THINGS_COUNT))
+        {
+            ERRORLOG("Jump to invalid thing detected");
+            break;
+        }
+        long n = i;
+        i = things_hot.next_on_mapblk[n];
+        // Begin per-loop code
+        if (things_hot.class_id[n] == class_id)
+        {
+            struct Thing* thing = thing_get(n);
+            long val = filter(thing, param, *maximizer);
+            if (val > *maximizer)
+            {
+                retng = thing;
+                *maximizer = val;
+                if (*maximizer == LONG_MAX)
+                {
+                    break;
+                }
+            }
+        }
+        // End of per-loop code
+        k++;
+        if (k > THINGS_COUNT)
+        {
+          ERRORLOG("Infinite loop detected when sweeping things list");
+          break;
+        }
+    }
+    return retng;
+}
+
 struct Thing* get_other_thing_on_map_block_with_filter(long thing_idx, Thing_Maximizer_Filter filter, MaxTngFilterParam param, long* maximizer)
 {
     SYNCDBG(19, "Starting");
@@ -3568,16 +3665,17 @@ TbBool imp_already_digging_at_excluding(struct Thing *excltng, MapSubtlCoord stl
     long i = get_mapwho_thing_index(mapblk);
     while (i != 0)
     {
-        struct Thing* thing = thing_get(i);
-        if (thing_is_invalid(thing))
+        if ((i < 0) || (i >= THINGS_COUNT))
         {
             WARNLOG("Jump out of things array");
             break;
         }
-        i = thing->next_on_mapblk;
+        long n = i;
+        i = things_hot.next_on_mapblk[n];
         // Per thing processing block
-        if ((thing->class_id == TCls_Creature) && (thing->index != excltng->index))
+        if ((things_hot.class_id[n] == TCls_Creature) && (n != excltng->index))
         {
+            struct Thing* thing = thing_get(n);
             if (!thing_is_picked_up(thing))
             {
                 if ((thing->active_state == CrSt_ImpDigsDirt) || (thing->active_state == CrSt_ImpMinesGold))
@@ -3609,17 +3707,18 @@ struct Thing *smallest_gold_pile_at_xy(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
     long i = get_mapwho_thing_index(mapblk);
     while (i != 0)
     {
-        struct Thing* thing = thing_get(i);
-        if (thing_is_invalid(thing))
+        if ((i < 0) || (i >= THINGS_COUNT))
         {
             WARNLOG("Jump out of things array");
             break;
         }
-        i = thing->next_on_mapblk;
+        long n = i;
+        i = things_hot.next_on_mapblk[n];
         // Per thing processing block
-        if ((thing->class_id == TCls_Object) && (object_is_gold_laying_on_ground(thing)))
+        if (things_hot.class_id[n] == TCls_Object)
         {
-            if (thing->creature.gold_carried < chosen_gold)
+            struct Thing* thing = thing_get(n);
+            if (object_is_gold_laying_on_ground(thing) && (thing->creature.gold_carried < chosen_gold))
             {
                 chosen_thing = thing;
                 chosen_gold = thing->creature.gold_carried;
@@ -3699,17 +3798,18 @@ TbBool gold_pile_with_maximum_at_xy(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
     long i = get_mapwho_thing_index(mapblk);
     while (i != 0)
     {
-        struct Thing* thing = thing_get(i);
-        if (thing_is_invalid(thing))
+        if ((i < 0) || (i >= THINGS_COUNT))
         {
             WARNLOG("Jump out of things array");
             break;
         }
-        i = thing->next_on_mapblk;
+        long n = i;
+        i = things_hot.next_on_mapblk[n];
         // Per thing processing block
-        if ((thing->class_id == TCls_Object) && (object_is_gold_laying_on_ground(thing)))
+        if (things_hot.class_id[n] == TCls_Object)
         {
-            if (thing->valuable.gold_stored >= game.conf.rules.game.gold_pile_maximum)
+            struct Thing* thing = thing_get(n);
+            if (object_is_gold_laying_on_ground(thing) && (thing->valuable.gold_stored >= game.conf.rules.game.gold_pile_maximum))
             {
                 return true;
             }
@@ -3994,7 +4094,7 @@ struct Thing *get_object_at_subtile_of_model_and_owned_by(MapSubtlCoord stl_x, M
     }
     long i = get_mapwho_thing_index(mapblk);
     long n = 0;
-    return get_thing_on_map_block_with_filter(i, filter, &param, &n);
+    return get_thing_of_class_on_map_block_with_filter(i, param.class_id, filter, &param, &n);
 }
 
 struct Thing *get_cavein_at_subtile_owned_by(MapSubtlCoord stl_x, MapSubtlCoord stl_y, PlayerNumber plyr_idx)
@@ -4012,7 +4112,7 @@ struct Thing *get_cavein_at_subtile_owned_by(MapSubtlCoord stl_x, MapSubtlCoord
     }
     long i = get_mapwho_thing_index(mapblk);
     long n = 0;
-    return get_thing_on_map_block_with_filter(i, filter, &param, &n);
+    return get_thing_of_class_on_map_block_with_filter(i, param.class_id, filter, &param, &n);
 }
 
 struct Thing *get_food_at_subtile_available_to_eat_and_owned_by(MapSubtlCoord stl_x, MapSubtlCoord stl_y, long plyr_idx)
@@ -4048,7 +4148,7 @@ struct Thing *get_trap_at_subtile_of_model_and_owned_by(MapSubtlCoord stl_x, Map
     }
     long i = get_mapwho_thing_index(mapblk);
     long n = 0;
-    return get_thing_on_map_block_with_filter(i, filter, &param, &n);
+    return get_thing_of_class_on_map_block_with_filter(i, param.class_id, filter, &param, &n);
 }
 
 /** Finds trap on all subtiles around given one, which belongs to given player and is of given model.
@@ -4089,7 +4189,7 @@ struct Thing *get_door_for_position(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
     }
     long i = get_mapwho_thing_index(mapblk);
     long n = 0;
-    return get_thing_on_map_block_with_filter(i, filter, &param, &n);
+    return get_thing_of_class_on_map_block_with_filter(i, param.class_id, filter, &param, &n);
 }
 
 struct Thing *get_door_for_position_for_trap_placement(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
@@ -4107,7 +4207,7 @@ struct Thing *get_door_for_position_for_trap_placement(MapSubtlCoord stl_x, MapS
     }
     long i = get_mapwho_thing_index(mapblk);
     long n = 0;
-    return get_thing_on_map_block_with_filter(i, filter, &param, &n);
+    return get_thing_of_class_on_map_block_with_filter(i, param.class_id, filter, &param, &n);
 }
 
 TbBool slab_has_door_thing_on(MapSlabCoord slb_x, MapSlabCoord slb_y)
@@ -4132,7 +4232,7 @@ struct Thing *get_creature_of_model_training_at_subtile_and_owned_by(MapSubtlCoo
     }
     long i = get_mapwho_thing_index(mapblk);
     long n = 0;
-    return get_thing_on_map_block_with_filter(i, filter, &param, &n);
+    return get_thing_of_class_on_map_block_with_filter(i, param.class_id, filter, &param, &n);
 }
 
 struct Thing *get_nearest_object_at_position(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
@@ -4333,6 +4433,7 @@ long count_creatures_in_dungeon_of_model_flags(const struct Dungeon *dungeon, un
 
 long count_creatures_in_dungeon_controlled_and_of_model_flags(const struct Dungeon *dungeon, unsigned long need_mdflags, unsigned long excl_mdflags)
 {
+    const struct DungeonCreatureStats* stats = get_dungeon_creature_stats(dungeon->owner);
     long count = 0;
     for (ThingModel crmodel = 1; crmodel < game.conf.crtr_conf.model_count; crmodel++)
     {
@@ -4341,7 +4442,7 @@ long count_creatures_in_dungeon_controlled_and_of_model_flags(const struct Dunge
            ((crconf->model_flags & excl_mdflags) == 0))
         {
             count += dungeon->owned_creatures_of_model[crmodel]
-              - count_player_list_creatures_of_model_matching_bool_filter(dungeon->owner, crmodel, creature_is_kept_in_custody_by_enemy_or_dying);
+              - count_stats_lost_creatures_of_model(stats, crmodel);
         }
     }
     return count;
@@ -4374,6 +4475,7 @@ void break_mapwho_infinite_chain(const struct Map *mapblk)
             // Per thing code start
             if (i == i_first) {
                 thing->next_on_mapblk = 0;
+                things_hot_update_next_on_mapblk(thing);
                 thing->prev_on_mapblk = i_prev[1];
                 WARNLOG("The things chain has been cut");
                 return;
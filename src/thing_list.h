@@ -184,14 +184,27 @@ struct Things {
 
 #pragma pack()
 /******************************************************************************/
+/**
+ * Copy of thing fields read when sweeping mapwho and class lists, indexed by thing index.
+ * Lets the sweeps skip things of other classes without loading whole Thing structures.
+ * Updated by the list and mapwho functions, rebuilt from things by things_hot_rebuild().
+ */
+struct ThingsHotData {
+    ThingIndex next_on_mapblk[THINGS_COUNT];
+    ThingIndex next_of_class[THINGS_COUNT];
+    ThingClass class_id[THINGS_COUNT];
+};
+/******************************************************************************/
 extern Thing_Class_Func class_functions[];
 extern unsigned long thing_create_errors;
+extern struct ThingsHotData things_hot;
 /******************************************************************************/
 void add_thing_to_list(struct Thing *thing, struct StructureList *list);
 void remove_thing_from_list(struct Thing *thing, struct StructureList *slist);
 void remove_thing_from_its_class_list(struct Thing *thing);
 void add_thing_to_its_class_list(struct Thing *thing);
 ThingIndex get_thing_class_list_head(ThingClass class_id);
+void things_hot_rebuild(void);
 struct StructureList *get_list_for_thing_class(ThingClass class_id);
 
 long creature_near_filter_is_enemy_of_and_not_specdigger(const struct Thing *thing, FilterParam val);
@@ -219,6 +232,7 @@ long count_player_diggers_not_counting_to_total(PlayerNumber plyr_idx);
 
 // Filters to select thing on/near given map position
 struct Thing *get_thing_on_map_block_with_filter(long thing_idx, Thing_Maximizer_Filter filter, MaxTngFilterParam param, long *maximizer);
+struct Thing *get_thing_of_class_on_map_block_with_filter(long thing_idx, ThingClass class_id, Thing_Maximizer_Filter filter, MaxTngFilterParam param, long *maximizer);
 struct Thing *get_thing_near_revealed_map_block_with_filter(MapCoord x, MapCoord y, Thing_Maximizer_Filter filter, MaxTngFilterParam param);
 struct Thing *get_thing_spiral_near_map_block_with_filter(MapCoord x, MapCoord y, long spiral_len, Thing_Maximizer_Filter filter, MaxTngFilterParam param);
 struct Thing* get_player_creature_in_range_around_any_enemy_heart(PlayerNumber plyr_idx, ThingModel crmodel, MapSubtlDelta range);
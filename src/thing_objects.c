@@ -259,6 +259,7 @@ void destroy_food(struct Thing *foodtng)
             if (room->used_capacity >= required_cap)
             {
                 room->used_capacity -= required_cap;
+                room_capacity_changed(room);
             }
             foodtng->food.life_remaining = game.conf.rules.game.food_life_out_of_hatchery;
         }
@@ -667,6 +668,7 @@ TbBool creature_remove_lair_totem_from_room(struct Thing *creatng, struct Room *
     } else
     {
         room->used_capacity -= required_cap;
+        room_capacity_changed(room);
         room->content_per_model[creatng->model]--;
     }
     cctrl->lair_room_id = 0;
@@ -726,6 +728,7 @@ static long food_moves(struct Thing *objtng)
             if (room_role_matches(room->kind, RoRoF_FoodSpawn) && (room->owner == objtng->owner) && (room->total_capacity > room->used_capacity))
             {
                 room->used_capacity++;
+                room_capacity_changed(room);
                 objtng->food.life_remaining = -1;
                 objtng->parent_idx = room->index;
             }
@@ -1661,7 +1664,11 @@ static TngUpdateRet object_update_power_sight(struct Thing *objtng)
             if ( pos_x >= 0 && pos_x < gameadd.map_subtiles_x * COORD_PER_STL && pos_y >= 0 && pos_y < gameadd.map_subtiles_y * COORD_PER_STL ) {
                 const int shift_x = pos.x.stl.num - objtng->mappos.x.stl.num + MAX_SOE_RADIUS;
                 const int shift_y = pos.y.stl.num - objtng->mappos.y.stl.num + MAX_SOE_RADIUS;
-                dungeon->soe_explored_flags[shift_y][shift_x] = pos.x.val < gameadd.map_subtiles_x * COORD_PER_STL && pos.y.val < gameadd.map_subtiles_y * COORD_PER_STL;
+                unsigned char explored = pos.x.val < gameadd.map_subtiles_x * COORD_PER_STL && pos.y.val < gameadd.map_subtiles_y * COORD_PER_STL;
+                if (dungeon->soe_explored_flags[shift_y][shift_x] != explored) {
+                    dungeon->soe_explored_flags[shift_y][shift_x] = explored;
+                    power_sight_explored_changed(objtng->owner);
+                }
             }
         }
         return 1;
@@ -1979,6 +1986,7 @@ struct Thing *create_gold_hoarde(struct Room *room, const struct Coord3d *pos, G
         }
         int wealth_size = get_wealth_size_of_gold_amount(thing->valuable.gold_stored);
         room->used_capacity += wealth_size;
+        room_capacity_changed(room);
     }
     return thing;
 }
@@ -2009,6 +2017,7 @@ long add_gold_to_hoarde(struct Thing *gldtng, struct Room *room, GoldAmount amou
         wealth_size = room->used_capacity;
     }
     room->used_capacity -= wealth_size;
+    room_capacity_changed(room);
     // Add amount of gold
     gldtng->valuable.gold_stored += amount;
     room->capacity_used_for_storage += amount;
@@ -2022,6 +2031,7 @@ long add_gold_to_hoarde(struct Thing *gldtng, struct Room *room, GoldAmount amou
     // Add new wealth size
     wealth_size = get_wealth_size_of_gold_amount(gldtng->valuable.gold_stored);
     room->used_capacity += wealth_size;
+    room_capacity_changed(room);
     // switch hoard object model
     gldtng->model = gold_hoard_objects[wealth_size-1];
     // Set visual appearance
@@ -2058,6 +2068,7 @@ long remove_gold_from_hoarde(struct Thing *gldtng, struct Room *room, GoldAmount
         wealth_size = room->used_capacity;
     }
     room->used_capacity -= wealth_size;
+    room_capacity_changed(room);
     // Add amount of gold
     gldtng->valuable.gold_stored -= amount;
     room->capacity_used_for_storage -= amount;
@@ -2074,6 +2085,7 @@ long remove_gold_from_hoarde(struct Thing *gldtng, struct Room *room, GoldAmount
     // Add new wealth size
     wealth_size = get_wealth_size_of_gold_amount(gldtng->valuable.gold_stored);
     room->used_capacity += wealth_size;
+    room_capacity_changed(room);
     // switch hoard object model
     gldtng->model = gold_hoard_objects[wealth_size-1];
     // Set visual appearance
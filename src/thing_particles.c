@@ -0,0 +1,505 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file thing_particles.c
+ *     Pool of cosmetic effect elements, kept outside of the things list.
+ * @par Purpose:
+ *     Effect elements which have no light, create no other effects and
+ *     play no sounds don't need to be things. They are stored here instead,
+ *     so that they don't use thing slots and are updated in one pass.
+ * @par Comment:
+ *     Particles are not part of the synchronized game state; they use their
+ *     own random seed and are not included in any checksum. Movement is
+ *     simplified - particles stop at walls instead of sliding along them.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#include "pre_inc.h"
+#include "thing_particles.h"
+
+#include "globals.h"
+#include "bflib_basics.h"
+#include "bflib_math.h"
+
+#include "config_effects.h"
+#include "creature_graphics.h"
+#include "engine_arrays.h"
+#include "engine_render.h"
+#include "game_legacy.h"
+#include "map_columns.h"
+#include "map_data.h"
+#include "net_rollback.h"
+#include "thing_data.h"
+#include "thing_effects.h"
+#include "thing_list.h"
+#include "thing_objects.h"
+#include "keeperfx.hpp"
+#include "post_inc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************/
+/** Limits chains of element transformations when checking if a model is cosmetic. */
+#define PARTICLE_TRANSFORM_DEPTH 4
+/******************************************************************************/
+extern long const bounce_table[];
+/******************************************************************************/
+struct EffectParticles effect_particles;
+/** Things used to draw the particles; filled only for the particles being drawn. */
+static struct Thing particle_render_things[EFFECT_PARTICLES_COUNT];
+/******************************************************************************/
+static TbBool effect_element_is_cosmetic_depth(ThingModel eelmodel, int depth)
+{
+    if ((eelmodel <= 0) || (eelmodel >= EFFECTSELLEMENTS_TYPES_MAX) || (depth <= 0))
+        return false;
+    const struct EffectElementConfigStats* eestat = get_effect_element_model_stats(eelmodel);
+    if (eestat->sprite_idx == -1)
+        return false;
+    // Anything which may create things, lights or sounds has to stay a thing
+    if ((eestat->light_radius != 0) || (eestat->subeffect_delay > 0) || eestat->affected_by_wind)
+        return false;
+    if (eestat->movable && eestat->impacts)
+        return false;
+    // Direction of movement is not tracked for particles
+    if (eestat->unanimated == 1)
+        return false;
+    if (eestat->transform_model != 0)
+        return effect_element_is_cosmetic_depth(eestat->transform_model, depth - 1);
+    return true;
+}
+
+/**
+ * Returns whether effect elements of given model may be particles.
+ * Such elements only display sprites, and never affect the game.
+ */
+TbBool effect_element_is_cosmetic(ThingModel eelmodel)
+{
+    return effect_element_is_cosmetic_depth(eelmodel, PARTICLE_TRANSFORM_DEPTH);
+}
+
+/**
+ * Random number for particles; doesn't affect the synchronized seeds.
+ */
+long effect_particle_random(long range)
+{
+    if (range <= 0)
+        return 0;
+    return LbRandomSeries(range, &effect_particles.rand_seed, __func__, __LINE__);
+}
+
+static void effect_particle_set_model(long pidx, ThingModel eelmodel)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    const struct EffectElementConfigStats* eestat = get_effect_element_model_stats(eelmodel);
+    eprt->model[pidx] = eelmodel;
+    eprt->anim_sprite[pidx] = convert_td_iso(eestat->sprite_idx);
+    eprt->max_frames[pidx] = keepersprite_frames(eprt->anim_sprite[pidx]);
+    eprt->anim_speed[pidx] = eestat->sprite_speed_min + effect_particle_random(eestat->sprite_speed_max - eestat->sprite_speed_min + 1);
+    eprt->sprite_size[pidx] = eestat->sprite_size_min + effect_particle_random(eestat->sprite_size_max - eestat->sprite_size_min + 1);
+    eprt->current_frame[pidx] = 0;
+    eprt->anim_time[pidx] = 0;
+    unsigned char flags = eprt->rendering_flags[pidx] & ~(TRF_Unshaded|TRF_Transpar_Flags|TRF_AnimateOnce);
+    set_flag_value(flags, TRF_Unshaded, eestat->unshaded);
+    flags |= (TRF_Transpar_8 * eestat->transparent) & TRF_Transpar_Flags;
+    set_flag_value(flags, TRF_AnimateOnce, eestat->rendering_flag);
+    eprt->rendering_flags[pidx] = flags;
+    if (eestat->lifespan > 0)
+    {
+        eprt->health[pidx] = eestat->lifespan + effect_particle_random(eestat->lifespan_random - eestat->lifespan + 1);
+    } else
+    if (eprt->anim_speed[pidx] > 0)
+    {
+        eprt->health[pidx] = get_lifespan_of_animation(eprt->anim_sprite[pidx], eprt->anim_speed[pidx]);
+    } else
+    {
+        eprt->health[pidx] = eprt->max_frames[pidx];
+    }
+}
+
+/**
+ * Creates a particle for cosmetic effect element.
+ * @return Index of the new particle, or -1 if it wasn't created.
+ */
+long create_effect_particle(const struct Coord3d *pos, ThingModel eelmodel)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    // When simulating turns again, the particles were already created
+    if (network_rollback_resimulating())
+        return -1;
+    if (eprt->count >= EFFECT_PARTICLES_COUNT)
+        return -1;
+    if (!any_player_close_enough_to_see(pos))
+        return -1;
+    long pidx = eprt->count;
+    const struct EffectElementConfigStats* eestat = get_effect_element_model_stats(eelmodel);
+    eprt->pos_x[pidx] = pos->x.val;
+    eprt->pos_y[pidx] = pos->y.val;
+    eprt->pos_z[pidx] = pos->z.val;
+    eprt->prev_x[pidx] = pos->x.val;
+    eprt->prev_y[pidx] = pos->y.val;
+    eprt->prev_z[pidx] = pos->z.val;
+    eprt->floor_z[pidx] = get_floor_height_at(pos);
+    eprt->veloc_x[pidx] = 0;
+    eprt->veloc_y[pidx] = 0;
+    eprt->veloc_z[pidx] = 0;
+    eprt->rendering_flags[pidx] = 0;
+    eprt->tint_colour[pidx] = 0;
+    eprt->move_angle_xy[pidx] = 0;
+    eprt->creation_turn[pidx] = game.play_gameturn;
+    eprt->last_turn_drawn[pidx] = 0;
+    effect_particle_set_model(pidx, eelmodel);
+    eprt->transformation_speed[pidx] = 0;
+    eprt->size_change[pidx] = 0;
+    eprt->sprite_size_min[pidx] = eestat->sprite_size_min;
+    eprt->sprite_size_max[pidx] = eestat->sprite_size_max;
+    if ((eestat->size_change != TSC_DontChangeSize) && (eprt->health[pidx] > 0))
+    {
+        long dsize = eestat->sprite_size_max - (long)eestat->sprite_size_min;
+        if (eestat->size_change == TSC_ChangeSizeContinuously)
+        {
+            eprt->transformation_speed[pidx] = 2 * dsize / eprt->health[pidx];
+            eprt->size_change[pidx] = TSC_ChangeSizeContinuously;
+        } else
+        {
+            eprt->transformation_speed[pidx] = dsize / eprt->health[pidx];
+        }
+        eprt->sprite_size[pidx] = eestat->sprite_size_min;
+    }
+    eprt->count++;
+    return pidx;
+}
+
+void effect_particle_push(long pidx, MapCoordDelta veloc_x, MapCoordDelta veloc_y, MapCoordDelta veloc_z)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    if ((pidx < 0) || (pidx >= eprt->count))
+        return;
+    eprt->veloc_x[pidx] += veloc_x;
+    eprt->veloc_y[pidx] += veloc_y;
+    eprt->veloc_z[pidx] += veloc_z;
+}
+
+void effect_particle_set_frame(long pidx, unsigned char start_frame, short anim_speed)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    if ((pidx < 0) || (pidx >= eprt->count))
+        return;
+    eprt->current_frame[pidx] = start_frame;
+    eprt->anim_time[pidx] = start_frame << 8;
+    eprt->anim_speed[pidx] = anim_speed;
+}
+
+/**
+ * Makes the particle look like given thing; used for afterimages.
+ */
+void effect_particle_copy_sprite(long pidx, const struct Thing *thing)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    if ((pidx < 0) || (pidx >= eprt->count))
+        return;
+    eprt->anim_speed[pidx] = 0;
+    eprt->anim_time[pidx] = thing->anim_time;
+    eprt->anim_sprite[pidx] = thing->anim_sprite;
+    eprt->sprite_size[pidx] = thing->sprite_size;
+    eprt->current_frame[pidx] = thing->current_frame;
+    eprt->max_frames[pidx] = thing->max_frames;
+    eprt->transformation_speed[pidx] = thing->transformation_speed;
+    eprt->sprite_size_min[pidx] = thing->sprite_size_min;
+    eprt->sprite_size_max[pidx] = thing->sprite_size_max;
+    eprt->rendering_flags[pidx] = (thing->rendering_flags & ~TRF_Transpar_8) | TRF_Transpar_4;
+    eprt->size_change[pidx] = thing->size_change;
+    eprt->tint_colour[pidx] = thing->tint_colour;
+    eprt->move_angle_xy[pidx] = thing->move_angle_xy;
+}
+
+/**
+ * Removes a particle by moving the last one into its place.
+ */
+static void effect_particle_remove(long pidx)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    long last = eprt->count - 1;
+    if (pidx != last)
+    {
+        eprt->pos_x[pidx] = eprt->pos_x[last];
+        eprt->pos_y[pidx] = eprt->pos_y[last];
+        eprt->pos_z[pidx] = eprt->pos_z[last];
+        eprt->floor_z[pidx] = eprt->floor_z[last];
+        eprt->veloc_x[pidx] = eprt->veloc_x[last];
+        eprt->veloc_y[pidx] = eprt->veloc_y[last];
+        eprt->veloc_z[pidx] = eprt->veloc_z[last];
+        eprt->health[pidx] = eprt->health[last];
+        eprt->model[pidx] = eprt->model[last];
+        eprt->anim_speed[pidx] = eprt->anim_speed[last];
+        eprt->anim_time[pidx] = eprt->anim_time[last];
+        eprt->anim_sprite[pidx] = eprt->anim_sprite[last];
+        eprt->current_frame[pidx] = eprt->current_frame[last];
+        eprt->max_frames[pidx] = eprt->max_frames[last];
+        eprt->sprite_size[pidx] = eprt->sprite_size[last];
+        eprt->sprite_size_min[pidx] = eprt->sprite_size_min[last];
+        eprt->sprite_size_max[pidx] = eprt->sprite_size_max[last];
+        eprt->transformation_speed[pidx] = eprt->transformation_speed[last];
+        eprt->size_change[pidx] = eprt->size_change[last];
+        eprt->rendering_flags[pidx] = eprt->rendering_flags[last];
+        eprt->tint_colour[pidx] = eprt->tint_colour[last];
+        eprt->move_angle_xy[pidx] = eprt->move_angle_xy[last];
+        eprt->creation_turn[pidx] = eprt->creation_turn[last];
+        eprt->prev_x[pidx] = eprt->prev_x[last];
+        eprt->prev_y[pidx] = eprt->prev_y[last];
+        eprt->prev_z[pidx] = eprt->prev_z[last];
+        eprt->interp_x[pidx] = eprt->interp_x[last];
+        eprt->interp_y[pidx] = eprt->interp_y[last];
+        eprt->interp_z[pidx] = eprt->interp_z[last];
+        eprt->last_turn_drawn[pidx] = eprt->last_turn_drawn[last];
+    }
+    eprt->count--;
+}
+
+/**
+ * Updates lifespan of all particles. Expired particles are either removed,
+ * or transformed into another element, like effect element things are.
+ */
+static void update_effect_particles_health(void)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    long pidx = 0;
+    while (pidx < eprt->count)
+    {
+        if (eprt->health[pidx] > 0)
+        {
+            eprt->health[pidx]--;
+            pidx++;
+            continue;
+        }
+        const struct EffectElementConfigStats* eestat = get_effect_element_model_stats(eprt->model[pidx]);
+        if (eestat->transform_model != 0)
+        {
+            effect_particle_set_model(pidx, eestat->transform_model);
+            pidx++;
+        } else
+        {
+            // The last particle is moved here, and needs checking too
+            effect_particle_remove(pidx);
+        }
+    }
+}
+
+/**
+ * Moves all particles, applying velocity changes of their move type.
+ */
+static void update_effect_particles_movement(void)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    MapCoord map_max_x = subtile_coord(gameadd.map_subtiles_x, 0) - 1;
+    MapCoord map_max_y = subtile_coord(gameadd.map_subtiles_y, 0) - 1;
+    long pidx = 0;
+    while (pidx < eprt->count)
+    {
+        const struct EffectElementConfigStats* eestat = get_effect_element_model_stats(eprt->model[pidx]);
+        eprt->prev_x[pidx] = eprt->pos_x[pidx];
+        eprt->prev_y[pidx] = eprt->pos_y[pidx];
+        eprt->prev_z[pidx] = eprt->pos_z[pidx];
+        if (!eestat->animate_on_floor && (eprt->floor_z[pidx] >= eprt->pos_z[pidx]))
+            eprt->anim_speed[pidx] = 0;
+        MapCoordDelta vz = eprt->veloc_z[pidx];
+        switch (eestat->move_type)
+        {
+        case 2:
+            eprt->veloc_x[pidx] = 2 * eprt->veloc_x[pidx] / 3;
+            eprt->veloc_y[pidx] = 2 * eprt->veloc_y[pidx] / 3;
+            if ((vz > 32) || (vz < -16))
+                vz = 2 * vz / 3;
+            else if (vz > 16)
+                vz = max(vz - 16, 16);
+            else
+                vz = min(vz + 16, 16);
+            break;
+        case 3:
+            vz = 32;
+            break;
+        case 4:
+            if ((eprt->health[pidx] >= 0) && (eprt->health[pidx] < 16))
+                vz = bounce_table[eprt->health[pidx]];
+            break;
+        case 5:
+            pidx++;
+            continue;
+        default:
+            break;
+        }
+        eprt->veloc_z[pidx] = vz;
+        MapCoord pos_x = eprt->pos_x[pidx] + eprt->veloc_x[pidx];
+        MapCoord pos_y = eprt->pos_y[pidx] + eprt->veloc_y[pidx];
+        MapCoord pos_z = eprt->pos_z[pidx] + vz;
+        if ((pos_x < 0) || (pos_x > map_max_x) || (pos_y < 0) || (pos_y > map_max_y))
+        {
+            effect_particle_remove(pidx);
+            continue;
+        }
+        MapCoord floor_z = get_floor_height(coord_subtile(pos_x), coord_subtile(pos_y));
+        if ((floor_z > eprt->pos_z[pidx]) && (eestat->movement_flags == 0))
+        {
+            // Hit a wall; stay in place instead of sliding along it
+            pos_x = eprt->pos_x[pidx];
+            pos_y = eprt->pos_y[pidx];
+            eprt->veloc_x[pidx] = 0;
+            eprt->veloc_y[pidx] = 0;
+            floor_z = eprt->floor_z[pidx];
+        }
+        if (pos_z > floor_z)
+        {
+            eprt->veloc_x[pidx] = eprt->veloc_x[pidx] * (256 - eestat->inertia_air) / 256;
+            eprt->veloc_y[pidx] = eprt->veloc_y[pidx] * (256 - eestat->inertia_air) / 256;
+            eprt->veloc_z[pidx] -= eestat->fall_acceleration;
+        } else
+        {
+            eprt->veloc_x[pidx] = eprt->veloc_x[pidx] * (256 - eestat->inertia_floor) / 256;
+            eprt->veloc_y[pidx] = eprt->veloc_y[pidx] * (256 - eestat->inertia_floor) / 256;
+            eprt->veloc_z[pidx] = 0;
+            pos_z = floor_z;
+        }
+        eprt->pos_x[pidx] = pos_x;
+        eprt->pos_y[pidx] = pos_y;
+        eprt->pos_z[pidx] = pos_z;
+        eprt->floor_z[pidx] = floor_z;
+        pidx++;
+    }
+}
+
+/**
+ * Advances animation and size of all particles; same as update_thing_animation().
+ */
+static void update_effect_particles_animation(void)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    for (long pidx = 0; pidx < eprt->count; pidx++)
+    {
+        if ((eprt->anim_speed[pidx] != 0) && (eprt->max_frames[pidx] != 0))
+        {
+            long anim_time = eprt->anim_time[pidx] + eprt->anim_speed[pidx];
+            long i = (eprt->max_frames[pidx] << 8);
+            while (anim_time < 0)
+                anim_time += i;
+            if (anim_time > i-1)
+            {
+                if (flag_is_set(eprt->rendering_flags[pidx], TRF_AnimateOnce))
+                {
+                    eprt->anim_speed[pidx] = 0;
+                    anim_time = i-1;
+                } else
+                {
+                    anim_time %= i;
+                }
+            }
+            eprt->anim_time[pidx] = anim_time;
+            eprt->current_frame[pidx] = (anim_time >> 8) & 0xFF;
+        }
+        if (eprt->transformation_speed[pidx] != 0)
+        {
+            long size = eprt->sprite_size[pidx] + eprt->transformation_speed[pidx];
+            TbBool at_limit = false;
+            if (size >= eprt->sprite_size_max[pidx]) {
+                size = eprt->sprite_size_max[pidx];
+                at_limit = true;
+            } else
+            if (size <= eprt->sprite_size_min[pidx]) {
+                size = eprt->sprite_size_min[pidx];
+                at_limit = true;
+            }
+            eprt->sprite_size[pidx] = size;
+            if (at_limit)
+            {
+                if (flag_is_set(eprt->size_change[pidx], TSC_ChangeSizeContinuously))
+                    eprt->transformation_speed[pidx] = -eprt->transformation_speed[pidx];
+                else
+                    eprt->transformation_speed[pidx] = 0;
+            }
+        }
+    }
+}
+
+/**
+ * Updates all particles for one game turn.
+ */
+void update_effect_particles(void)
+{
+    SYNCDBG(18,"Starting for %ld particles",effect_particles.count);
+    if (network_rollback_resimulating())
+        return;
+    update_effect_particles_health();
+    update_effect_particles_movement();
+    update_effect_particles_animation();
+}
+
+void clear_effect_particles(void)
+{
+    effect_particles.count = 0;
+}
+
+/**
+ * Prepares particles within given subtiles range to be drawn.
+ * Particles are given as things, so that they can be drawn like effect element things.
+ * @return Amount of things filled.
+ */
+long effect_particles_gather_visible(struct Thing **things, long max_things, PlayerNumber plyr_idx,
+    MapSubtlCoord stl_x_min, MapSubtlCoord stl_y_min, MapSubtlCoord stl_x_max, MapSubtlCoord stl_y_max)
+{
+    struct EffectParticles* eprt = &effect_particles;
+    long n = 0;
+    for (long pidx = 0; (pidx < eprt->count) && (n < max_things); pidx++)
+    {
+        MapSubtlCoord stl_x = coord_subtile(eprt->pos_x[pidx]);
+        MapSubtlCoord stl_y = coord_subtile(eprt->pos_y[pidx]);
+        if ((stl_x < stl_x_min) || (stl_x > stl_x_max) || (stl_y < stl_y_min) || (stl_y > stl_y_max))
+            continue;
+        if (!subtile_revealed(stl_x, stl_y, plyr_idx))
+            continue;
+        // Same as interpolate_thing()
+        if ((eprt->creation_turn[pidx] == game.play_gameturn-1) || (game.play_gameturn - eprt->last_turn_drawn[pidx] > 1))
+        {
+            eprt->interp_x[pidx] = eprt->pos_x[pidx];
+            eprt->interp_y[pidx] = eprt->pos_y[pidx];
+            eprt->interp_z[pidx] = eprt->pos_z[pidx];
+        } else
+        {
+            eprt->interp_x[pidx] = interpolate(eprt->interp_x[pidx], eprt->prev_x[pidx], eprt->pos_x[pidx]);
+            eprt->interp_y[pidx] = interpolate(eprt->interp_y[pidx], eprt->prev_y[pidx], eprt->pos_y[pidx]);
+            eprt->interp_z[pidx] = interpolate(eprt->interp_z[pidx], eprt->prev_z[pidx], eprt->pos_z[pidx]);
+        }
+        eprt->last_turn_drawn[pidx] = game.play_gameturn;
+        struct Thing* thing = &particle_render_things[n];
+        thing->class_id = TCls_EffectElem;
+        // Not an index of any thing, so it is never highlighted as under hand
+        thing->index = THINGS_COUNT;
+        thing->model = eprt->model[pidx];
+        thing->draw_class = ODC_Default;
+        thing->mappos.x.val = eprt->pos_x[pidx];
+        thing->mappos.y.val = eprt->pos_y[pidx];
+        thing->mappos.z.val = eprt->pos_z[pidx];
+        thing->interp_mappos.x.val = eprt->interp_x[pidx];
+        thing->interp_mappos.y.val = eprt->interp_y[pidx];
+        thing->interp_mappos.z.val = eprt->interp_z[pidx];
+        thing->floor_height = eprt->floor_z[pidx];
+        thing->interp_floor_height = eprt->floor_z[pidx];
+        thing->anim_sprite = eprt->anim_sprite[pidx];
+        thing->current_frame = eprt->current_frame[pidx];
+        thing->sprite_size = eprt->sprite_size[pidx];
+        thing->rendering_flags = eprt->rendering_flags[pidx];
+        thing->tint_colour = eprt->tint_colour[pidx];
+        thing->move_angle_xy = eprt->move_angle_xy[pidx];
+        things[n] = thing;
+        n++;
+    }
+    return n;
+}
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
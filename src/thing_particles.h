@@ -0,0 +1,90 @@
+/******************************************************************************/
+// Free implementation of Bullfrog's Dungeon Keeper strategy game.
+/******************************************************************************/
+/** @file thing_particles.h
+ *     Header file for thing_particles.c.
+ * @par Purpose:
+ *     Pool of cosmetic effect elements, kept outside of the things list.
+ * @par Comment:
+ *     Just a header file - #defines, typedefs, function prototypes etc.
+ * @author   KeeperFX Team
+ * @date     19 Oct 2026
+ * @par  Copying and copyrights:
+ *     This program is free software; you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation; either version 2 of the License, or
+ *     (at your option) any later version.
+ */
+/******************************************************************************/
+#ifndef DK_TNGPARTICLE_H
+#define DK_TNGPARTICLE_H
+
+#include "globals.h"
+#include "bflib_basics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EFFECT_PARTICLES_COUNT 2048
+/******************************************************************************/
+struct Thing;
+struct Coord3d;
+
+/**
+ * Effect elements which don't affect the game, stored as arrays of fields.
+ * Active particles are always packed at the start of the arrays.
+ */
+struct EffectParticles {
+    long count;
+    unsigned long rand_seed;
+    MapCoord pos_x[EFFECT_PARTICLES_COUNT];
+    MapCoord pos_y[EFFECT_PARTICLES_COUNT];
+    MapCoord pos_z[EFFECT_PARTICLES_COUNT];
+    MapCoord floor_z[EFFECT_PARTICLES_COUNT];
+    MapCoordDelta veloc_x[EFFECT_PARTICLES_COUNT];
+    MapCoordDelta veloc_y[EFFECT_PARTICLES_COUNT];
+    MapCoordDelta veloc_z[EFFECT_PARTICLES_COUNT];
+    HitPoints health[EFFECT_PARTICLES_COUNT];
+    ThingModel model[EFFECT_PARTICLES_COUNT];
+    short anim_speed[EFFECT_PARTICLES_COUNT];
+    long anim_time[EFFECT_PARTICLES_COUNT];
+    unsigned short anim_sprite[EFFECT_PARTICLES_COUNT];
+    unsigned char current_frame[EFFECT_PARTICLES_COUNT];
+    unsigned char max_frames[EFFECT_PARTICLES_COUNT];
+    unsigned short sprite_size[EFFECT_PARTICLES_COUNT];
+    unsigned short sprite_size_min[EFFECT_PARTICLES_COUNT];
+    unsigned short sprite_size_max[EFFECT_PARTICLES_COUNT];
+    char transformation_speed[EFFECT_PARTICLES_COUNT];
+    unsigned char size_change[EFFECT_PARTICLES_COUNT];
+    unsigned char rendering_flags[EFFECT_PARTICLES_COUNT];
+    unsigned char tint_colour[EFFECT_PARTICLES_COUNT];
+    short move_angle_xy[EFFECT_PARTICLES_COUNT];
+    GameTurn creation_turn[EFFECT_PARTICLES_COUNT];
+    // Rendering only; previous position is from start of the turn
+    MapCoord prev_x[EFFECT_PARTICLES_COUNT];
+    MapCoord prev_y[EFFECT_PARTICLES_COUNT];
+    MapCoord prev_z[EFFECT_PARTICLES_COUNT];
+    MapCoord interp_x[EFFECT_PARTICLES_COUNT];
+    MapCoord interp_y[EFFECT_PARTICLES_COUNT];
+    MapCoord interp_z[EFFECT_PARTICLES_COUNT];
+    GameTurn last_turn_drawn[EFFECT_PARTICLES_COUNT];
+};
+/******************************************************************************/
+extern struct EffectParticles effect_particles;
+/******************************************************************************/
+TbBool effect_element_is_cosmetic(ThingModel eelmodel);
+long create_effect_particle(const struct Coord3d *pos, ThingModel eelmodel);
+void effect_particle_push(long pidx, MapCoordDelta veloc_x, MapCoordDelta veloc_y, MapCoordDelta veloc_z);
+void effect_particle_set_frame(long pidx, unsigned char start_frame, short anim_speed);
+void effect_particle_copy_sprite(long pidx, const struct Thing *thing);
+long effect_particle_random(long range);
+void update_effect_particles(void);
+void clear_effect_particles(void);
+long effect_particles_gather_visible(struct Thing **things, long max_things, PlayerNumber plyr_idx,
+    MapSubtlCoord stl_x_min, MapSubtlCoord stl_y_min, MapSubtlCoord stl_x_max, MapSubtlCoord stl_y_max);
+/******************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -46,6 +46,7 @@
 #include "creature_groups.h"
 #include "game_legacy.h"
 #include "engine_lenses.h"
+#include "map_arena.h"
 
 #include "keeperfx.hpp"
 #include "post_inc.h"
@@ -1601,6 +1602,265 @@ struct Thing *get_thing_collided_with_at_satisfying_filter(struct Thing *shotng,
     return INVALID_THING;
 }
 
+/**
+ * Things which shots may hit, bucketed by map area. Built once per turn before
+ * shots are updated; things placed on map later in the turn are added to the
+ * late list, and entries of things moved since are invalidated by stamp.
+ */
+#define SHOT_COLLIDE_LATE_COUNT 256
+
+struct ShotCollideEntry {
+    ThingIndex index;
+    unsigned short stamp;
+    MapSubtlCoord stl_x;
+    MapSubtlCoord stl_y;
+};
+
+struct ShotBroadPhase {
+    TbBool active;
+    long count;
+    long late_count;
+    /** Index of the first entry of each cell; the cells are a part of map arrays, as their amount depends on map size. */
+    long *cell_start;
+    struct ShotCollideEntry entries[THINGS_COUNT];
+    struct ShotCollideEntry late[SHOT_COLLIDE_LATE_COUNT];
+    unsigned short stamp[THINGS_COUNT];
+    struct ShotCollideEntry candidates[THINGS_COUNT];
+};
+
+static struct ShotBroadPhase shot_broadphase;
+
+static TbBool shot_broadphase_tracks_thing(const struct Thing *thing)
+{
+    switch (thing->class_id)
+    {
+    case TCls_Creature:
+    case TCls_Object:
+    case TCls_Door:
+    case TCls_Trap:
+    case TCls_DeadCreature:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static long shot_broadphase_cell(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
+{
+    return (stl_y >> SHOT_COLLIDE_CELL_SHIFT) * map_arena.shot_cells_x + (stl_x >> SHOT_COLLIDE_CELL_SHIFT);
+}
+
+/**
+ * Buckets all things which may be hit by shots; to be called before shots are updated.
+ */
+void shot_broadphase_build(void)
+{
+    struct ShotBroadPhase* sbp = &shot_broadphase;
+    if (map_arena.data == NULL)
+    {
+        sbp->active = false;
+        return;
+    }
+    long cells_count = map_arena.shot_cells_count;
+    sbp->cell_start = map_arena.shot_cells;
+    memset(sbp->cell_start, 0, (cells_count + 1) * sizeof(long));
+    for (long i = 1; i < THINGS_COUNT; i++)
+    {
+        struct Thing* thing = thing_get(i);
+        if (((thing->alloc_flags & TAlF_IsInMapWho) == 0) || !shot_broadphase_tracks_thing(thing))
+            continue;
+        sbp->cell_start[shot_broadphase_cell(thing->mappos.x.stl.num, thing->mappos.y.stl.num) + 1]++;
+    }
+    for (long n = 0; n < cells_count; n++)
+    {
+        sbp->cell_start[n + 1] += sbp->cell_start[n];
+    }
+    sbp->count = 0;
+    for (long i = 1; i < THINGS_COUNT; i++)
+    {
+        struct Thing* thing = thing_get(i);
+        if (((thing->alloc_flags & TAlF_IsInMapWho) == 0) || !shot_broadphase_tracks_thing(thing))
+            continue;
+        // Prefix sums are moved back by one cell while filling, and end up as cell starts
+        long n = shot_broadphase_cell(thing->mappos.x.stl.num, thing->mappos.y.stl.num);
+        struct ShotCollideEntry* entry = &sbp->entries[sbp->cell_start[n]++];
+        entry->index = i;
+        entry->stamp = sbp->stamp[i];
+        entry->stl_x = thing->mappos.x.stl.num;
+        entry->stl_y = thing->mappos.y.stl.num;
+        sbp->count++;
+    }
+    for (long n = cells_count; n > 0; n--)
+    {
+        sbp->cell_start[n] = sbp->cell_start[n - 1];
+    }
+    sbp->cell_start[0] = 0;
+    sbp->late_count = 0;
+    sbp->active = true;
+}
+
+void shot_broadphase_clear(void)
+{
+    shot_broadphase.active = false;
+}
+
+/**
+ * Keeps the broad phase in sync with mapwho; called whenever a thing is placed on map.
+ */
+void shot_broadphase_thing_placed(const struct Thing *thing)
+{
+    struct ShotBroadPhase* sbp = &shot_broadphase;
+    if (!sbp->active || !shot_broadphase_tracks_thing(thing))
+        return;
+    sbp->stamp[thing->index]++;
+    if (sbp->late_count >= SHOT_COLLIDE_LATE_COUNT)
+    {
+        SYNCDBG(8,"Too many things placed during shots update; broad phase disabled for this turn");
+        sbp->active = false;
+        return;
+    }
+    struct ShotCollideEntry* entry = &sbp->late[sbp->late_count];
+    entry->index = thing->index;
+    entry->stamp = sbp->stamp[thing->index];
+    entry->stl_x = thing->mappos.x.stl.num;
+    entry->stl_y = thing->mappos.y.stl.num;
+    sbp->late_count++;
+}
+
+static TbBool shot_broadphase_entry_in_area(const struct ShotCollideEntry *entry, const struct Thing *shotng,
+    MapSubtlCoord stl_x_min, MapSubtlCoord stl_y_min, MapSubtlCoord stl_x_max, MapSubtlCoord stl_y_max)
+{
+    if ((entry->stl_x < stl_x_min) || (entry->stl_x > stl_x_max) || (entry->stl_y < stl_y_min) || (entry->stl_y > stl_y_max))
+        return false;
+    if ((entry->index == shotng->index) || (entry->stamp != shot_broadphase.stamp[entry->index]))
+        return false;
+    const struct Thing* thing = thing_get(entry->index);
+    return ((thing->alloc_flags & TAlF_IsInMapWho) != 0) && shot_broadphase_tracks_thing(thing);
+}
+
+/**
+ * Reorders candidates from one subtile to match the order of that subtile's mapwho list.
+ */
+static void shot_broadphase_order_as_mapwho(struct ShotCollideEntry *cands, long num)
+{
+    struct Map* mapblk = get_map_block_at(cands[0].stl_x, cands[0].stl_y);
+    long placed = 0;
+    unsigned long k = 0;
+    long i = get_mapwho_thing_index(mapblk);
+    while ((i != 0) && (placed < num))
+    {
+        struct Thing* thing = thing_get(i);
+        if (thing_is_invalid(thing))
+            break;
+        for (long n = placed; n < num; n++)
+        {
+            if (cands[n].index == i)
+            {
+                struct ShotCollideEntry entry = cands[n];
+                cands[n] = cands[placed];
+                cands[placed] = entry;
+                placed++;
+                break;
+            }
+        }
+        i = thing->next_on_mapblk;
+        k++;
+        if (k > THINGS_COUNT)
+        {
+            ERRORLOG("Infinite loop detected when sweeping things list");
+            break;
+        }
+    }
+}
+
+/**
+ * Gathers things which may be hit within given subtiles area, in deterministic order.
+ * @return Amount of candidates stored in the broad phase candidates array.
+ */
+static long shot_broadphase_gather(const struct Thing *shotng,
+    MapSubtlCoord stl_x_min, MapSubtlCoord stl_y_min, MapSubtlCoord stl_x_max, MapSubtlCoord stl_y_max)
+{
+    struct ShotBroadPhase* sbp = &shot_broadphase;
+    long count = 0;
+    for (long cell_y = (stl_y_min >> SHOT_COLLIDE_CELL_SHIFT); cell_y <= (stl_y_max >> SHOT_COLLIDE_CELL_SHIFT); cell_y++)
+    {
+        for (long cell_x = (stl_x_min >> SHOT_COLLIDE_CELL_SHIFT); cell_x <= (stl_x_max >> SHOT_COLLIDE_CELL_SHIFT); cell_x++)
+        {
+            long n = cell_y * map_arena.shot_cells_x + cell_x;
+            for (long i = sbp->cell_start[n]; i < sbp->cell_start[n + 1]; i++)
+            {
+                if (shot_broadphase_entry_in_area(&sbp->entries[i], shotng, stl_x_min, stl_y_min, stl_x_max, stl_y_max))
+                    sbp->candidates[count++] = sbp->entries[i];
+            }
+        }
+    }
+    for (long i = 0; i < sbp->late_count; i++)
+    {
+        if (shot_broadphase_entry_in_area(&sbp->late[i], shotng, stl_x_min, stl_y_min, stl_x_max, stl_y_max))
+            sbp->candidates[count++] = sbp->late[i];
+    }
+    // Order by subtile rows, like the mapwho sweep does; candidate lists are short
+    for (long i = 1; i < count; i++)
+    {
+        struct ShotCollideEntry entry = sbp->candidates[i];
+        long k = i;
+        while (k > 0)
+        {
+            const struct ShotCollideEntry* prev = &sbp->candidates[k - 1];
+            if ((prev->stl_y < entry.stl_y) || ((prev->stl_y == entry.stl_y) && (prev->stl_x <= entry.stl_x)))
+                break;
+            sbp->candidates[k] = *prev;
+            k--;
+        }
+        sbp->candidates[k] = entry;
+    }
+    // Within a subtile, keep the order of its mapwho list
+    for (long start = 0; start < count; )
+    {
+        long end = start + 1;
+        while ((end < count) && (sbp->candidates[end].stl_x == sbp->candidates[start].stl_x)
+            && (sbp->candidates[end].stl_y == sbp->candidates[start].stl_y))
+            end++;
+        if (end - start > 1)
+            shot_broadphase_order_as_mapwho(&sbp->candidates[start], end - start);
+        start = end;
+    }
+    return count;
+}
+
+/**
+ * Finds a thing which the shot hits while moving to given position.
+ * Uses the shots broad phase when it is built, and falls back to mapwho sweep otherwise.
+ */
+struct Thing *get_shootable_thing_collided_with_at(struct Thing *shotng, struct Coord3d *pos, HitTargetFlags hit_targets)
+{
+    // Shots move while they're updated, so these aren't within the broad phase
+    if (!shot_broadphase.active || ((hit_targets & (HitTF_OwnedShotsCollide|HitTF_AlliedShotsCollide|HitTF_EnemyShotsCollide)) != 0)) {
+        return get_thing_collided_with_at_satisfying_filter(shotng, pos, collide_filter_thing_is_shootable, hit_targets, 0);
+    }
+    struct Thing* parntng = INVALID_THING;
+    if (shotng->parent_idx > 0) {
+        parntng = thing_get(shotng->parent_idx);
+    }
+    int radius = 384;
+    MapSubtlCoord stl_x_min = max(coord_subtile(pos->x.val - radius), 0);
+    MapSubtlCoord stl_y_min = max(coord_subtile(pos->y.val - radius), 0);
+    MapSubtlCoord stl_x_max = min(coord_subtile(pos->x.val + radius), gameadd.map_subtiles_x);
+    MapSubtlCoord stl_y_max = min(coord_subtile(pos->y.val + radius), gameadd.map_subtiles_y);
+    long count = shot_broadphase_gather(shotng, stl_x_min, stl_y_min, stl_x_max, stl_y_max);
+    for (long i = 0; i < count; i++)
+    {
+        struct Thing* thing = thing_get(shot_broadphase.candidates[i].index);
+        if (collide_filter_thing_is_shootable(thing, parntng, hit_targets, 0))
+        {
+            if (things_collide_while_first_moves_to(shotng, pos, thing)) {
+                return thing;
+            }
+        }
+    }
+    return INVALID_THING;
+}
+
 /**
  * Processes hitting another thing.
  *
@@ -1615,7 +1875,7 @@ TbBool shot_hit_something_while_moving(struct Thing *shotng, struct Coord3d *nxp
     SYNCDBG(18,"Starting for %s index %d, hit type %d",thing_model_name(shotng),(int)shotng->index, (int)shotng->shot.hit_type);
     struct Thing* targetng = INVALID_THING;
     HitTargetFlags hit_targets = hit_type_to_hit_targets(shotng->shot.hit_type);
-    targetng = get_thing_collided_with_at_satisfying_filter(shotng, nxpos, collide_filter_thing_is_shootable, hit_targets, 0);
+    targetng = get_shootable_thing_collided_with_at(shotng, nxpos, hit_targets);
     if (thing_is_invalid(targetng)) {
         return false;
     }
@@ -28,6 +28,9 @@
 extern "C" {
 #endif
 /******************************************************************************/
+/** Things which shots may hit are bucketed in squares of 8x8 subtiles. */
+#define SHOT_COLLIDE_CELL_SHIFT 3
+
 enum ShotModels {
     ShM_Null = 0,
     ShM_Fireball,
@@ -114,6 +117,10 @@ TbBool detonate_shot(struct Thing *shotng, TbBool destroy);
 TbBool shot_is_boulder(const struct Thing *shotng);
 
 struct Thing *get_thing_collided_with_at_satisfying_filter(struct Thing *thing, struct Coord3d *pos, Thing_Collide_Func filter, HitTargetFlags a4, long a5);
+struct Thing *get_shootable_thing_collided_with_at(struct Thing *shotng, struct Coord3d *pos, HitTargetFlags hit_targets);
+void shot_broadphase_build(void);
+void shot_broadphase_clear(void);
+void shot_broadphase_thing_placed(const struct Thing *thing);
 
 void affect_nearby_enemy_creatures_with_wind(struct Thing *thing);
 /******************************************************************************/
@@ -0,0 +1,103 @@
+//
+// Task scheduler: long tasks are split across frames according to their budget.
+//
+#include "tst_main.h"
+
+#include <string.h>
+#include <bflib_basics.h>
+#include <bflib_coroutine.h>
+
+#define TST_WORK_ITEMS 100
+
+static TbClockMSec tst_clock_now;
+static long tst_work_done;
+
+// Each step takes 1 ms of the fake clock
+static TbClockMSec tst_clock(void)
+{
+    return tst_clock_now;
+}
+
+static CoroutineLoopState tst_work_step(CoroutineTask *task)
+{
+    tst_clock_now++;
+    tst_work_done++;
+    task->progress++;
+    if (task->progress >= TST_WORK_ITEMS)
+        return CLS_CONTINUE;
+    return CLS_REPEAT;
+}
+
+static CoroutineLoopState tst_wait_step(CoroutineTask *task)
+{
+    task->progress++;
+    return (task->progress >= 3) ? CLS_CONTINUE : CLS_RETURN;
+}
+
+static CoroutineLoopState tst_fail_step(CoroutineTask *task)
+{
+    return CLS_ABORT;
+}
+
+static void tst_init(CoroutineTasks *sched)
+{
+    memset(sched, 0, sizeof(CoroutineTasks));
+    sched->clock = tst_clock;
+    tst_clock_now = 0;
+    tst_work_done = 0;
+}
+
+ADD_TEST(test_coroutine_task_sliced_by_budget)
+{
+    CoroutineTasks sched;
+    tst_init(&sched);
+    CoroutineTask *task = coroutine_task_start(&sched, "Work", tst_work_step, NULL, 10);
+    CU_ASSERT_FATAL(task != NULL);
+    coroutine_tasks_process(&sched);
+    CU_ASSERT_EQUAL(tst_work_done, 10);
+    CU_ASSERT(task->active);
+    int frames = 1;
+    while (coroutine_tasks_count(&sched) > 0)
+    {
+        coroutine_tasks_process(&sched);
+        frames++;
+        CU_ASSERT_FATAL(frames <= TST_WORK_ITEMS);
+    }
+    CU_ASSERT_EQUAL(tst_work_done, TST_WORK_ITEMS);
+    CU_ASSERT_EQUAL(frames, TST_WORK_ITEMS / 10);
+    CU_ASSERT_FALSE(task->error);
+}
+
+ADD_TEST(test_coroutine_task_waits_and_fails)
+{
+    CoroutineTasks sched;
+    tst_init(&sched);
+    CoroutineTask *wait_task = coroutine_task_start(&sched, "Wait", tst_wait_step, NULL, 10);
+    CoroutineTask *fail_task = coroutine_task_start(&sched, "Fail", tst_fail_step, NULL, 10);
+    CU_ASSERT_FATAL((wait_task != NULL) && (fail_task != NULL));
+    CU_ASSERT(coroutine_task_find(&sched, tst_wait_step, NULL) == wait_task);
+    // Waiting task makes one step per frame, even with budget left
+    coroutine_tasks_process(&sched);
+    CU_ASSERT_EQUAL(wait_task->progress, 1);
+    CU_ASSERT(fail_task->error);
+    CU_ASSERT_FALSE(fail_task->active);
+    coroutine_tasks_process(&sched);
+    coroutine_tasks_process(&sched);
+    CU_ASSERT_FALSE(wait_task->active);
+    CU_ASSERT_EQUAL(wait_task->frames, 3);
+    CU_ASSERT(coroutine_task_find(&sched, tst_wait_step, NULL) == NULL);
+}
+
+ADD_TEST(test_coroutine_tasks_finish)
+{
+    CoroutineTasks sched;
+    tst_init(&sched);
+    for (int i = 0; i < COROUTINE_TASKS_MAX; i++)
+    {
+        CU_ASSERT(coroutine_task_start(&sched, "Work", tst_work_step, NULL, 1) != NULL);
+    }
+    CU_ASSERT(coroutine_task_start(&sched, "Work", tst_work_step, NULL, 1) == NULL);
+    coroutine_tasks_finish(&sched);
+    CU_ASSERT_EQUAL(coroutine_tasks_count(&sched), 0);
+    CU_ASSERT_EQUAL(tst_work_done, TST_WORK_ITEMS * COROUTINE_TASKS_MAX);
+}
@@ -177,6 +177,10 @@ void reinit_level_after_load(void)
 {
 }
 
+void update(void)
+{
+}
+
 void centre_engine_window(void)
 {
 }
@@ -0,0 +1,176 @@
+//
+// Rollback determinism: a simulation which receives remote input late must
+// end in the same state as one running in lockstep.
+//
+#include "tst_main.h"
+
+#include <string.h>
+#include <bflib_rollback.h>
+
+#define TST_PLAYERS 2
+#define TST_TURNS 300
+
+struct TstInput {
+    long action;
+    long held;
+};
+
+struct TstState {
+    unsigned long value;
+    long position[TST_PLAYERS];
+};
+
+static struct TstState tst_state;
+static struct TstInput tst_schedule[TST_TURNS][TST_PLAYERS];
+static int tst_simulated_turns;
+
+static void tst_simulate(const void *inputs)
+{
+    const struct TstInput *inp = (const struct TstInput *)inputs;
+    for (int i = 0; i < TST_PLAYERS; i++)
+    {
+        tst_state.position[i] += inp[i].held;
+        tst_state.value = tst_state.value * 31 + inp[i].action + tst_state.position[i];
+    }
+    tst_simulated_turns++;
+}
+
+static void tst_predict(void *input, const void *last_input)
+{
+    struct TstInput *inp = (struct TstInput *)input;
+    inp->action = 0;
+    inp->held = ((const struct TstInput *)last_input)->held;
+}
+
+static TbBool tst_inputs_equal(const void *input1, const void *input2)
+{
+    return (memcmp(input1, input2, sizeof(struct TstInput)) == 0);
+}
+
+static unsigned long tst_checksum(void)
+{
+    return tst_state.value;
+}
+
+static void tst_make_schedule(void)
+{
+    unsigned long seed = 9377;
+    for (int turn = 0; turn < TST_TURNS; turn++)
+    {
+        for (int i = 0; i < TST_PLAYERS; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            tst_schedule[turn][i].action = ((seed >> 16) % 8 == 0) ? (long)((seed >> 8) % 100) : 0;
+            tst_schedule[turn][i].held = (long)((seed >> 20) % 16 == 0) + ((turn > 0) ? tst_schedule[turn-1][i].held : 0) % 3;
+        }
+    }
+}
+
+static void tst_init(struct TbRollback *rb)
+{
+    struct TbRollbackRegion region = {&tst_state, sizeof(tst_state)};
+    struct TbRollbackCallbacks cb = {tst_simulate, tst_predict, tst_inputs_equal, tst_checksum, NULL, NULL};
+    memset(&tst_state, 0, sizeof(tst_state));
+    tst_simulated_turns = 0;
+    CU_ASSERT_FATAL(LbRollbackInit(rb, &region, 1, sizeof(struct TstInput), TST_PLAYERS, 0, &cb));
+}
+
+/**
+ * Runs the schedule with remote input arriving given amount of turns late.
+ * Returns final state; the checksums sent by both sides are compared on the way.
+ */
+static struct TstState tst_run_with_latency(int latency, unsigned long *lockstep_checksums)
+{
+    struct TbRollback rb;
+    tst_init(&rb);
+    int confirmed = 0;
+    for (int turn = 0; turn < TST_TURNS; turn++)
+    {
+        LbRollbackTurnDone(&rb);
+        if (lockstep_checksums != NULL)
+        {
+            CU_ASSERT_EQUAL(LbRollbackDelayedChecksum(&rb), lockstep_checksums[turn]);
+        }
+        // Loopback: frames arrive after the latency, or sooner if the window is full
+        while ((confirmed < turn) && ((confirmed + latency <= turn) || (rb.pending_count >= ROLLBACK_MAX_TURNS)))
+        {
+            CU_ASSERT(LbRollbackConfirmTurn(&rb, tst_schedule[confirmed]) >= 0);
+            confirmed++;
+        }
+        struct TstInput inputs[TST_PLAYERS];
+        memcpy(inputs, tst_schedule[turn], sizeof(inputs));
+        inputs[1].action = -1; // must be overwritten by prediction
+        CU_ASSERT_FATAL(LbRollbackPredictTurn(&rb, inputs));
+        CU_ASSERT_EQUAL(inputs[0].action, tst_schedule[turn][0].action);
+        CU_ASSERT(inputs[1].action != -1);
+        tst_simulate(inputs);
+    }
+    LbRollbackTurnDone(&rb);
+    while (confirmed < TST_TURNS)
+    {
+        CU_ASSERT(LbRollbackConfirmTurn(&rb, tst_schedule[confirmed]) >= 0);
+        confirmed++;
+    }
+    CU_ASSERT_EQUAL(rb.pending_count, 0);
+    LbRollbackFree(&rb);
+    return tst_state;
+}
+
+ADD_TEST(test_rollback_matches_lockstep)
+{
+    static unsigned long lockstep_checksums[TST_TURNS];
+    tst_make_schedule();
+    // Lockstep reference; it sends the same delayed checksums as the predicting side
+    struct TbRollback rb;
+    tst_init(&rb);
+    for (int turn = 0; turn < TST_TURNS; turn++)
+    {
+        LbRollbackTurnDone(&rb);
+        lockstep_checksums[turn] = LbRollbackDelayedChecksum(&rb);
+        LbRollbackConfirmedTurn(&rb, tst_schedule[turn]);
+        tst_simulate(tst_schedule[turn]);
+    }
+    struct TstState lockstep = tst_state;
+    LbRollbackFree(&rb);
+
+    const int latencies[] = {0, 1, 3, ROLLBACK_MAX_TURNS, ROLLBACK_MAX_TURNS + 5};
+    for (unsigned int i = 0; i < sizeof(latencies)/sizeof(latencies[0]); i++)
+    {
+        struct TstState result = tst_run_with_latency(latencies[i], lockstep_checksums);
+        CU_ASSERT_EQUAL(memcmp(&result, &lockstep, sizeof(struct TstState)), 0);
+    }
+}
+
+ADD_TEST(test_rollback_resimulates_only_on_misprediction)
+{
+    tst_make_schedule();
+    for (int turn = 0; turn < TST_TURNS; turn++)
+    {
+        // Remote player keeps holding the same controls and does nothing else
+        tst_schedule[turn][1].action = 0;
+        tst_schedule[turn][1].held = 1;
+    }
+    tst_schedule[0][1].held = 0;
+    tst_schedule[1][1].action = 5;
+    struct TbRollback rb;
+    tst_init(&rb);
+    struct TstInput inputs[TST_PLAYERS];
+    for (int turn = 0; turn < 4; turn++)
+    {
+        memcpy(inputs, tst_schedule[turn], sizeof(inputs));
+        CU_ASSERT_FATAL(LbRollbackPredictTurn(&rb, inputs));
+        tst_simulate(inputs);
+    }
+    // State is stored only before turn 0
+    CU_ASSERT_EQUAL(rb.snapshots_count, 1);
+    // Turn 0 was predicted right, as there was no input before
+    CU_ASSERT_EQUAL(LbRollbackConfirmTurn(&rb, tst_schedule[0]), 0);
+    // Turn 1 has an action which couldn't be predicted; turns 0-3 are simulated again from the snapshot
+    CU_ASSERT_EQUAL(LbRollbackConfirmTurn(&rb, tst_schedule[1]), 4);
+    // Turns 2-3 were simulated again with the held controls of turn 1
+    CU_ASSERT_EQUAL(LbRollbackConfirmTurn(&rb, tst_schedule[2]), 0);
+    CU_ASSERT_EQUAL(LbRollbackConfirmTurn(&rb, tst_schedule[3]), 0);
+    CU_ASSERT_EQUAL(LbRollbackConfirmTurn(&rb, tst_schedule[3]), -1);
+    CU_ASSERT_EQUAL(rb.resimulated_turns, 4);
+    LbRollbackFree(&rb);
+}
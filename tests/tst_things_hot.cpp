@@ -0,0 +1,145 @@
+//
+// Hot things fields: the copy must follow list and mapwho changes, and class
+// sweeps using it must find the same things as sweeps over whole structures.
+//
+#include "tst_main.h"
+
+#include <string.h>
+#include <keeperfx.hpp>
+#include <game_legacy.h>
+#include <map_arena.h>
+#include <map_data.h>
+#include <thing_data.h>
+#include <thing_list.h>
+#include <thing_navigate.h>
+
+#define TST_MAP_TILES 85
+/** Things are placed on a small square of subtiles, so mapwho chains are long. */
+#define TST_AREA_SIZE 8
+#define TST_DOOR_EVERY 64
+
+/** Asserts that every entry of the hot fields copy equals the field in things array. */
+static void tst_assert_hot_matches_things(void)
+{
+    long mismatches = 0;
+    for (long i = 0; i < THINGS_COUNT; i++)
+    {
+        const struct Thing* thing = &game.things_data[i];
+        if ((things_hot.next_on_mapblk[i] != thing->next_on_mapblk) ||
+            (things_hot.next_of_class[i] != thing->next_of_class) ||
+            (things_hot.class_id[i] != thing->class_id))
+            mismatches++;
+    }
+    CU_ASSERT_EQUAL(mismatches, 0);
+}
+
+static void tst_place_things(void)
+{
+    set_map_size(TST_MAP_TILES, TST_MAP_TILES);
+    init_lookups();
+    memset(game.thing_lists, 0, sizeof(game.thing_lists));
+    things_hot_rebuild();
+    for (long i = 1; i < THINGS_COUNT; i++)
+    {
+        struct Thing* thing = thing_get(i);
+        memset(thing, 0, sizeof(struct Thing));
+        thing->index = i;
+        thing->alloc_flags = TAlF_Exists;
+        thing->class_id = ((i % TST_DOOR_EVERY) == 0) ? TCls_Door : TCls_Creature;
+        thing->model = 1;
+        thing->mappos.x.val = subtile_coord_center(1 + i % TST_AREA_SIZE);
+        thing->mappos.y.val = subtile_coord_center(1 + (i / TST_AREA_SIZE) % TST_AREA_SIZE);
+        add_thing_to_list(thing, get_list_for_thing_class(thing->class_id));
+        place_thing_in_mapwho(thing);
+    }
+}
+
+static void tst_remove_things(void)
+{
+    for (long i = 1; i < THINGS_COUNT; i++)
+    {
+        struct Thing* thing = thing_get(i);
+        remove_thing_from_mapwho(thing);
+        remove_thing_from_list(thing, get_list_for_thing_class(thing->class_id));
+        memset(thing, 0, sizeof(struct Thing));
+    }
+    memset(game.thing_lists, 0, sizeof(game.thing_lists));
+    things_hot_rebuild();
+    map_arena_free();
+}
+
+/** Reference sweep which reads whole thing structures. */
+static struct Thing *tst_find_door_full_sweep(MapSubtlCoord stl_x, MapSubtlCoord stl_y)
+{
+    long i = get_mapwho_thing_index(get_map_block_at(stl_x, stl_y));
+    while (i != 0)
+    {
+        struct Thing* thing = thing_get(i);
+        if (thing->class_id == TCls_Door)
+            return thing;
+        i = thing->next_on_mapblk;
+    }
+    return INVALID_THING;
+}
+
+ADD_TEST(test_things_hot_follows_add)
+{
+    tst_place_things();
+    tst_assert_hot_matches_things();
+    tst_remove_things();
+}
+
+ADD_TEST(test_things_hot_follows_remove)
+{
+    tst_place_things();
+    // Remove every third thing, which unlinks things from the middle of chains
+    for (long i = 1; i < THINGS_COUNT; i += 3)
+    {
+        struct Thing* thing = thing_get(i);
+        remove_thing_from_mapwho(thing);
+        remove_thing_from_list(thing, get_list_for_thing_class(thing->class_id));
+    }
+    tst_assert_hot_matches_things();
+    // Readding them puts them at heads of the chains
+    for (long i = 1; i < THINGS_COUNT; i += 3)
+    {
+        struct Thing* thing = thing_get(i);
+        add_thing_to_list(thing, get_list_for_thing_class(thing->class_id));
+        place_thing_in_mapwho(thing);
+    }
+    tst_assert_hot_matches_things();
+    tst_remove_things();
+}
+
+ADD_TEST(test_things_hot_follows_move)
+{
+    tst_place_things();
+    struct Coord3d pos;
+    for (long i = 1; i < THINGS_COUNT; i += 5)
+    {
+        struct Thing* thing = thing_get(i);
+        // Move within the subtile, which keeps the chain, and then to another subtile
+        pos = thing->mappos;
+        pos.x.val++;
+        move_thing_in_map(thing, &pos);
+        pos.x.val = subtile_coord_center(1 + (i + 3) % TST_AREA_SIZE);
+        pos.y.val = subtile_coord_center(1 + (i / 3) % TST_AREA_SIZE);
+        move_thing_in_map(thing, &pos);
+    }
+    tst_assert_hot_matches_things();
+    tst_remove_things();
+}
+
+ADD_TEST(test_things_hot_class_sweep_matches_full_sweep)
+{
+    tst_place_things();
+    for (MapSubtlCoord stl_y = 0; stl_y < TST_AREA_SIZE + 2; stl_y++)
+    {
+        for (MapSubtlCoord stl_x = 0; stl_x < TST_AREA_SIZE + 2; stl_x++)
+        {
+            CU_ASSERT_PTR_EQUAL(get_door_for_position_for_trap_placement(stl_x, stl_y),
+                tst_find_door_full_sweep(stl_x, stl_y));
+        }
+    }
+    tst_remove_things();
+}